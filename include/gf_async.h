@@ -0,0 +1,83 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_async.h
+ *
+ * Asynchronous region jobs (w <= 32).  The caller submits jobs to a
+ * submission ring and collects their completions from a completion ring,
+ * while the queue's worker threads run them.  An event loop can submit and
+ * poll without ever blocking on the arithmetic.
+ *
+ * Both rings are bounded lock-free queues (each slot carries a sequence
+ * number that says whether it is ready to be written or to be read), so
+ * submitting and polling never take a lock.  A lock is only taken to put a
+ * thread to sleep, when a worker finds nothing to do or a waiter finds
+ * nothing completed, and to wake it.  Any number of threads may submit, poll
+ * and wait.
+ *
+ * The queue holds at most "entries" jobs that have been submitted but whose
+ * completions haven't been collected, so the completion ring can never
+ * overflow.  Jobs finish in any order; the user_data of a completion says
+ * which job it was.
+ */
+
+#pragma once
+
+#include "gf_complete.h"
+
+#define GF_ASYNC_MULTIPLY (0)   /* dest[0] = vals[0] * src[0] */
+#define GF_ASYNC_DOT      (1)   /* dest[0] = sum over j < nsrc of vals[j] * src[j] */
+#define GF_ASYNC_ENCODE   (2)   /* dest[i] = sum over j < nsrc of vals[i*nsrc+j] * src[j], i < ndest */
+
+/* With xor set, the results are added into the destinations.  The regions
+   have the requirements of gf->multiply_region, or of
+   gf_matrix_region_multiply() for DOT and ENCODE.  The job is copied when
+   it is submitted, but the arrays and regions it points to must stay put
+   until its completion has been collected. */
+
+typedef struct {
+  int op;
+  void **src;
+  int nsrc;
+  void **dest;
+  int ndest;
+  uint32_t *vals;
+  int bytes;
+  int xor;
+  uint64_t user_data;
+} gf_async_job_t;
+
+/* status is 1 if the job ran, and 0 if it was malformed. */
+
+typedef struct {
+  uint64_t user_data;
+  int status;
+} gf_async_completion_t;
+
+typedef struct gf_async gf_async_t;
+
+/* entries is rounded up to a power of two.  With nthreads = 0, or if no
+   worker thread can be started, the jobs run on whichever thread calls
+   gf_async_poll() or gf_async_wait().  Returns NULL on bad parameters or if
+   it runs out of memory. */
+
+extern gf_async_t *gf_async_create(GFP gf, int entries, int nthreads);
+
+/* Waits for the jobs in flight, stops the workers and frees the queue. */
+
+extern void gf_async_free(gf_async_t *q);
+
+/* Returns 1 if the job was queued, and 0 if the queue is full, in which case
+   some completions have to be collected first. */
+
+extern int gf_async_submit(gf_async_t *q, gf_async_job_t *job);
+
+/* Both put up to max completions into c and return how many there were.
+   gf_async_poll() doesn't block.  gf_async_wait() blocks until it has at
+   least min of them, or as many as there are jobs in flight, if that is
+   fewer. */
+
+extern int gf_async_poll(gf_async_t *q, gf_async_completion_t *c, int max);
+extern int gf_async_wait(gf_async_t *q, gf_async_completion_t *c, int min, int max);
@@ -72,6 +72,13 @@ typedef enum {GF_MULT_DEFAULT,
 #define GF_REGION_ALTMAP       (0x20)
 #define GF_REGION_CAUCHY       (0x40)
 
+/* GF_REGION_ONLY may be added to any of the above.  It says that the field
+   is only used for region operations, so the implementation may leave out
+   the tables that only multiply(), divide() and inverse() use.  Those still
+   work, but with a slower method (e.g. Euclid's algorithm for division). */
+
+#define GF_REGION_ONLY         (0x80)
+
 typedef uint32_t gf_region_type_t;
 
 /* These are different ways to implement division.
@@ -87,7 +94,8 @@ typedef enum { GF_DIVIDE_DEFAULT,
    operations for multiplication, division, etc.  We also support
    a "gen" type so that you can do general gf arithmetic for any 
    value of w from 1 to 32.  You can perform a "region" operation
-   on these if you use "CAUCHY" as the mapping. 
+   on these if you use "CAUCHY" as the mapping.  "CAUCHY" works
+   with every w, including 64 and 128, and it only uses XOR.
  */
 
 typedef uint32_t    gf_val_32_t;
@@ -0,0 +1,63 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_dense.h
+ *
+ * Dense matrices over GF(2^w), for w = 4, 8, 16 and 32, meant for large
+ * matrices (hundreds of rows and up), where gf_matrix_invert() is slow.
+ *
+ * Each row is stored as a region of packed words, in the layout that
+ * gf->multiply_region uses, so every row operation is a single call to
+ * multiply_region with xor=1.  For w = 4, column 2i is the low nibble of byte
+ * i.  The gf_t must use the standard region layout (no ALTMAP or CAUCHY).
+ *
+ * Elimination is Gauss-Jordan.  When a matrix is bigger than the L2 cache, it
+ * is done in panels of columns:  each panel is reduced on its own, and the
+ * same row operations are then applied to the rest of the matrix in chunks
+ * that keep the panel's pivot rows in cache.
+ */
+
+#pragma once
+
+#include "gf_complete.h"
+
+typedef struct gf_dense gf_dense_t;
+
+/* Creates a rows x cols matrix of zeros.  Returns NULL if the parameters are
+   bad or the gf_t's w or region layout aren't supported. */
+
+extern gf_dense_t *gf_dense_create(GFP gf, int rows, int cols);
+extern gf_dense_t *gf_dense_copy(gf_dense_t *m);
+extern void gf_dense_free(gf_dense_t *m);
+
+extern int gf_dense_rows(gf_dense_t *m);
+extern int gf_dense_cols(gf_dense_t *m);
+extern uint32_t gf_dense_get(gf_dense_t *m, int row, int col);
+extern void gf_dense_set(gf_dense_t *m, int row, int col, uint32_t val);
+
+/* Returns row i as a region.  Rows start on 16-byte boundaries, and their
+   ends are padded with zeros to a multiple of 16 bytes.  Row pointers change
+   when gf_dense_rref() swaps rows. */
+
+extern void *gf_dense_row(gf_dense_t *m, int i);
+
+/* Puts m into reduced row echelon form, in place, and returns its rank. */
+
+extern int gf_dense_rref(gf_dense_t *m);
+
+/* Returns the rank of m, without changing it.  Returns -1 if it runs out of
+   memory. */
+
+extern int gf_dense_rank(gf_dense_t *m);
+
+/* Sets inv to the inverse of the square matrix m, which is not changed.  Both
+   must be the same size.  Returns 1 on success and 0 if m is singular. */
+
+extern int gf_dense_invert(gf_dense_t *m, gf_dense_t *inv);
+
+/* Solves a x = b, where a is square and b and x have the same shape.  Returns
+   1 on success and 0 if a is singular. */
+
+extern int gf_dense_solve(gf_dense_t *a, gf_dense_t *b, gf_dense_t *x);
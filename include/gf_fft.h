@@ -0,0 +1,47 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_fft.h
+ *
+ * Reed-Solomon codes over GF(2^w), for w <= 16, that encode and decode with
+ * the additive FFT of Lin, Chung and Han ("novel polynomial basis").  They are
+ * meant for very wide codes, such as thousands of fragments in GF(2^16),
+ * where matrix coding costs O(n*k) region multiplications.  Here, encoding
+ * costs O(n log k) and decoding O(N log N), where N is the next power of two
+ * past the code's width.
+ *
+ * Let K be the smallest power of two >= k.  The code word is the evaluation of
+ * the polynomial of degree < K that is data fragment i at the field element i,
+ * and zero at the elements k to K-1.  Coding fragment j is its value at K+j.
+ * The code is MDS:  any m erasures can be decoded.  It needs K + m <= 2^w.
+ *
+ * Fragments are numbered 0 to k-1 for data[i], and k to k+m-1 for coding[j].
+ * Every region is "bytes" long, and all of the regions must satisfy the
+ * alignment rules of gf->multiply_region, with respect to each other.  For
+ * w = 16, the fastest field is SPLIT 16 4 with ALTMAP, and then the regions
+ * are in the ALTMAP layout.
+ */
+
+#pragma once
+
+#include "gf_complete.h"
+
+typedef struct gf_fft gf_fft_t;
+
+/* Returns NULL if the parameters are bad. */
+
+extern gf_fft_t *gf_fft_create(GFP gf, int k, int m);
+extern void gf_fft_free(gf_fft_t *fft);
+
+/* Computes coding[0..m-1].  Returns 0 if it runs out of memory. */
+
+extern int gf_fft_encode(gf_fft_t *fft, void **data, void **coding, int bytes);
+
+/* Rebuilds the fragments listed in erasures, which is terminated by -1.
+   Returns 1 on success, and 0 if there are more than m erasures or if it runs
+   out of memory.  Decoding uses N scratch regions, where N is the smallest
+   power of two >= K + m. */
+
+extern int gf_fft_decode(gf_fft_t *fft, int *erasures, void **data, void **coding, int bytes);
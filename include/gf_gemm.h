@@ -0,0 +1,35 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_gemm.h
+ *
+ * Matrix-matrix multiplication over GF(2^w):  C = A * B, where A is an m x k
+ * matrix of field elements, and B and C are matrices whose rows are regions.
+ * This is gf_matrix_region_multiply(), for when B is wide and A is big enough
+ * that the region calls dominate, such as decoding many stripes at once with
+ * the same erasures.
+ *
+ * For w = 8 and 16 with the standard region layout, and SSSE3, the work is
+ * tiled:  A is cut into blocks of four rows, whose split (nibble) tables are
+ * built once, B into column blocks that stay in L2, and C into 32-byte tiles
+ * whose four rows are accumulated in registers over all of k, so each C tile
+ * is written once and each load of B is used for four rows.  Other fields use
+ * gf_matrix_region_multiply().
+ */
+
+#pragma once
+
+#include "gf_complete.h"
+
+/* Sets c[i] to the sum over l of a[i*k+l] * b[l], for i < m, or adds it to
+   c[i] when xor is set.  The regions are "bytes" long.  Each of nthreads
+   threads does a range of the columns.  With ALTMAP or CAUCHY, the columns
+   can't be split, so nthreads is ignored.  For the tiled kernels, there are
+   no alignment requirements.  Otherwise, the regions must satisfy those of
+   gf->multiply_region.  If a thread can't be started, the calling thread does
+   its range.  Returns 1 on success and 0 if it runs out of memory. */
+
+extern int gf_gemm(GFP gf, int m, int k, uint32_t *a, void **b, void **c, int bytes,
+                   int xor, int nthreads);
@@ -30,6 +30,11 @@ typedef struct {
   int arg2;
   gf_t *base_gf;
   void *private;
+  void *cauchy;
+  uint64_t id;
+  void *shared;         /* The shared tables, if private points to them */
+  uint32_t parts;       /* The parts of the shared tables known to be built */
+  int region_only;      /* GF_REGION_ONLY was given; it isn't in region_type */
 } gf_internal_t;
 
 extern int gf_w4_init (gf_t *gf);
@@ -37,9 +42,11 @@ extern int gf_w4_scratch_size(int mult_type, int region_type, int divide_type, i
 
 extern int gf_w8_init (gf_t *gf);
 extern int gf_w8_scratch_size(int mult_type, int region_type, int divide_type, int arg1, int arg2);
+extern int gf_w8_shared_size(int mult_type, int region_type, int arg1, int arg2);
 
 extern int gf_w16_init (gf_t *gf);
 extern int gf_w16_scratch_size(int mult_type, int region_type, int divide_type, int arg1, int arg2);
+extern int gf_w16_shared_size(int mult_type, int region_type, int arg1, int arg2);
 
 extern int gf_w32_init (gf_t *gf);
 extern int gf_w32_scratch_size(int mult_type, int region_type, int divide_type, int arg1, int arg2);
@@ -55,9 +62,81 @@ extern int gf_wgen_scratch_size(int w, int mult_type, int region_type, int divid
 
 void gf_wgen_cauchy_region(gf_t *gf, void *src, void *dest, gf_val_32_t val, int bytes, int xor);
 gf_val_32_t gf_wgen_extract_word(gf_t *gf, void *start, int bytes, int index);
+void gf_wgen_cauchy_region_w64(gf_t *gf, void *src, void *dest, gf_val_64_t val, int bytes, int xor);
+gf_val_64_t gf_wgen_extract_word_w64(gf_t *gf, void *start, int bytes, int index);
+void gf_wgen_cauchy_region_w128(gf_t *gf, void *src, void *dest, gf_val_128_t val, int bytes, int xor);
+void gf_wgen_extract_word_w128(gf_t *gf, void *start, int bytes, int index, gf_val_128_t rv);
+
+/* Cauchy region multiplies are driven by XOR schedules, which are cached per
+   constant at the end of the scratch memory.  The cache size is zero when the
+   gf_t doesn't use Cauchy regions. */
+
+extern int gf_wgen_cauchy_cache_size(int w, int region_type);
+extern void gf_wgen_cauchy_cache_init(gf_t *gf, void *mem);
+extern void gf_wgen_cauchy_cache_free(gf_t *gf);
 
 extern void gf_alignment_error(char *s, int a);
 
+/* Region multiplies that build tables for val keep them in a per-thread
+   context, not in the scratch memory, so that one gf_t can be shared by any
+   number of threads.  This returns the calling thread's context "key" for
+   gf, which is at least "bytes" bytes long and aligned on 16 bytes.  Its
+   contents carry over from one call to the next in the same thread with the
+   same gf_t and key.  When they don't -- the first time, or after the
+   context was handed to another gf_t or key -- *fresh is set to 1, and
+   otherwise to 0.  fresh may be NULL if the caller rebuilds the context
+   every time.
+
+   A context is not reentrant.  It stays valid only until the same thread
+   asks for the same gf_t and key again, which may move or free it, or asks
+   for GF_REGION_CONTEXTS other contexts.  So code that holds a context and
+   calls anything that may ask for one of its own -- a region multiply that
+   calls the gf_t's single multiply, say -- must use a different key for
+   it.  Each key below has one user per gf_t. */
+
+#define GF_REGION_CONTEXTS  (8)
+
+#define GF_CONTEXT_REGION   (0)   /* The tables of a region multiply */
+#define GF_CONTEXT_MULTIPLY (1)   /* The tables of a single multiply */
+#define GF_CONTEXT_SCHEDULE (2)   /* A Cauchy XOR schedule */
+
+extern void *gf_region_context(gf_t *gf, int key, int bytes, int *fresh);
+
+/* Tables that depend only on the field and its polynomial, and are never
+   written after they are built, are shared by every gf_t with the same
+   configuration.  This points h->private at the "bytes" bytes of tables that
+   build() fills in for gf, building them the first time they are needed and
+   keeping them until the last gf_t using them is freed.  The tables are
+   aligned on 16 bytes.  Returns 0 if build() returns 0 or if it runs out of
+   memory, in which case h->private is left alone.
+
+   Only gf_t's whose scratch memory gf_init_hard() allocated share their
+   tables.  When the caller supplies the scratch memory, gf_scratch_size()
+   has counted the tables in it, as gf_wN_shared_size() reports them, and
+   they are built there, so that the gf_t needs no gf_free().  Then
+   h->shared stays NULL, and the parts below are built in the scratch
+   memory. */
+
+extern int gf_share_tables(gf_t *gf, int bytes, int (*build)(gf_t *gf, void *tables));
+
+/* Parts of the shared tables that only some operations use (the division
+   tables, say) may be left out by build() and filled in the first time one
+   of those operations runs.  GF_NEED_PART() makes sure that part "part"
+   (0-31) of gf's tables has been built by part_build(), building it if it
+   hasn't.  The first thread to need a part builds it, once for all of the
+   gf_t's sharing the tables, and any others that need it meanwhile wait.
+   Once a gf_t has seen a part built, the check is a single load.  Tables
+   that aren't shared, like the ones compiled into the library, are always
+   complete. */
+
+#define GF_NEED_PART(gf, part, part_build) \
+  do { \
+    if (!(__atomic_load_n(&((gf_internal_t *) (gf)->scratch)->parts, __ATOMIC_ACQUIRE) & \
+          ((uint32_t) 1 << (part)))) gf_build_part((gf), (part), (part_build)); \
+  } while (0)
+
+extern void gf_build_part(gf_t *gf, int part, void (*part_build)(gf_t *gf, void *tables));
+
 extern uint32_t gf_bitmatrix_inverse(uint32_t y, int w, uint32_t pp);
 
 /* This returns the correct default for prim_poly when base is used as the base
@@ -107,6 +186,19 @@ extern void gf_two_byte_region_table_multiply(gf_region_data *rd, uint16_t *base
 extern void gf_multby_zero(void *dest, int bytes, int xor);
 extern void gf_multby_one(void *src, void *dest, int bytes, int xor);
 
+/* These fill table[0 .. 2^n-1] with the linear combinations of basis[0 .. n-1]:
+   table[i] is the XOR of the basis[j] for which bit j of i is set.  With
+   basis[j] = a * x^j, that is the table of a times every n-bit value, which
+   is what the multiplication tables are made of.  The table is filled by
+   doubling, table[2^j + k] = basis[j] ^ table[k] for k < 2^j, so each entry
+   costs one XOR, and the inner loop runs over contiguous entries, which the
+   compiler vectorizes. */
+
+extern void gf_linear_table_8(uint8_t *table, uint8_t *basis, int n);
+extern void gf_linear_table_16(uint16_t *table, uint16_t *basis, int n);
+extern void gf_linear_table_32(uint32_t *table, uint32_t *basis, int n);
+extern void gf_linear_table_64(uint64_t *table, uint64_t *basis, int n);
+
 typedef enum {GF_E_MDEFDIV, /* Dev != Default && Mult == Default */
               GF_E_MDEFREG, /* Reg != Default && Mult == Default */
               GF_E_MDEFARG, /* Args != Default && Mult == Default */
@@ -115,7 +207,7 @@ typedef enum {GF_E_MDEFDIV, /* Dev != Default && Mult == Default */
               GF_E_DOUQUAD, /* Reg == DOUBLE && Reg == QUAD */
               GF_E_SIMD_NO, /* Reg == SIMD && Reg == NOSIMD */
               GF_E_CAUCHYB, /* Reg == CAUCHY && Other Reg */
-              GF_E_CAUGT32, /* Reg == CAUCHY && w > 32*/
+              GF_E_CAUGT32, /* Unused -- CAUCHY now works with w > 32 */
               GF_E_ARG1SET, /* Arg1 != 0 && Mult \notin COMPOSITE/SPLIT/GROUP */
               GF_E_ARG2SET, /* Arg2 != 0 && Mult \notin SPLIT/GROUP */
               GF_E_MATRIXW, /* Div == MATRIX && w > 32 */
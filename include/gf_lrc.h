@@ -0,0 +1,62 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_lrc.h
+ *
+ * Local Reconstruction Codes over GF(2^w), for w <= 32.
+ *
+ * The k data fragments are split into l local groups of (nearly) equal size:
+ * group g holds data fragments g*k/l through (g+1)*k/l - 1.  Each group has a
+ * local parity, which is the XOR of its data fragments, and there are r global
+ * parities, which are Reed-Solomon style parities over all of the data (they
+ * use a Cauchy matrix, so any r lost data fragments can be rebuilt from them).
+ *
+ * Fragments are numbered as follows:
+ *
+ *   0 to k-1:          data fragment i is data[i]
+ *   k to k+l-1:        local parity g is coding[g]
+ *   k+l to k+l+r-1:    global parity j is coding[l+j]
+ *
+ * A single lost data fragment or local parity is repaired from its group alone,
+ * which reads k/l fragments instead of k.  Every region is "bytes" long and must
+ * satisfy the alignment rules of gf->multiply_region.  The code needs
+ * k + r <= 2^w.
+ */
+
+#pragma once
+
+#include "gf_complete.h"
+
+typedef struct gf_lrc gf_lrc_t;
+
+/* Returns NULL if the parameters are bad, or if it runs out of memory. */
+
+extern gf_lrc_t *gf_lrc_create(GFP gf, int k, int l, int r);
+extern void gf_lrc_free(gf_lrc_t *lrc);
+
+/* Returns the local group of a data fragment or local parity, and -1 for a
+   global parity or a bad id. */
+
+extern int gf_lrc_group(gf_lrc_t *lrc, int id);
+
+/* Computes the l local and r global parities into coding[0..l+r-1].  This is a
+   single pass over the data, done in cache-sized chunks. */
+
+extern void gf_lrc_encode(gf_lrc_t *lrc, void **data, void **coding, int bytes);
+
+/* Rebuilds fragment "lost" from the others.  A data fragment or local parity
+   only reads the other members of its group, so the pointers for the other
+   groups may be NULL.  A global parity reads all of the data.  Returns 1 on
+   success and 0 on a bad id. */
+
+extern int gf_lrc_repair(gf_lrc_t *lrc, int lost, void **data, void **coding, int bytes);
+
+/* Rebuilds the fragments listed in erasures, which is terminated by -1.
+   Groups with a single erasure are repaired locally first, and the remaining
+   data is rebuilt from the surviving local and global parities.  Returns 1 on
+   success, and 0 if the erasures can't be decoded or if it runs out of
+   memory.  In that case, the contents of the erased regions are undefined. */
+
+extern int gf_lrc_decode(gf_lrc_t *lrc, int *erasures, void **data, void **coding, int bytes);
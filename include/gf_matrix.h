@@ -0,0 +1,122 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_matrix.h
+ *
+ * Matrix routines over GF(2^w) for w <= 32.  Matrices are stored in row-major
+ * order as arrays of uint32_t, and all arithmetic goes through the gf_t that
+ * you pass in, so it uses whatever multiplication method that gf_t was
+ * initialized with.
+ */
+
+#pragma once
+
+#include "gf_complete.h"
+
+/* Inverts the rows x rows matrix mat, putting the result into inv.  This uses
+   Gaussian elimination, and mat is destroyed in the process.  Returns 1 on
+   success and 0 if the matrix is not invertible (or gf has w > 32). */
+
+extern int gf_matrix_invert(GFP gf, uint32_t *mat, uint32_t *inv, int rows);
+
+/* A decode cache holds the inverses of the k x k submatrices of the
+   distribution matrix of a systematic code with k data and m coding
+   fragments.  Fragments 0 to k-1 are the data, and fragments k to k+m-1
+   are the coding fragments, defined by the m x k coding_matrix.
+
+   When fragments are lost, decoding needs the inverse of the rows of the
+   distribution matrix for k surviving fragments.  The cache is keyed by that
+   set of survivors, and it holds at most "capacity" inverses, evicting the
+   least recently used one when it is full.  During a rebuild, the same
+   handful of erasure patterns repeat over and over, so nearly every lookup
+   is a hit.
+
+   The cache may be shared by multiple threads.  The coding matrix is
+   copied, so you may free yours after creating the cache.  Returns NULL on
+   failure. */
+
+typedef struct gf_decode_cache gf_decode_cache_t;
+
+extern gf_decode_cache_t *gf_decode_cache_create(GFP gf, int k, int m,
+                                                 uint32_t *coding_matrix,
+                                                 int capacity);
+
+extern void gf_decode_cache_free(gf_decode_cache_t *cache);
+
+/* Puts the k x k decoding matrix for the given survivors into inv.
+   survivors holds k distinct fragment ids, in any order.  The columns of inv
+   correspond to the survivors sorted in increasing order, so that data
+   fragment i equals the sum over j of inv[i*k+j] times the j-th smallest
+   survivor.  Returns 1 on success, and 0 on bad survivors or if it runs out
+   of memory before inv is filled.  If it runs out afterwards, inv is still
+   returned, but isn't cached. */
+
+extern int gf_decode_cache_lookup(gf_decode_cache_t *cache, int *survivors, uint32_t *inv);
+
+/* Reports the number of lookups that hit and missed the cache. */
+
+extern void gf_decode_cache_stats(gf_decode_cache_t *cache, uint64_t *hits, uint64_t *misses);
+
+/* Degraded reads:  rebuilds only bytes [offset, offset+len) of the fragments
+   want[0..nwant-1], which may be data or coding fragments, from k survivors.
+   frags is indexed by fragment id, and only the survivors' entries are used.
+   out[i] gets the range of fragment want[i], and is len bytes long.
+
+   The decoding matrix comes from the cache, and only the wanted rows of it
+   are used (a coding fragment's row is its coding row times the inverse).
+   Those rows are applied with gf_matrix_region_multiply() to just the range
+   of the survivors, so the cost is proportional to nwant * len, not to the
+   size of the stripe.  frags[id] + offset and out[i] must satisfy the
+   alignment rules of gf->multiply_region.  The gf_t must use the standard
+   region layout, since ALTMAP and CAUCHY regions can't be cut into ranges.
+   Returns 1 on success and 0 on bad survivors or parameters. */
+
+extern int gf_decode_cache_range(gf_decode_cache_t *cache, int *survivors, void **frags,
+                                 int nwant, int *want, void **out, int offset, int len);
+
+/* Multiplies the rows x cols matrix by a vector of cols regions:
+
+     dest[i] = sum over j of matrix[i*cols+j] * src[j]
+
+   If xor is set, the products are added into dest instead.  Every region is
+   "bytes" long, and each src/dest pair must satisfy the alignment rules of
+   gf->multiply_region.  The work is done in cache-sized chunks, so that each
+   chunk of the sources is read from memory once and then reused for every row
+   while it is still in cache.  This is the kernel that encoding with a
+   coding matrix, and decoding with a decoding matrix, boil down to. */
+
+extern void gf_matrix_region_multiply(GFP gf, uint32_t *matrix, int rows, int cols,
+                                      void **src, void **dest, int bytes, int xor);
+
+/* Strided regions.  A strided region is nchunks pieces of "chunk" bytes,
+   where piece i starts at base + i*stride.  That is how a buffer that
+   interleaves k fragments round-robin, "chunk" bytes at a time, holds each
+   fragment:  fragment f has base buf + f*chunk and stride k*chunk.  These
+   let you encode and decode such buffers in place, with no de-interleaving
+   copies.
+
+   Each piece is handed to gf->multiply_region as a region of its own, so the
+   unaligned bytes at the start and the end of every piece are handled the
+   way gf_set_region_data() handles them for any region.  What is required
+   is that every src/dest pair of pieces satisfies the alignment rules of
+   gf->multiply_region, which holds when both the bases and the strides
+   do.  With ALTMAP, each piece is laid out as a separate region of "chunk"
+   bytes.
+
+   gf_region_multiply_strided() sets dest piece i to val times src piece i
+   (or adds it in if xor is set).  gf_matrix_region_multiply_strided() is
+   gf_matrix_region_multiply() on strided regions:  src[j] and dest[i] are the
+   bases, and all sources share src_stride, and all destinations dest_stride.
+   Both return 1 on success and 0 if the parameters break the rules, in
+   which case nothing is written. */
+
+extern int gf_region_multiply_strided(GFP gf, void *src, int src_stride,
+                                      void *dest, int dest_stride,
+                                      gf_val_32_t val, int chunk, int nchunks, int xor);
+
+extern int gf_matrix_region_multiply_strided(GFP gf, uint32_t *matrix, int rows, int cols,
+                                             void **src, int src_stride,
+                                             void **dest, int dest_stride,
+                                             int chunk, int nchunks, int xor);
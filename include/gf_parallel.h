@@ -0,0 +1,86 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_parallel.h
+ *
+ * Region multiplies spread over a pool of threads that the library owns.
+ *
+ * gf_parallel_init() starts the pool once for the whole process.  Its worker
+ * threads stay alive, pinned one per CPU where the system allows it, until
+ * gf_parallel_free().  gf_parallel_multiply_region() then cuts a large region
+ * into chunks and the workers and the calling thread multiply them, taking
+ * the next chunk as they finish one.  Every chunk but the first starts on a
+ * 64-byte boundary of the source, and the destination is cut at the same
+ * offsets, so each chunk meets the alignment rules of gf_set_region_data()
+ * whenever the whole region does.  The region tables of the workers live in
+ * their own per-thread contexts, so nothing in the gf_t is shared.
+ *
+ * Regions below the threshold, ALTMAP and CAUCHY regions, whose layout can't
+ * be cut, and calls made while the pool is busy with another one, run on the
+ * calling thread as a plain multiply_region.
+ *
+ * The stripe batches encode or decode many independent stripes at once.  Each
+ * stripe is cut into blocks of 64 KB of columns, and the blocks are dealt out
+ * to the threads in contiguous runs, one deque per thread.  A thread works
+ * through its own deque from the front, and when it is empty, steals blocks
+ * from the back of the others', so stripes of uneven size don't leave threads
+ * idle at the end the way a static split would.  The blocks are done with
+ * gf_matrix_region_multiply() and gf_decode_cache_range(), and the persistent
+ * workers keep their region tables from one batch to the next.
+ */
+
+#pragma once
+
+#include "gf_complete.h"
+#include "gf_general.h"
+#include "gf_matrix.h"
+
+/* Starts a pool with nthreads threads in all, the caller included, so it
+   creates nthreads-1 workers.  If nthreads <= 0, it uses one per online CPU.
+   Regions shorter than threshold bytes aren't split, and threshold <= 0 picks
+   a default of 1 MB.  Calling it again replaces the pool.  If a worker can't
+   be started, the pool runs with the ones that were.  Returns 1 on success
+   and 0 if it runs out of memory. */
+
+extern int gf_parallel_init(int nthreads, int threshold);
+extern void gf_parallel_free(void);
+
+/* Does gf->multiply_region with val (val->w32, val->w64 or val->w128 as w
+   requires) on the pool.  The regions have the same requirements as for
+   gf->multiply_region, and the call returns when all of it is done. */
+
+extern void gf_parallel_multiply_region(GFP gf, void *src, void *dest, gf_general_t *val,
+                                        int bytes, int xor);
+
+/* One stripe of a batch.  For encoding, src holds the k data regions and
+   dest the m coding regions.  For decoding, src holds the fragments indexed
+   by fragment id, as for gf_decode_cache_range(), survivors the k that are
+   used, and dest the nwant fragments listed in want that are rebuilt.  All
+   regions are "bytes" long. */
+
+typedef struct {
+  void **src;
+  void **dest;
+  int bytes;
+  int *survivors;
+  int nwant;
+  int *want;
+} gf_parallel_stripe_t;
+
+/* Encodes every stripe with the m x k coding matrix (w <= 32).  The regions
+   have the requirements of gf_matrix_region_multiply(), and with ALTMAP or
+   CAUCHY, each stripe is a single block.  Returns 1 on success and 0 on bad
+   parameters or if it runs out of memory. */
+
+extern int gf_parallel_encode_stripes(GFP gf, int k, int m, uint32_t *coding_matrix,
+                                      gf_parallel_stripe_t *stripes, int nstripes);
+
+/* Rebuilds the wanted fragments of every stripe through the decode cache,
+   which was created with gf.  The stripes may have different survivors.
+   Returns 1 on success, and 0 if any stripe had bad survivors or parameters,
+   or if it runs out of memory. */
+
+extern int gf_parallel_decode_stripes(GFP gf, gf_decode_cache_t *cache,
+                                      gf_parallel_stripe_t *stripes, int nstripes);
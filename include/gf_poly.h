@@ -0,0 +1,67 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_poly.h
+ *
+ * Polynomials over GF(2^w), for w <= 32.
+ *
+ * A polynomial of degree d is an array of d+1 coefficients, where p[i] is the
+ * coefficient of x^i.  The zero polynomial has degree -1.  Functions that
+ * produce a polynomial return its degree, and the caller provides the room
+ * for it, or -3 if they run out of memory.  Outputs may not overlap inputs,
+ * except where noted.
+ *
+ * Multiplication is schoolbook for small operands and Karatsuba above that.
+ * Division uses Newton iteration on the reversed divisor when both the
+ * divisor and the quotient are large, so that it costs a few multiplications.
+ * Multipoint evaluation and interpolation use a subproduct tree, so they take
+ * O(M(n) log n) operations instead of O(n^2).
+ *
+ * When w is 8, 16 or 32 and the gf_t uses the standard region layout, the
+ * schoolbook loops (a coefficient times a polynomial, added into another)
+ * are done with gf->multiply_region.
+ */
+
+#pragma once
+
+#include "gf_complete.h"
+
+/* The degree of the n coefficients in p:  the index of the last non-zero
+   one, or -1. */
+
+extern int gf_poly_degree(uint32_t *p, int n);
+
+/* c = a + b.  c needs max(da, db) + 1 entries, and may be a or b. */
+
+extern int gf_poly_add(GFP gf, uint32_t *a, int da, uint32_t *b, int db, uint32_t *c);
+
+/* c = a * b.  c needs da + db + 1 entries. */
+
+extern int gf_poly_multiply(GFP gf, uint32_t *a, int da, uint32_t *b, int db, uint32_t *c);
+
+/* a = q * b + r, with deg r < deg b.  q needs da - db + 1 entries, and may
+   be NULL.  r needs max(da, db) + 1 entries, and may be a.  Returns the
+   degree of r, or -2 if b is zero. */
+
+extern int gf_poly_divide(GFP gf, uint32_t *a, int da, uint32_t *b, int db, uint32_t *q, uint32_t *r);
+
+/* g = the monic greatest common divisor of a and b.  g needs
+   max(da, db) + 1 entries.  Returns -1 if both are zero. */
+
+extern int gf_poly_gcd(GFP gf, uint32_t *a, int da, uint32_t *b, int db, uint32_t *g);
+
+/* Returns p(x), with Horner's rule. */
+
+extern uint32_t gf_poly_evaluate(GFP gf, uint32_t *p, int d, uint32_t x);
+
+/* Sets ys[i] = p(xs[i]) for the n points.  Returns 0 if it runs out of
+   memory. */
+
+extern int gf_poly_evaluate_multi(GFP gf, uint32_t *p, int d, uint32_t *xs, int n, uint32_t *ys);
+
+/* Sets p to the polynomial of degree < n with p(xs[i]) = ys[i].  p needs n
+   entries.  Returns its degree, or -2 if the xs are not distinct. */
+
+extern int gf_poly_interpolate(GFP gf, uint32_t *xs, uint32_t *ys, int n, uint32_t *p);
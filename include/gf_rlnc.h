@@ -0,0 +1,53 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_rlnc.h
+ *
+ * Random linear network coding over GF(2^w), for w <= 32.
+ *
+ * A generation is k source packets of "bytes" bytes each.  A coded packet is
+ * a linear combination of the source packets, and it travels with its k
+ * coefficients.  The decoder keeps the packets that it has received in reduced
+ * row echelon form, and does the elimination as each packet arrives, so the
+ * cost of decoding is spread over the arrivals instead of being paid all at
+ * once at the end.  As soon as the coefficients of a row reduce to a unit
+ * vector, that source packet is available, even before the decoder has k
+ * packets.
+ */
+
+#pragma once
+
+#include "gf_complete.h"
+
+/* Sets dest to the sum over i of coefs[i] * src[i]. */
+
+extern void gf_rlnc_encode(GFP gf, int k, void **src, uint32_t *coefs, void *dest, int bytes);
+
+/* Fills coefs with k random elements of the field, using MOA_Random_W(). */
+
+extern void gf_rlnc_random_coefficients(GFP gf, int k, uint32_t *coefs);
+
+typedef struct gf_rlnc_decoder gf_rlnc_decoder_t;
+
+/* Returns NULL if the parameters are bad. */
+
+extern gf_rlnc_decoder_t *gf_rlnc_decoder_create(GFP gf, int k, int bytes);
+extern void gf_rlnc_decoder_free(gf_rlnc_decoder_t *dec);
+
+/* Adds a coded packet.  Neither coefs nor packet are modified or kept.
+   Returns 1 if the packet was innovative (it raised the rank), and 0 if it
+   was a combination of the packets that the decoder already had. */
+
+extern int gf_rlnc_decoder_add(gf_rlnc_decoder_t *dec, uint32_t *coefs, void *packet);
+
+/* The number of independent packets received so far.  Decoding is complete
+   when this equals k. */
+
+extern int gf_rlnc_decoder_rank(gf_rlnc_decoder_t *dec);
+
+/* Returns source packet i, or NULL if it hasn't been decoded yet.  The region
+   belongs to the decoder, and it stays valid until the decoder is freed. */
+
+extern void *gf_rlnc_decoder_packet(gf_rlnc_decoder_t *dec, int i);
@@ -0,0 +1,63 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_rs.h
+ *
+ * Reed-Solomon error correction over GF(2^8) and GF(2^16).
+ *
+ * A code has k data symbols and nroots parity symbols, so n = k + nroots,
+ * and it corrects up to nroots/2 symbol errors in unknown locations.  The
+ * generator polynomial is (x - a^1)(x - a^2)...(x - a^nroots), where a = 2
+ * must be a primitive element of the field.
+ *
+ * Codewords are interleaved across regions:  you pass k data regions and
+ * nroots parity regions, all of the same size, and every w-bit word offset
+ * in those regions is a separate codeword.  Parity region j holds the
+ * coefficient of x^j, and data region i holds the coefficient of x^(nroots+i).
+ * That way, the expensive parts of encoding and decoding (encoding, the
+ * syndromes and the Chien search) are all done with region operations.
+ *
+ * The gf_t must have w = 8 or w = 16, and its regions must be in the
+ * standard layout (no GF_REGION_ALTMAP or GF_REGION_CAUCHY).
+ */
+
+#pragma once
+
+#include "gf_complete.h"
+
+typedef struct gf_rs gf_rs_t;
+
+/* Returns NULL if the parameters are bad, if 2 is not primitive in gf, or
+   if it runs out of memory. */
+
+extern gf_rs_t *gf_rs_create(GFP gf, int k, int nroots);
+extern void gf_rs_free(gf_rs_t *rs);
+
+/* Computes the nroots parity regions from the k data regions. */
+
+extern void gf_rs_encode(gf_rs_t *rs, void **data, void **parity, int bytes);
+
+/* Computes the nroots syndrome regions of the codewords.  Syndrome region j
+   holds r(a^(j+1)) for each codeword r.  They are all zero when there are no
+   errors.  Returns 1, or 0 if it runs out of memory. */
+
+extern int gf_rs_syndromes(gf_rs_t *rs, void **data, void **parity, void **syndromes, int bytes);
+
+/* Given the nroots syndromes of a single codeword, finds its errors with
+   Berlekamp-Massey, a Chien search and Forney's algorithm.  On success,
+   it returns the number of errors e, and puts their positions (0 to n-1, as
+   coefficients of x) in locations and their values in values.  Both arrays
+   need room for nroots/2 entries.  Returns -1 if the codeword has more
+   errors than the code can correct, or if it runs out of memory. */
+
+extern int gf_rs_correct(gf_rs_t *rs, uint32_t *syndromes, int *locations, uint32_t *values);
+
+/* Corrects the codewords in place.  Returns the number of symbols that were
+   corrected, or -1 if any codeword had too many errors to correct.  In that
+   case the other codewords are still corrected, and the bad ones are left
+   alone.  It also returns -1, without changing anything, if it runs out of
+   memory. */
+
+extern int gf_rs_decode(gf_rs_t *rs, void **data, void **parity, int bytes);
@@ -0,0 +1,36 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_shamir.h
+ *
+ * Shamir secret sharing of whole regions over GF(2^w), for w <= 32.  It is
+ * usually used with w = 8.
+ *
+ * The secret is a region, and every word of it is shared independently with
+ * its own random polynomial of degree t-1, whose constant term is the word.
+ * Share i is the value of the polynomials at x = i+1, so there can be up to
+ * 2^w - 1 shares.  Any t shares recover the secret, and fewer reveal nothing
+ * about it, provided that the random coefficients are secret and uniformly
+ * random.  Every region is "bytes" long and must satisfy the alignment rules
+ * of gf->multiply_region.
+ */
+
+#pragma once
+
+#include "gf_complete.h"
+
+/* Computes shares[0..n-1] from the secret, so that any t of them recover it.
+   random holds the t-1 regions of coefficients, which the caller must fill
+   from a cryptographic random number generator (MOA_Fill_Random_Region() is
+   not one).  Returns 1 on success and 0 if the parameters are bad or it runs
+   out of memory. */
+
+extern int gf_shamir_split(GFP gf, int t, int n, void *secret, void **random,
+                           void **shares, int bytes);
+
+/* Recovers the secret from the t shares in shares, where shares[i] is share
+   number ids[i].  Returns 1 on success and 0 if an id is bad or repeated. */
+
+extern int gf_shamir_recover(GFP gf, int t, int *ids, void **shares, void *secret, int bytes);
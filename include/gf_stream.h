@@ -0,0 +1,46 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_stream.h
+ *
+ * Streaming encoder for a systematic code with k data and m coding
+ * fragments, defined by an m x k coding matrix (w <= 32).
+ *
+ * The input is cut into stripes of k chunks.  Chunk i of every stripe is
+ * appended to data file i, and the m coding chunks of the stripe, computed
+ * with gf_matrix_region_multiply(), are appended to the coding files.  The
+ * last stripe is padded with zeros, so every output file ends up the same
+ * length, a multiple of the chunk size.
+ *
+ * Three stages run at once:  a reader thread fills stripes, the calling
+ * thread encodes them, and a writer thread writes them out.  They pass a
+ * fixed ring of "depth" stripe buffers around, so while stripe i is being
+ * encoded, stripe i+1 can be read and stripe i-1 written, and memory stays at
+ * depth * (k+m) * chunk bytes no matter how big the input is.
+ */
+
+#pragma once
+
+#include "gf_complete.h"
+
+typedef struct gf_stream gf_stream_t;
+
+/* chunk must be a positive multiple of 64 bytes that meets the size rules of
+   gf->multiply_region, and depth must be at least 2.  The coding matrix is
+   copied.  Returns NULL if the parameters are bad or it runs out of
+   memory. */
+
+extern gf_stream_t *gf_stream_create(GFP gf, int k, int m, uint32_t *coding_matrix,
+                                     int chunk, int depth);
+extern void gf_stream_free(gf_stream_t *s);
+
+/* Encodes everything that can be read from in_fd, writing data_fds[0..k-1]
+   and coding_fds[0..m-1].  Returns the number of bytes read, which the
+   caller needs in order to strip the padding later, or -1 if a read or a
+   write fails.  In that case errno says why, and the output files are
+   incomplete.  If the threads can't be started, the stages run one after
+   the other on the calling thread. */
+
+extern int64_t gf_stream_encode(gf_stream_t *s, int in_fd, int *data_fds, int *coding_fds);
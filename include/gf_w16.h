@@ -20,11 +20,13 @@
 #define GF_BASE_FIELD_WIDTH (8)
 #define GF_BASE_FIELD_SIZE       (1 << GF_BASE_FIELD_WIDTH)
 
+/* inv_tbl is last, so that GF_REGION_ONLY can leave it out. */
+
 struct gf_w16_logtable_data {
     uint16_t      log_tbl[GF_FIELD_SIZE];
     uint16_t      antilog_tbl[GF_FIELD_SIZE * 2];
-    uint16_t      inv_tbl[GF_FIELD_SIZE];
     uint16_t      *d_antilog;
+    uint16_t      inv_tbl[GF_FIELD_SIZE];
 };
 
 struct gf_w16_zero_logtable_data {
@@ -39,7 +41,6 @@ struct gf_w16_lazytable_data {
     uint16_t      antilog_tbl[GF_FIELD_SIZE * 2];
     uint16_t      inv_tbl[GF_FIELD_SIZE];
     uint16_t      *d_antilog;
-    uint16_t      lazytable[GF_FIELD_SIZE];
 };
 
 struct gf_w16_bytwo_data {
@@ -52,6 +53,12 @@ struct gf_w16_split_8_8_data {
     uint16_t      tables[3][256][256];
 };
 
+/* The tables for the default polynomial (0x1100b), generated at build time
+   by gf_mktables. */
+
+extern const struct gf_w16_logtable_data gf_w16_default_log_tables;
+extern const struct gf_w16_split_8_8_data gf_w16_default_split_8_8_tables;
+
 struct gf_w16_group_4_4_data {
     uint16_t reduce[16];
     uint16_t shift[16];
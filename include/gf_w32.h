@@ -21,6 +21,9 @@
 #define GF_BASE_FIELD_GROUP_SIZE  GF_BASE_FIELD_SIZE-1
 #define GF_MULTBY_TWO(p) (((p) & GF_FIRST_BIT) ? (((p) << 1) ^ h->prim_poly) : (p) << 1)
 
+/* The lazy split tables are per-thread region contexts (see
+   gf_region_context()), and are not part of the scratch memory. */
+
 struct gf_split_2_32_lazy_data {
     uint32_t      tables[16][4];
     uint32_t      last_value;
@@ -28,18 +31,23 @@ struct gf_split_2_32_lazy_data {
 
 struct gf_w32_split_8_8_data {
     uint32_t      tables[7][256][256];
-    uint32_t      region_tables[4][256];
-    uint32_t      last_value;
 };
 
+/* The shift table for the multiplier is kept in the per-thread region
+   context. */
+
 struct gf_w32_group_data {
     uint32_t *reduce;
-    uint32_t *shift;
     int      tshift;
     uint64_t rmask;
     uint32_t *memory;
 };
 
+/* The reduction table for g_r = 8 and the default polynomial (0x400007),
+   generated at build time by gf_mktables. */
+
+extern const uint32_t gf_w32_default_group_reduce[256];
+
 struct gf_split_16_32_lazy_data {
     uint32_t      tables[2][(1<<16)];
     uint32_t      last_value;
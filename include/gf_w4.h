@@ -44,10 +44,12 @@ struct gf_quad_table_data {
     uint16_t     mult[GF_FIELD_SIZE][(1<<16)];
 };
 
+/* The region table for val, mult[1 << 16], is built in the per-thread
+   region context. */
+
 struct gf_quad_table_lazy_data {
     uint8_t      div[GF_FIELD_SIZE][GF_FIELD_SIZE];
     uint8_t      smult[GF_FIELD_SIZE][GF_FIELD_SIZE];
-    uint16_t     mult[(1 << 16)];
 };
 
 struct gf_bytwo_data {
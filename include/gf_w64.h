@@ -20,9 +20,11 @@
 #define GF_BASE_FIELD_SIZE       (1ULL << GF_BASE_FIELD_WIDTH)
 #define GF_BASE_FIELD_GROUP_SIZE  GF_BASE_FIELD_SIZE-1
 
+/* The GROUP shift table and the lazy split tables are per-thread region
+   contexts (see gf_region_context()), not part of the scratch memory. */
+
 struct gf_w64_group_data {
     uint64_t *reduce;
-    uint64_t *shift;
     uint64_t *memory;
 };
 
@@ -46,13 +46,15 @@ struct gf_w8_composite_data {
   uint8_t *mult_table;
 };
 
-/* Don't change the order of these relative to gf_w8_half_table_data */
+/* Don't change the order of these relative to gf_w8_half_table_data.  In
+   these and in the TABLE structures below, the tables that only the scalar
+   operations use come last, so that GF_REGION_ONLY can leave them out. */
 
 struct gf_w8_default_data {
   uint8_t     high[GF_FIELD_SIZE][GF_HALF_SIZE];
   uint8_t     low[GF_FIELD_SIZE][GF_HALF_SIZE];
-  uint8_t     divtable[GF_FIELD_SIZE][GF_FIELD_SIZE];
   uint8_t     multtable[GF_FIELD_SIZE][GF_FIELD_SIZE];
+  uint8_t     divtable[GF_FIELD_SIZE][GF_FIELD_SIZE];
 };
 
 struct gf_w8_half_table_data {
@@ -61,19 +63,26 @@ struct gf_w8_half_table_data {
 };
 
 struct gf_w8_single_table_data {
-  uint8_t     divtable[GF_FIELD_SIZE][GF_FIELD_SIZE];
   uint8_t     multtable[GF_FIELD_SIZE][GF_FIELD_SIZE];
+  uint8_t     divtable[GF_FIELD_SIZE][GF_FIELD_SIZE];
 };
 
+/* The tables for the default polynomial (0x11d), generated at build time by
+   gf_mktables.  Their multtable and divtable double as the single table. */
+
+extern const struct gf_w8_default_data gf_w8_default_tables;
+
 struct gf_w8_double_table_data {
-    uint8_t         div[GF_FIELD_SIZE][GF_FIELD_SIZE];
     uint16_t        mult[GF_FIELD_SIZE][GF_FIELD_SIZE*GF_FIELD_SIZE];
+    uint8_t         div[GF_FIELD_SIZE][GF_FIELD_SIZE];
 };
 
+/* The region table for val, mult[GF_FIELD_SIZE*GF_FIELD_SIZE], is built in
+   the per-thread region context. */
+
 struct gf_w8_double_table_lazy_data {
-    uint8_t         div[GF_FIELD_SIZE][GF_FIELD_SIZE];
     uint8_t         smult[GF_FIELD_SIZE][GF_FIELD_SIZE];
-    uint16_t        mult[GF_FIELD_SIZE*GF_FIELD_SIZE];
+    uint8_t         div[GF_FIELD_SIZE][GF_FIELD_SIZE];
 };
 
 struct gf_w4_logtable_data {
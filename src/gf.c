@@ -12,6 +12,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <pthread.h>
 
 int _gf_errno = GF_E_DEFAULT;
 
@@ -186,6 +187,10 @@ int gf_error_check(int w, int mult_type, int region_type, int divide_type,
   int rdouble, rquad, rlazy, rsimd, rnosimd, raltmap, rcauchy, tmp;
   gf_internal_t *sub;
 
+  /* GF_REGION_ONLY goes with any method, so the checks below ignore it. */
+
+  region_type &= ~GF_REGION_ONLY;
+
   rdouble = (region_type & GF_REGION_DOUBLE_TABLE);
   rquad   = (region_type & GF_REGION_QUAD_TABLE);
   rlazy   = (region_type & GF_REGION_LAZY);
@@ -238,7 +243,6 @@ int gf_error_check(int w, int mult_type, int region_type, int divide_type,
   }
   
   if (rsimd && rnosimd)                              { _gf_errno = GF_E_SIMD_NO; return 0; }
-  if (rcauchy && w > 32)                             { _gf_errno = GF_E_CAUGT32; return 0; }
   if (rcauchy && region_type != GF_REGION_CAUCHY)    { _gf_errno = GF_E_CAUCHYB; return 0; }
   if (rcauchy && mult_type == GF_MULT_COMPOSITE)     { _gf_errno = GF_E_CAUCOMP; return 0; }
 
@@ -417,6 +421,46 @@ int gf_error_check(int w, int mult_type, int region_type, int divide_type,
   return 0;
 }
 
+/* The scratch size, with or without the tables that gf_share_tables() can
+   keep out of the scratch memory.  gf_scratch_size() always counts them,
+   since the caller's scratch memory holds them. */
+
+static
+int gf_scratch_size_tables(int w, 
+                           int mult_type, 
+                           int region_type, 
+                           int divide_type, 
+                           int arg1, 
+                           int arg2,
+                           int tables)
+{
+  int s, cs;
+
+  if (gf_error_check(w, mult_type, region_type, divide_type, arg1, arg2, 0, NULL) == 0) return 0;
+  region_type &= ~GF_REGION_ONLY;
+
+  switch(w) {
+    case 4: s = gf_w4_scratch_size(mult_type, region_type, divide_type, arg1, arg2); break;
+    case 8: s = gf_w8_scratch_size(mult_type, region_type, divide_type, arg1, arg2); break;
+    case 16: s = gf_w16_scratch_size(mult_type, region_type, divide_type, arg1, arg2); break;
+    case 32: s = gf_w32_scratch_size(mult_type, region_type, divide_type, arg1, arg2); break;
+    case 64: s = gf_w64_scratch_size(mult_type, region_type, divide_type, arg1, arg2); break;
+    case 128: s = gf_w128_scratch_size(mult_type, region_type, divide_type, arg1, arg2); break;
+    default: s = gf_wgen_scratch_size(w, mult_type, region_type, divide_type, arg1, arg2); break;
+  }
+
+  if (s > 0 && tables) {
+    if (w == 8) s += gf_w8_shared_size(mult_type, region_type, arg1, arg2);
+    if (w == 16) s += gf_w16_shared_size(mult_type, region_type, arg1, arg2);
+  }
+
+  /* The Cauchy schedule cache goes at the end, on a 16-byte boundary. */
+
+  cs = gf_wgen_cauchy_cache_size(w, region_type);
+  if (s > 0 && cs > 0) s = ((s + 15) & ~15) + cs;
+  return s;
+}
+
 int gf_scratch_size(int w, 
                     int mult_type, 
                     int region_type, 
@@ -424,17 +468,134 @@ int gf_scratch_size(int w,
                     int arg1, 
                     int arg2)
 {
-  if (gf_error_check(w, mult_type, region_type, divide_type, arg1, arg2, 0, NULL) == 0) return 0;
+  return gf_scratch_size_tables(w, mult_type, region_type, divide_type, arg1, arg2, 1);
+}
 
-  switch(w) {
-    case 4: return gf_w4_scratch_size(mult_type, region_type, divide_type, arg1, arg2);
-    case 8: return gf_w8_scratch_size(mult_type, region_type, divide_type, arg1, arg2);
-    case 16: return gf_w16_scratch_size(mult_type, region_type, divide_type, arg1, arg2);
-    case 32: return gf_w32_scratch_size(mult_type, region_type, divide_type, arg1, arg2);
-    case 64: return gf_w64_scratch_size(mult_type, region_type, divide_type, arg1, arg2);
-    case 128: return gf_w128_scratch_size(mult_type, region_type, divide_type, arg1, arg2);
-    default: return gf_wgen_scratch_size(w, mult_type, region_type, divide_type, arg1, arg2);
+/* The shared tables are kept in a list keyed by the function that builds
+   them, the word size, the polynomial and the size.  The list is short, one
+   entry per configuration in use, and is only touched by gf_init_hard() and
+   gf_free(), so a single lock is plenty.  The tables are built while the
+   lock is held, which keeps two threads from building the same ones. */
+
+struct gf_shared_tables {
+  int (*build)(gf_t *gf, void *tables);
+  int w;
+  uint64_t prim_poly;
+  int bytes;
+  int refs;
+  uint32_t ready;       /* The parts built by gf_build_part() */
+  void *mem;
+  void *tables;         /* mem, aligned on 16 bytes */
+  struct gf_shared_tables *next;
+};
+
+static pthread_mutex_t gf_shared_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct gf_shared_tables *gf_shared_list = NULL;
+
+int gf_share_tables(gf_t *gf, int bytes, int (*build)(gf_t *gf, void *tables))
+{
+  gf_internal_t *h;
+  struct gf_shared_tables *st;
+  void *tables;
+
+  h = (gf_internal_t *) gf->scratch;
+
+  /* Tables in the caller's scratch memory.  Their parts are built on first
+     use, as they are for shared ones. */
+
+  if (!h->free_me) {
+    tables = (void *) (((uintptr_t) h->private + 15) & ~((uintptr_t) 15));
+    if (!build(gf, tables)) return 0;
+    h->private = tables;
+    h->parts = 0;
+    return 1;
+  }
+
+  pthread_mutex_lock(&gf_shared_lock);
+  for (st = gf_shared_list; st != NULL; st = st->next) {
+    if (st->build == build && st->w == h->w && st->prim_poly == h->prim_poly &&
+        st->bytes == bytes) break;
+  }
+
+  if (st == NULL) {
+    st = (struct gf_shared_tables *) malloc(sizeof(struct gf_shared_tables));
+    if (st == NULL) {
+      pthread_mutex_unlock(&gf_shared_lock);
+      return 0;
+    }
+    st->mem = malloc(bytes + 15);
+    if (st->mem == NULL) {
+      free(st);
+      pthread_mutex_unlock(&gf_shared_lock);
+      return 0;
+    }
+    st->tables = (void *) (((uintptr_t) st->mem + 15) & ~((uintptr_t) 15));
+    if (!build(gf, st->tables)) {
+      free(st->mem);
+      free(st);
+      pthread_mutex_unlock(&gf_shared_lock);
+      return 0;
+    }
+    st->build = build;
+    st->w = h->w;
+    st->prim_poly = h->prim_poly;
+    st->bytes = bytes;
+    st->refs = 0;
+    st->ready = 0;
+    st->next = gf_shared_list;
+    gf_shared_list = st;
   }
+
+  st->refs++;
+  h->parts = st->ready;
+  pthread_mutex_unlock(&gf_shared_lock);
+
+  h->shared = st;
+  h->private = st->tables;
+  return 1;
+}
+
+/* The parts are built under the list's lock too.  They are small enough,
+   and rare enough, that there is no point in a lock per entry.  The release
+   store into h->parts pairs with the acquire load in GF_NEED_PART(), so a
+   thread that sees the bit also sees the tables.  Tables in the caller's
+   scratch memory have no entry, and h->parts alone says what is built. */
+
+void gf_build_part(gf_t *gf, int part, void (*part_build)(gf_t *gf, void *tables))
+{
+  gf_internal_t *h;
+  struct gf_shared_tables *st;
+  uint32_t bit;
+
+  h = (gf_internal_t *) gf->scratch;
+  st = (struct gf_shared_tables *) h->shared;
+  bit = (uint32_t) 1 << part;
+
+  pthread_mutex_lock(&gf_shared_lock);
+  if (st == NULL) {
+    if (!(__atomic_load_n(&h->parts, __ATOMIC_RELAXED) & bit)) part_build(gf, h->private);
+  } else if (!(st->ready & bit)) {
+    part_build(gf, st->tables);
+    st->ready |= bit;
+  }
+  __atomic_fetch_or(&h->parts, bit, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&gf_shared_lock);
+}
+
+static void gf_release_tables(void *shared)
+{
+  struct gf_shared_tables *st, **p;
+
+  pthread_mutex_lock(&gf_shared_lock);
+  st = (struct gf_shared_tables *) shared;
+  st->refs--;
+  if (st->refs == 0) {
+    for (p = &gf_shared_list; *p != st; p = &(*p)->next) ;
+    *p = st->next;
+    free(st->mem);
+    free(st);
+  }
+  pthread_mutex_unlock(&gf_shared_lock);
 }
 
 extern int gf_size(gf_t *gf)
@@ -444,8 +605,10 @@ extern int gf_size(gf_t *gf)
 
   s = sizeof(gf_t);
   h = (gf_internal_t *) gf->scratch;
-  s += gf_scratch_size(h->w, h->mult_type, h->region_type, h->divide_type, h->arg1, h->arg2);
+  s += gf_scratch_size_tables(h->w, h->mult_type, h->region_type, h->divide_type, h->arg1, h->arg2,
+                              !h->free_me);
   if (h->mult_type == GF_MULT_COMPOSITE) s += gf_size(h->base_gf);
+  if (h->shared != NULL) s += ((struct gf_shared_tables *) h->shared)->bytes;
   return s;
 }
 
@@ -462,6 +625,24 @@ int gf_init_easy(gf_t *gf, int w)
        those aspects of initialization that don't rely on word size,
        and then take care of word-size-specific stuff. */
 
+/* Every gf_init_hard() gets its own id, which is what the per-thread region
+   contexts are keyed by.  Unlike the address of the scratch memory, an id is
+   never reused, so a context can't be mistaken for one of a gf_t that has
+   since been freed. */
+
+static pthread_mutex_t gf_id_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t gf_last_id = 0;
+
+static uint64_t gf_new_id()
+{
+  uint64_t id;
+
+  pthread_mutex_lock(&gf_id_lock);
+  id = ++gf_last_id;
+  pthread_mutex_unlock(&gf_id_lock);
+  return id;
+}
+
 int gf_init_hard(gf_t *gf, int w, int mult_type, 
                         int region_type,
                         int divide_type,
@@ -470,13 +651,17 @@ int gf_init_hard(gf_t *gf, int w, int mult_type,
                         gf_t *base_gf,
                         void *scratch_memory) 
 {
-  int sz;
+  int sz, cs, rv;
   gf_internal_t *h;
  
   if (gf_error_check(w, mult_type, region_type, divide_type, 
                      arg1, arg2, prim_poly, base_gf) == 0) return 0;
 
-  sz = gf_scratch_size(w, mult_type, region_type, divide_type, arg1, arg2);
+  /* When we allocate the scratch memory, it leaves out the tables that are
+     shared. */
+
+  sz = gf_scratch_size_tables(w, mult_type, region_type, divide_type, arg1, arg2,
+                              (scratch_memory != NULL));
   if (sz <= 0) return 0;  /* This shouldn't happen, as all errors should get caught
                              in gf_error_check() */
   
@@ -489,7 +674,8 @@ int gf_init_hard(gf_t *gf, int w, int mult_type,
   }
   gf->scratch = (void *) h;
   h->mult_type = mult_type;
-  h->region_type = region_type;
+  h->region_type = region_type & ~GF_REGION_ONLY;
+  h->region_only = ((region_type & GF_REGION_ONLY) != 0);
   h->divide_type = divide_type;
   h->w = w;
   h->prim_poly = prim_poly;
@@ -498,17 +684,32 @@ int gf_init_hard(gf_t *gf, int w, int mult_type,
   h->base_gf = base_gf;
   h->private = (void *) gf->scratch;
   h->private = (uint8_t *)h->private + (sizeof(gf_internal_t));
+  h->cauchy = NULL;
+  h->id = gf_new_id();
+  h->shared = NULL;
+  h->parts = 0xffffffff;
   gf->extract_word.w32 = NULL;
 
+  cs = gf_wgen_cauchy_cache_size(w, h->region_type);
+  if (cs > 0) gf_wgen_cauchy_cache_init(gf, (uint8_t *) h + sz - cs);
+
   switch(w) {
-    case 4: return gf_w4_init(gf);
-    case 8: return gf_w8_init(gf);
-    case 16: return gf_w16_init(gf);
-    case 32: return gf_w32_init(gf);
-    case 64: return gf_w64_init(gf);
-    case 128: return gf_w128_init(gf);
-    default: return gf_wgen_init(gf);
+    case 4: rv = gf_w4_init(gf); break;
+    case 8: rv = gf_w8_init(gf); break;
+    case 16: rv = gf_w16_init(gf); break;
+    case 32: rv = gf_w32_init(gf); break;
+    case 64: rv = gf_w64_init(gf); break;
+    case 128: rv = gf_w128_init(gf); break;
+    default: rv = gf_wgen_init(gf); break;
   }
+
+  /* A failed init may already have taken a reference on shared tables. */
+
+  if (rv == 0 && h->shared != NULL) {
+    gf_release_tables(h->shared);
+    h->shared = NULL;
+  }
+  return rv;
 }
 
 int gf_free(gf_t *gf, int recursive)
@@ -520,10 +721,111 @@ int gf_free(gf_t *gf, int recursive)
     gf_free(h->base_gf, 1);
     free(h->base_gf);
   }
+  if (h->cauchy != NULL) gf_wgen_cauchy_cache_free(gf);
+  if (h->shared != NULL) gf_release_tables(h->shared);
   if (h->free_me) free(h);
   return 0; /* Making compiler happy */
 }
 
+/* Per-thread region contexts.  Each thread has GF_REGION_CONTEXTS slots,
+   each holding one context of one gf_t.  When a thread works with more
+   contexts than that at once (a composite field and its base field, say),
+   the least recently used slot is handed over.  The memory is freed when
+   the thread exits. */
+
+struct gf_region_context_slot {
+  uint64_t id;          /* 0 if the slot is unused */
+  int key;
+  uint64_t used;
+  int bytes;
+  void *mem;
+  void *context;        /* mem, aligned on 16 bytes */
+};
+
+struct gf_region_contexts {
+  uint64_t clock;
+  struct gf_region_context_slot slot[GF_REGION_CONTEXTS];
+};
+
+static pthread_key_t gf_region_context_key;
+static pthread_once_t gf_region_context_once = PTHREAD_ONCE_INIT;
+static int gf_region_context_key_ok = 0;
+
+static void gf_region_contexts_free(void *arg)
+{
+  struct gf_region_contexts *rc;
+  int i;
+
+  rc = (struct gf_region_contexts *) arg;
+  for (i = 0; i < GF_REGION_CONTEXTS; i++) free(rc->slot[i].mem);
+  free(rc);
+}
+
+static void gf_region_context_key_init()
+{
+  gf_region_context_key_ok =
+    (pthread_key_create(&gf_region_context_key, gf_region_contexts_free) == 0);
+}
+
+static void gf_region_context_error(int bytes)
+{
+  fprintf(stderr, "Error in region multiply operation.\n");
+  fprintf(stderr, "Can't allocate a %d-byte context for this thread.\n", bytes);
+  assert(0);
+}
+
+void *gf_region_context(gf_t *gf, int key, int bytes, int *fresh)
+{
+  gf_internal_t *h;
+  struct gf_region_contexts *rc;
+  struct gf_region_context_slot *s;
+  int i;
+
+  h = (gf_internal_t *) gf->scratch;
+  pthread_once(&gf_region_context_once, gf_region_context_key_init);
+  if (!gf_region_context_key_ok) gf_region_context_error(bytes);
+
+  rc = (struct gf_region_contexts *) pthread_getspecific(gf_region_context_key);
+  if (rc == NULL) {
+    rc = (struct gf_region_contexts *) calloc(1, sizeof(struct gf_region_contexts));
+    if (rc == NULL || pthread_setspecific(gf_region_context_key, rc) != 0) {
+      gf_region_context_error(bytes);
+    }
+  }
+
+  s = rc->slot;
+  for (i = 0; i < GF_REGION_CONTEXTS; i++) {
+    if (rc->slot[i].id == h->id && rc->slot[i].key == key) {
+      s = rc->slot + i;
+      break;
+    }
+    if (rc->slot[i].used < s->used) s = rc->slot + i;
+  }
+  rc->clock++;
+  s->used = rc->clock;
+
+  if (s->id == h->id && s->key == key && s->bytes >= bytes) {
+    if (fresh != NULL) *fresh = 0;
+    return s->context;
+  }
+
+  if (s->bytes < bytes) {
+    free(s->mem);
+    s->mem = malloc(bytes + 16);
+    if (s->mem == NULL) {
+      s->id = 0;
+      s->bytes = 0;
+      gf_region_context_error(bytes);
+    }
+    s->bytes = bytes;
+    s->context = (void *) (((uintptr_t) s->mem + 15) & ~((uintptr_t) 15));
+  }
+  s->id = h->id;
+  s->key = key;
+  if (fresh != NULL) *fresh = 1;
+  return s->context;
+}
+
 void gf_alignment_error(char *s, int a)
 {
   fprintf(stderr, "Alignment error in %s:\n", s);
@@ -848,6 +1150,7 @@ void gf_set_region_data(gf_region_data *rd,
 
   uls %= a;
   if (uls != 0) uls = (a-uls);
+  if (uls > (unsigned long) bytes) uls = bytes;   /* Regions shorter than the alignment */
   rd->s_start = (uint8_t *)rd->src + uls;
   rd->d_start = (uint8_t *)rd->dest + uls;
   bytes -= uls;
@@ -1074,3 +1377,24 @@ static void gf_unaligned_xor(void *src, void *dest, int bytes)
     s8++;
   }
 }
+
+/* The four builders only differ in the element type. */
+
+#define GF_LINEAR_TABLE(name, type) \
+void name(type *table, type *basis, int n) \
+{ \
+  int j, k, half; \
+  type v; \
+ \
+  table[0] = 0; \
+  for (j = 0; j < n; j++) { \
+    half = 1 << j; \
+    v = basis[j]; \
+    for (k = 0; k < half; k++) table[half+k] = v ^ table[k]; \
+  } \
+}
+
+GF_LINEAR_TABLE(gf_linear_table_8, uint8_t)
+GF_LINEAR_TABLE(gf_linear_table_16, uint16_t)
+GF_LINEAR_TABLE(gf_linear_table_32, uint32_t)
+GF_LINEAR_TABLE(gf_linear_table_64, uint64_t)
@@ -0,0 +1,335 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_async.c
+ *
+ * Asynchronous region job queue.  See gf_async.h.
+ */
+
+#include "gf_int.h"
+#include "gf_async.h"
+#include "gf_matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+
+/* A bounded multi-producer, multi-consumer ring.  Slot i starts with a
+   sequence number, then the element.  A slot is free for the producer that
+   claims position pos when its sequence is pos, and holds the element for the
+   consumer that claims position pos when its sequence is pos+1.  Producers
+   and consumers claim positions by advancing tail and head with a
+   compare-and-swap, and after writing or reading the element, pass the slot
+   on by setting its sequence.  head and tail sit on their own cache lines. */
+
+typedef struct {
+  uint64_t head;
+  uint8_t pad1[56];
+  uint64_t tail;
+  uint8_t pad2[56];
+  uint64_t mask;
+  int esize;          /* Bytes of the element */
+  int ssize;          /* Bytes of a slot */
+  uint8_t *slots;
+} gf_async_ring_t;
+
+struct gf_async {
+  gf_t *gf;
+  int entries;
+  gf_async_ring_t sq;
+  gf_async_ring_t cq;
+
+  /* inflight is the number of jobs submitted and not collected, which
+     bounds both rings.  submitted and completed tell gf_async_free() when
+     every job has run. */
+
+  int inflight;
+  uint64_t submitted;
+  uint64_t completed;
+
+  /* Sleeping.  A thread that finds nothing to do counts itself in idle or
+     waiting, and then checks its ring again under the lock before it
+     sleeps.  Whoever adds to a ring checks the count after adding, and only
+     takes the lock to wake the sleepers if there are any. */
+
+  pthread_mutex_t lock;
+  pthread_cond_t work;
+  pthread_cond_t done;
+  int idle;
+  int waiting;
+  int quit;
+
+  int nthreads;
+  pthread_t *tids;
+};
+
+static int gf_async_ring_init(gf_async_ring_t *r, int entries, int esize)
+{
+  int i;
+
+  r->head = 0;
+  r->tail = 0;
+  r->mask = entries - 1;
+  r->esize = esize;
+  r->ssize = (sizeof(uint64_t) + esize + 7) / 8 * 8;
+  r->slots = (uint8_t *) malloc((size_t) r->ssize * entries);
+  if (r->slots == NULL) return 0;
+  for (i = 0; i < entries; i++) *(uint64_t *) (r->slots + (size_t) r->ssize * i) = i;
+  return 1;
+}
+
+/* Returns 0 if the ring is full.  Since inflight bounds the rings, that only
+   happens for a moment, while a consumer that has claimed the slot is still
+   reading it. */
+
+static int gf_async_ring_push(gf_async_ring_t *r, void *e)
+{
+  uint64_t pos, seq;
+  uint8_t *slot;
+
+  pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+  while (1) {
+    slot = r->slots + (size_t) r->ssize * (pos & r->mask);
+    seq = __atomic_load_n((uint64_t *) slot, __ATOMIC_ACQUIRE);
+    if (seq == pos) {
+      if (__atomic_compare_exchange_n(&r->tail, &pos, pos+1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+    } else if ((int64_t) (seq - pos) < 0) {
+      return 0;
+    } else {
+      pos = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+    }
+  }
+  memcpy(slot + sizeof(uint64_t), e, r->esize);
+  __atomic_store_n((uint64_t *) slot, pos+1, __ATOMIC_SEQ_CST);
+  return 1;
+}
+
+static int gf_async_ring_pop(gf_async_ring_t *r, void *e)
+{
+  uint64_t pos, seq;
+  uint8_t *slot;
+
+  pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+  while (1) {
+    slot = r->slots + (size_t) r->ssize * (pos & r->mask);
+    seq = __atomic_load_n((uint64_t *) slot, __ATOMIC_ACQUIRE);
+    if (seq == pos+1) {
+      if (__atomic_compare_exchange_n(&r->head, &pos, pos+1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+    } else if ((int64_t) (seq - (pos+1)) < 0) {
+      return 0;
+    } else {
+      pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+    }
+  }
+  memcpy(e, slot + sizeof(uint64_t), r->esize);
+  __atomic_store_n((uint64_t *) slot, pos + r->mask + 1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+/* Whether the slot at head holds an element.  Only used to decide whether to
+   sleep, so a stale answer just costs another trip around the loop. */
+
+static int gf_async_ring_ready(gf_async_ring_t *r)
+{
+  uint64_t pos;
+
+  pos = __atomic_load_n(&r->head, __ATOMIC_SEQ_CST);
+  return __atomic_load_n((uint64_t *) (r->slots + (size_t) r->ssize * (pos & r->mask)),
+                         __ATOMIC_SEQ_CST) == pos+1;
+}
+
+static void gf_async_wake(gf_async_t *q, int *count, pthread_cond_t *cond)
+{
+  if (__atomic_load_n(count, __ATOMIC_SEQ_CST) > 0) {
+    pthread_mutex_lock(&q->lock);
+    pthread_cond_broadcast(cond);
+    pthread_mutex_unlock(&q->lock);
+  }
+}
+
+static void gf_async_run(gf_async_t *q, gf_async_job_t *job)
+{
+  gf_async_completion_t c;
+  int ok;
+
+  ok = (job->src != NULL && job->dest != NULL && job->vals != NULL && job->bytes >= 0 &&
+        job->nsrc >= 1 && job->ndest >= 1);
+  if (ok) {
+    switch (job->op) {
+      case GF_ASYNC_MULTIPLY:
+        q->gf->multiply_region.w32(q->gf, job->src[0], job->dest[0], job->vals[0], job->bytes, job->xor);
+        break;
+      case GF_ASYNC_DOT:
+        gf_matrix_region_multiply(q->gf, job->vals, 1, job->nsrc, job->src, job->dest, job->bytes, job->xor);
+        break;
+      case GF_ASYNC_ENCODE:
+        gf_matrix_region_multiply(q->gf, job->vals, job->ndest, job->nsrc, job->src, job->dest,
+                                  job->bytes, job->xor);
+        break;
+      default:
+        ok = 0;
+    }
+  }
+
+  c.user_data = job->user_data;
+  c.status = ok;
+  while (!gf_async_ring_push(&q->cq, &c)) sched_yield();
+  __atomic_add_fetch(&q->completed, 1, __ATOMIC_SEQ_CST);
+  gf_async_wake(q, &q->waiting, &q->done);
+}
+
+/* Runs every queued job on the calling thread, when there are no workers. */
+
+static void gf_async_run_queued(gf_async_t *q)
+{
+  gf_async_job_t job;
+
+  while (gf_async_ring_pop(&q->sq, &job)) gf_async_run(q, &job);
+}
+
+static void *gf_async_worker(void *arg)
+{
+  gf_async_t *q;
+  gf_async_job_t job;
+
+  q = (gf_async_t *) arg;
+  while (1) {
+    if (gf_async_ring_pop(&q->sq, &job)) {
+      gf_async_run(q, &job);
+      continue;
+    }
+    pthread_mutex_lock(&q->lock);
+    if (q->quit) {
+      pthread_mutex_unlock(&q->lock);
+      return NULL;
+    }
+    __atomic_add_fetch(&q->idle, 1, __ATOMIC_SEQ_CST);
+    if (!gf_async_ring_ready(&q->sq)) pthread_cond_wait(&q->work, &q->lock);
+    __atomic_sub_fetch(&q->idle, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&q->lock);
+  }
+}
+
+gf_async_t *gf_async_create(gf_t *gf, int entries, int nthreads)
+{
+  gf_internal_t *h;
+  gf_async_t *q;
+  int i, n;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (h->w > 32 || entries <= 0 || entries > (1 << 24) || nthreads < 0) return NULL;
+  for (n = 1; n < entries; n <<= 1) ;
+
+  q = (gf_async_t *) calloc(1, sizeof(gf_async_t));
+  if (q == NULL) return NULL;
+  q->gf = gf;
+  q->entries = n;
+  q->tids = (pthread_t *) malloc(sizeof(pthread_t) * (nthreads + 1));
+  if (q->tids == NULL || !gf_async_ring_init(&q->sq, n, sizeof(gf_async_job_t))) {
+    free(q->tids);
+    free(q);
+    return NULL;
+  }
+  if (!gf_async_ring_init(&q->cq, n, sizeof(gf_async_completion_t))) {
+    free(q->sq.slots);
+    free(q->tids);
+    free(q);
+    return NULL;
+  }
+  pthread_mutex_init(&q->lock, NULL);
+  pthread_cond_init(&q->work, NULL);
+  pthread_cond_init(&q->done, NULL);
+
+  for (i = 0; i < nthreads; i++) {
+    if (pthread_create(q->tids + i, NULL, gf_async_worker, q) != 0) break;
+  }
+  q->nthreads = i;
+  return q;
+}
+
+void gf_async_free(gf_async_t *q)
+{
+  int i;
+
+  if (q == NULL) return;
+  if (q->nthreads == 0) {
+    gf_async_run_queued(q);
+  } else {
+    pthread_mutex_lock(&q->lock);
+    __atomic_add_fetch(&q->waiting, 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&q->completed, __ATOMIC_SEQ_CST) !=
+           __atomic_load_n(&q->submitted, __ATOMIC_SEQ_CST)) {
+      pthread_cond_wait(&q->done, &q->lock);
+    }
+    __atomic_sub_fetch(&q->waiting, 1, __ATOMIC_SEQ_CST);
+    q->quit = 1;
+    pthread_cond_broadcast(&q->work);
+    pthread_mutex_unlock(&q->lock);
+    for (i = 0; i < q->nthreads; i++) pthread_join(q->tids[i], NULL);
+  }
+
+  pthread_mutex_destroy(&q->lock);
+  pthread_cond_destroy(&q->work);
+  pthread_cond_destroy(&q->done);
+  free(q->sq.slots);
+  free(q->cq.slots);
+  free(q->tids);
+  free(q);
+}
+
+int gf_async_submit(gf_async_t *q, gf_async_job_t *job)
+{
+  if (__atomic_add_fetch(&q->inflight, 1, __ATOMIC_SEQ_CST) > q->entries) {
+    __atomic_sub_fetch(&q->inflight, 1, __ATOMIC_SEQ_CST);
+    return 0;
+  }
+  __atomic_add_fetch(&q->submitted, 1, __ATOMIC_SEQ_CST);
+  while (!gf_async_ring_push(&q->sq, job)) sched_yield();
+
+  /* Without workers, the job is run by a poller, which may be asleep. */
+
+  if (q->nthreads == 0) {
+    gf_async_wake(q, &q->waiting, &q->done);
+  } else {
+    gf_async_wake(q, &q->idle, &q->work);
+  }
+  return 1;
+}
+
+int gf_async_poll(gf_async_t *q, gf_async_completion_t *c, int max)
+{
+  int n;
+
+  if (q->nthreads == 0) gf_async_run_queued(q);
+  for (n = 0; n < max && gf_async_ring_pop(&q->cq, c + n); n++) ;
+
+  /* A waiter may be waiting for jobs that this call just collected. */
+
+  if (n > 0) {
+    __atomic_sub_fetch(&q->inflight, n, __ATOMIC_SEQ_CST);
+    gf_async_wake(q, &q->waiting, &q->done);
+  }
+  return n;
+}
+
+int gf_async_wait(gf_async_t *q, gf_async_completion_t *c, int min, int max)
+{
+  int n;
+
+  if (min > max) min = max;
+  n = 0;
+  while (1) {
+    n += gf_async_poll(q, c + n, max - n);
+    if (n >= min || __atomic_load_n(&q->inflight, __ATOMIC_SEQ_CST) == 0) return n;
+    pthread_mutex_lock(&q->lock);
+    __atomic_add_fetch(&q->waiting, 1, __ATOMIC_SEQ_CST);
+    if (!gf_async_ring_ready(&q->cq) && __atomic_load_n(&q->inflight, __ATOMIC_SEQ_CST) > 0 &&
+        !(q->nthreads == 0 && gf_async_ring_ready(&q->sq))) {
+      pthread_cond_wait(&q->done, &q->lock);
+    }
+    __atomic_sub_fetch(&q->waiting, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&q->lock);
+  }
+}
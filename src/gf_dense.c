@@ -0,0 +1,314 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_dense.c
+ *
+ * Dense matrices over GF(2^w).  See gf_dense.h.
+ */
+
+#include "gf_int.h"
+#include "gf_dense.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Matrices up to GF_DENSE_L2 bytes are eliminated in one panel.  Bigger ones
+   use panels of GF_DENSE_PANEL bytes of columns, and the rest of each row is
+   updated in chunks of GF_DENSE_CHUNK bytes, so that a panel's pivot rows
+   (at most GF_DENSE_PANEL * 8 / w of them) stay in cache. */
+
+#define GF_DENSE_L2 (256 * 1024)
+#define GF_DENSE_PANEL (256)
+#define GF_DENSE_CHUNK (2048)
+
+struct gf_dense {
+  gf_t *gf;
+  int w;
+  int rows;
+  int cols;
+  int stride;       /* Bytes per row, a multiple of 16 */
+  uint8_t **row;    /* row[i] points into base.  Swaps just swap pointers. */
+  uint8_t *base;
+  uint8_t *spare;   /* One more row, for multiplications that aren't in place */
+  void *mem;
+};
+
+gf_dense_t *gf_dense_create(gf_t *gf, int rows, int cols)
+{
+  gf_internal_t *h;
+  gf_dense_t *m;
+  int i;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (h->w != 4 && h->w != 8 && h->w != 16 && h->w != 32) return NULL;
+  if (h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY)) return NULL;
+  if (rows <= 0 || cols <= 0) return NULL;
+
+  m = (gf_dense_t *) malloc(sizeof(gf_dense_t));
+  if (m == NULL) return NULL;
+  m->gf = gf;
+  m->w = h->w;
+  m->rows = rows;
+  m->cols = cols;
+  m->stride = (((cols * h->w + 7) / 8) + 15) & ~15;
+  m->row = (uint8_t **) malloc(sizeof(uint8_t *) * rows);
+  m->mem = calloc((size_t) m->stride * (rows+1) + 16, 1);
+  if (m->row == NULL || m->mem == NULL) {
+    gf_dense_free(m);
+    return NULL;
+  }
+  m->base = (uint8_t *) (((uintptr_t) m->mem + 15) & ~((uintptr_t) 15));
+  for (i = 0; i < rows; i++) m->row[i] = m->base + (size_t) i * m->stride;
+  m->spare = m->base + (size_t) rows * m->stride;
+  return m;
+}
+
+gf_dense_t *gf_dense_copy(gf_dense_t *m)
+{
+  gf_dense_t *c;
+  int i;
+
+  c = gf_dense_create(m->gf, m->rows, m->cols);
+  if (c == NULL) return NULL;
+  for (i = 0; i < m->rows; i++) memcpy(c->row[i], m->row[i], m->stride);
+  return c;
+}
+
+void gf_dense_free(gf_dense_t *m)
+{
+  if (m == NULL) return;
+  free(m->row);
+  free(m->mem);
+  free(m);
+}
+
+int gf_dense_rows(gf_dense_t *m)
+{
+  return m->rows;
+}
+
+int gf_dense_cols(gf_dense_t *m)
+{
+  return m->cols;
+}
+
+void *gf_dense_row(gf_dense_t *m, int i)
+{
+  return m->row[i];
+}
+
+static uint32_t gf_dense_elt(int w, uint8_t *r, int c)
+{
+  switch (w) {
+    case 4: return (r[c/2] >> ((c & 1) * 4)) & 0xf;
+    case 8: return r[c];
+    case 16: return ((uint16_t *) r)[c];
+    default: return ((uint32_t *) r)[c];
+  }
+}
+
+uint32_t gf_dense_get(gf_dense_t *m, int row, int col)
+{
+  return gf_dense_elt(m->w, m->row[row], col);
+}
+
+void gf_dense_set(gf_dense_t *m, int row, int col, uint32_t val)
+{
+  uint8_t *r;
+
+  r = m->row[row];
+  switch (m->w) {
+    case 4: r[col/2] = (r[col/2] & (0xf0 >> ((col & 1) * 4))) | ((val & 0xf) << ((col & 1) * 4)); break;
+    case 8: r[col] = val; break;
+    case 16: ((uint16_t *) r)[col] = val; break;
+    default: ((uint32_t *) r)[col] = val; break;
+  }
+}
+
+/* Multiplies bytes [off, off+len) of row r by f, in place, using the spare
+   row. */
+
+static void gf_dense_scale(gf_dense_t *m, uint8_t *r, uint32_t f, int off, int len)
+{
+  if (f == 1) return;
+  m->gf->multiply_region.w32(m->gf, r + off, m->spare + off, f, len, 0);
+  memcpy(r + off, m->spare + off, len);
+}
+
+/* Applies the row operations of one panel to bytes [off, off+len) of every
+   row.  Pivot p is storage row piv[p], which was scaled by sc[p], and then
+   f[id*pc+p] times it was added to every other storage row id.
+
+   Pivot row p is first brought to the state that it had when it became a
+   pivot (call that T_p), in increasing order of p, since T_p only depends on
+   the earlier T's.  Every other row is then the sum of f times the T's.  Last,
+   the pivot rows are finished in increasing order, since pivot q only needs
+   the T's of the later pivots. */
+
+static void gf_dense_replay(gf_dense_t *m, int *piv, uint32_t *sc, int np, uint32_t *f, int pc,
+                            char *is_piv, int off, int len)
+{
+  gf_t *gf;
+  int p, q, id;
+  uint8_t *d;
+  uint32_t e;
+
+  gf = m->gf;
+  for (p = 0; p < np; p++) {
+    d = m->base + (size_t) piv[p] * m->stride + off;
+    for (q = 0; q < p; q++) {
+      e = f[piv[p]*pc+q];
+      if (e != 0) gf->multiply_region.w32(gf, m->base + (size_t) piv[q] * m->stride + off, d, e, len, 1);
+    }
+    gf_dense_scale(m, d - off, sc[p], off, len);
+  }
+
+  for (id = 0; id < m->rows; id++) {
+    if (is_piv[id]) continue;
+    d = m->base + (size_t) id * m->stride + off;
+    for (p = 0; p < np; p++) {
+      e = f[id*pc+p];
+      if (e != 0) gf->multiply_region.w32(gf, m->base + (size_t) piv[p] * m->stride + off, d, e, len, 1);
+    }
+  }
+
+  for (q = 0; q < np; q++) {
+    d = m->base + (size_t) piv[q] * m->stride + off;
+    for (p = q+1; p < np; p++) {
+      e = f[piv[q]*pc+p];
+      if (e != 0) gf->multiply_region.w32(gf, m->base + (size_t) piv[p] * m->stride + off, d, e, len, 1);
+    }
+  }
+}
+
+/* Gauss-Jordan elimination, with pivots only in the first "limit" columns.
+   Returns the rank, or -1 if it runs out of memory.
+
+   A pivot row is zero before its pivot column, so row operations start at
+   the pivot column's byte, rounded down to 16, which keeps the source and
+   destination aligned. */
+
+static int gf_dense_eliminate(gf_dense_t *m, int limit)
+{
+  gf_t *gf;
+  int w, r, i, c, c0, pc, pbytes, pstart, pend, start, np, off, len, *piv;
+  uint32_t v, e, *sc, *f;
+  uint8_t *t;
+  char *is_piv;
+
+  gf = m->gf;
+  w = m->w;
+  pbytes = ((size_t) m->rows * m->stride <= GF_DENSE_L2) ? m->stride : GF_DENSE_PANEL;
+  pc = pbytes * 8 / w;
+
+  piv = (int *) malloc(sizeof(int) * pc);
+  sc = (uint32_t *) malloc(sizeof(uint32_t) * pc);
+  f = (uint32_t *) malloc(sizeof(uint32_t) * pc * m->rows);
+  is_piv = (char *) calloc(m->rows, 1);
+  if (piv == NULL || sc == NULL || f == NULL || is_piv == NULL) {
+    free(piv); free(sc); free(f); free(is_piv);
+    return -1;
+  }
+
+  r = 0;
+  for (c0 = 0; c0 < limit && r < m->rows; c0 += pc) {
+    pstart = c0 * w / 8;
+    pend = (pstart + pbytes < m->stride) ? pstart + pbytes : m->stride;
+    np = 0;
+
+    for (c = c0; c < c0 + pc && c < limit && r < m->rows; c++) {
+      for (i = r; i < m->rows && gf_dense_elt(w, m->row[i], c) == 0; i++) ;
+      if (i == m->rows) continue;
+      t = m->row[i];
+      m->row[i] = m->row[r];
+      m->row[r] = t;
+
+      start = (c * w / 8) & ~15;
+      v = gf->inverse.w32(gf, gf_dense_elt(w, t, c));
+      gf_dense_scale(m, t, v, start, pend - start);
+      piv[np] = (t - m->base) / m->stride;
+      sc[np] = v;
+      is_piv[piv[np]] = 1;
+
+      for (i = 0; i < m->rows; i++) {
+        if (i == r) continue;
+        e = gf_dense_elt(w, m->row[i], c);
+        f[((m->row[i] - m->base) / m->stride) * pc + np] = e;
+        if (e != 0) gf->multiply_region.w32(gf, t + start, m->row[i] + start, e, pend - start, 1);
+      }
+      np++;
+      r++;
+    }
+
+    for (off = pend; off < m->stride; off += GF_DENSE_CHUNK) {
+      len = (m->stride - off < GF_DENSE_CHUNK) ? m->stride - off : GF_DENSE_CHUNK;
+      gf_dense_replay(m, piv, sc, np, f, pc, is_piv, off, len);
+    }
+    for (i = 0; i < np; i++) is_piv[piv[i]] = 0;
+  }
+
+  free(piv);
+  free(sc);
+  free(f);
+  free(is_piv);
+  return r;
+}
+
+int gf_dense_rref(gf_dense_t *m)
+{
+  return gf_dense_eliminate(m, m->cols);
+}
+
+int gf_dense_rank(gf_dense_t *m)
+{
+  gf_dense_t *c;
+  int r;
+
+  c = gf_dense_copy(m);
+  if (c == NULL) return -1;
+  r = gf_dense_eliminate(c, c->cols);
+  gf_dense_free(c);
+  return r;
+}
+
+/* Reduces [a | b] and copies the right half into x.  a's padding columns sit
+   between the halves, so that b starts on a 16-byte boundary, and they never
+   get pivots. */
+
+int gf_dense_solve(gf_dense_t *a, gf_dense_t *b, gf_dense_t *x)
+{
+  gf_dense_t *aug;
+  int i, r;
+
+  if (a->rows != a->cols || b->rows != a->rows) return 0;
+  if (x->rows != b->rows || x->cols != b->cols) return 0;
+
+  aug = gf_dense_create(a->gf, a->rows, a->stride * 8 / a->w + b->cols);
+  if (aug == NULL) return 0;
+  for (i = 0; i < a->rows; i++) {
+    memcpy(aug->row[i], a->row[i], a->stride);
+    memcpy(aug->row[i] + a->stride, b->row[i], b->stride);
+  }
+
+  r = gf_dense_eliminate(aug, a->cols);
+  if (r == a->rows) {
+    for (i = 0; i < a->rows; i++) memcpy(x->row[i], aug->row[i] + a->stride, x->stride);
+  }
+  gf_dense_free(aug);
+  return (r == a->rows);
+}
+
+int gf_dense_invert(gf_dense_t *m, gf_dense_t *inv)
+{
+  gf_dense_t *id;
+  int i, rv;
+
+  if (m->rows != m->cols) return 0;
+  id = gf_dense_create(m->gf, m->rows, m->cols);
+  if (id == NULL) return 0;
+  for (i = 0; i < m->rows; i++) gf_dense_set(id, i, i, 1);
+  rv = gf_dense_solve(m, id, inv);
+  gf_dense_free(id);
+  return rv;
+}
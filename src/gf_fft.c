@@ -0,0 +1,366 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_fft.c
+ *
+ * Reed-Solomon coding with the additive FFT.  See gf_fft.h.
+ *
+ * The field element i is the evaluation point of fragment position i, so the
+ * points 0 to 2^t - 1 form the subspace W_t spanned by 1, 2, ..., 2^(t-1).
+ * s_j(x) is the product of (x - a) over a in W_j.  It is GF(2)-linear, and
+ * s_(j+1)(x) = s_j(x) * (s_j(x) + s_j(2^j)).  The normalized polynomial
+ * sh_j(x) = s_j(x) / s_j(2^j) is zero on W_j and one at 2^j, and the basis
+ * polynomial X_i is the product of sh_j over the one bits j of i.
+ *
+ * A polynomial with 2n coefficients in this basis is D0(x) + sh_(t-1)(x) D1(x),
+ * and sh_(t-1) is the constant c = sh_(t-1)(beta) on beta + W_(t-1), and c+1 on
+ * the other half of beta + W_t.  So the evaluations on beta + W_t are those of
+ * D0 + c*D1 on the first half, and of D0 + (c+1)*D1 on the second: one region
+ * multiplication and one XOR per pair of coefficients.
+ */
+
+#include "gf_int.h"
+#include "gf_fft.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+struct gf_fft {
+  gf_t *gf;
+  int k;
+  int m;
+  int kp;             /* K:  smallest power of two >= k */
+  int n;              /* N:  smallest power of two >= K + m */
+  int t;              /* N = 2^t */
+  uint32_t q;         /* 2^w - 1 */
+  uint32_t s[32];     /* s_j(2^j) */
+  uint32_t sinv[32];  /* 1 / s_j(2^j) */
+  uint32_t d[32];     /* The derivative of sh_j, which is a constant */
+  uint32_t *log;      /* Discrete logs, base a primitive element */
+  uint32_t *exp;
+  uint32_t *walsh;    /* Walsh-Hadamard transform of the logs of 0 .. N-1 */
+};
+
+/* sh_j(x) */
+
+static uint32_t gf_fft_shat(gf_fft_t *fft, int j, uint32_t x)
+{
+  gf_t *gf;
+  int i;
+
+  gf = fft->gf;
+  for (i = 0; i < j; i++) x = gf->multiply.w32(gf, x, x ^ fft->s[i]);
+  return gf->multiply.w32(gf, x, fft->sinv[j]);
+}
+
+/* The Walsh-Hadamard transform mod q, in place.  It is its own inverse, up to
+   a factor of n. */
+
+static void gf_fft_fwht(uint32_t *v, int n, uint32_t q)
+{
+  int h, i, j;
+  uint32_t a, b;
+
+  for (h = 1; h < n; h <<= 1) {
+    for (i = 0; i < n; i += 2*h) {
+      for (j = i; j < i + h; j++) {
+        a = v[j];
+        b = v[j+h];
+        v[j] = (a + b) % q;
+        v[j+h] = (a + q - b) % q;
+      }
+    }
+  }
+}
+
+gf_fft_t *gf_fft_create(gf_t *gf, int k, int m)
+{
+  gf_internal_t *h;
+  gf_fft_t *fft;
+  uint32_t g, x, deriv;
+  int i, j, w;
+
+  h = (gf_internal_t *) gf->scratch;
+  w = h->w;
+  if (w > 16 || k <= 0 || m <= 0) return NULL;
+
+  fft = (gf_fft_t *) malloc(sizeof(gf_fft_t));
+  if (fft == NULL) return NULL;
+  fft->gf = gf;
+  fft->k = k;
+  fft->m = m;
+  for (fft->kp = 1; fft->kp < k; fft->kp <<= 1) ;
+  for (fft->n = 1, fft->t = 0; fft->n < fft->kp + m; fft->n <<= 1) fft->t++;
+  if (fft->kp + m > (1 << w)) { free(fft); return NULL; }
+  fft->q = (1 << w) - 1;
+
+  fft->log = (uint32_t *) malloc(sizeof(uint32_t) * (fft->q+1) * 2);
+  fft->walsh = (uint32_t *) malloc(sizeof(uint32_t) * fft->n);
+  if (fft->log == NULL || fft->walsh == NULL) {
+    gf_fft_free(fft);
+    return NULL;
+  }
+  fft->exp = fft->log + fft->q + 1;
+
+  /* Find a primitive element, since the field's polynomial need not be
+     primitive, and build the log tables from it. */
+
+  for (g = (fft->q == 1) ? 1 : 2; g <= fft->q; g++) {
+    x = 1;
+    for (i = 0; i < (int) fft->q; i++) {
+      fft->exp[i] = x;
+      fft->log[x] = i;
+      x = gf->multiply.w32(gf, x, g);
+      if (x == 1) break;
+    }
+    if (i >= (int) fft->q - 1) break;
+  }
+  if (g > fft->q) {
+    gf_fft_free(fft);
+    return NULL;
+  }
+  fft->exp[fft->q] = 1;
+
+  /* s_j(2^j), computed with the recurrence for s_(j+1), and the derivatives:
+     s_0' = 1 and s_(j+1)' = s_j(2^j) s_j', because squares have no derivative
+     in characteristic two. */
+
+  deriv = 1;
+  for (j = 0; j < w; j++) {
+    x = 1 << j;
+    for (i = 0; i < j; i++) x = gf->multiply.w32(gf, x, x ^ fft->s[i]);
+    fft->s[j] = x;
+    fft->sinv[j] = gf->inverse.w32(gf, x);
+    fft->d[j] = gf->multiply.w32(gf, deriv, fft->sinv[j]);
+    deriv = gf->multiply.w32(gf, deriv, x);
+  }
+
+  /* The decoder's error locator needs the sum of log(i ^ e) over the erasures
+     e, which is a convolution over XOR.  The log of 0 is a placeholder, which
+     only ends up in entries that the decoder ignores. */
+
+  fft->walsh[0] = 0;
+  for (i = 1; i < fft->n; i++) fft->walsh[i] = fft->log[i];
+  gf_fft_fwht(fft->walsh, fft->n, fft->q);
+  return fft;
+}
+
+void gf_fft_free(gf_fft_t *fft)
+{
+  if (fft == NULL) return;
+  free(fft->log);
+  free(fft->walsh);
+  free(fft);
+}
+
+/* Evaluates the polynomial whose n coefficients are in r at beta + W_t, in
+   place.  Only the outputs below count are needed, so blocks past it are
+   skipped. */
+
+static void gf_fft_forward(gf_fft_t *fft, void **r, int n, uint32_t beta, int count, int bytes)
+{
+  gf_t *gf;
+  int hl, j, u, i;
+  uint32_t c;
+
+  gf = fft->gf;
+  for (hl = n/2, j = 0; (1 << j) < hl; j++) ;
+  for (; hl >= 1; hl >>= 1, j--) {
+    for (u = 0; u < n && u < count; u += 2*hl) {
+      c = gf_fft_shat(fft, j, beta ^ u);
+      for (i = u; i < u + hl; i++) {
+        if (c != 0) gf->multiply_region.w32(gf, r[i+hl], r[i], c, bytes, 1);
+        gf_multby_one(r[i], r[i+hl], bytes, 1);
+      }
+    }
+  }
+}
+
+/* The inverse of gf_fft_forward() with count = n. */
+
+static void gf_fft_inverse(gf_fft_t *fft, void **r, int n, uint32_t beta, int bytes)
+{
+  gf_t *gf;
+  int hl, j, u, i;
+  uint32_t c;
+
+  gf = fft->gf;
+  for (hl = 1, j = 0; hl < n; hl <<= 1, j++) {
+    for (u = 0; u < n; u += 2*hl) {
+      c = gf_fft_shat(fft, j, beta ^ u);
+      for (i = u; i < u + hl; i++) {
+        gf_multby_one(r[i], r[i+hl], bytes, 1);
+        if (c != 0) gf->multiply_region.w32(gf, r[i+hl], r[i], c, bytes, 1);
+      }
+    }
+  }
+}
+
+/* The formal derivative, in place.  X_i' is the sum, over the one bits j of i,
+   of sh_j' X_(i - 2^j), so coefficient i of the derivative only reads
+   coefficients above i. */
+
+static void gf_fft_derivative(gf_fft_t *fft, void **r, int n, int bytes)
+{
+  gf_t *gf;
+  int i, j, xor;
+
+  gf = fft->gf;
+  for (i = 0; i < n; i++) {
+    xor = 0;
+    for (j = 0; (1 << j) < n; j++) {
+      if (i & (1 << j)) continue;
+      gf->multiply_region.w32(gf, r[i + (1 << j)], r[i], fft->d[j], bytes, xor);
+      xor = 1;
+    }
+    if (!xor) memset(r[i], 0, bytes);
+  }
+}
+
+/* Allocates n regions that have the same alignment, mod 16, as ref.  The
+   pointer to free is returned, and the regions are put into r. */
+
+static void *gf_fft_alloc_regions(void *ref, int n, int bytes, void **r)
+{
+  void *mem;
+  uint8_t *p;
+  int i, size;
+
+  size = (bytes + 15) & ~15;
+  mem = malloc((size_t) size * n + 32);
+  if (mem == NULL) return NULL;
+  p = (uint8_t *) (((uintptr_t) mem + 15) & ~((uintptr_t) 15));
+  p += (uintptr_t) ref & 15;
+  for (i = 0; i < n; i++) r[i] = p + (size_t) i * size;
+  return mem;
+}
+
+int gf_fft_encode(gf_fft_t *fft, void **data, void **coding, int bytes)
+{
+  void **coef, **r, *mem;
+  int i, kp, done, count;
+
+  kp = fft->kp;
+  coef = (void **) malloc(sizeof(void *) * kp * 2);
+  if (coef == NULL) return 0;
+  r = coef + kp;
+  mem = gf_fft_alloc_regions(data[0], kp, bytes, coef);
+  if (mem == NULL) {
+    free(coef);
+    return 0;
+  }
+
+  /* Interpolate the data, and then evaluate on the cosets K*c + W_K, for c =
+     1, 2, ...  Every coset but the last is entirely coding fragments, so the
+     transform runs in place on them, and the last one borrows the coefficient
+     regions for the positions past m. */
+
+  for (i = 0; i < kp; i++) {
+    if (i < fft->k) memcpy(coef[i], data[i], bytes); else memset(coef[i], 0, bytes);
+  }
+  gf_fft_inverse(fft, coef, kp, 0, bytes);
+
+  for (done = 0; done < fft->m; done += count) {
+    count = fft->m - done;
+    if (count > kp) count = kp;
+    for (i = 0; i < kp; i++) {
+      if (i < count) {
+        r[i] = coding[done+i];
+        memcpy(r[i], coef[i], bytes);
+      } else {
+        r[i] = coef[i];
+      }
+    }
+    gf_fft_forward(fft, r, kp, kp + done, count, bytes);
+  }
+
+  free(mem);
+  free(coef);
+  return 1;
+}
+
+/* Decoding follows Lin, Al-Naffouri, Han and Chung.  Let f be the polynomial
+   of the code word, and pi(x) the product of (x - e) over the erased positions
+   e, which include every position past the code.  f*pi has degree < N, and we
+   know its value everywhere:  it is zero at the erasures.  At an erasure e,
+   (f*pi)'(e) = f(e) pi'(e), so one interpolation, a derivative and one
+   evaluation give every erased value.  The logs of pi at the surviving
+   positions, and of pi' at the erased ones, are one XOR convolution. */
+
+int gf_fft_decode(gf_fft_t *fft, int *erasures, void **data, void **coding, int bytes)
+{
+  gf_t *gf;
+  int n, nc, e, i, p, rv, *erased;
+  uint32_t *lp, q, v, ninv;
+  void **r, *mem, *src;
+  uint64_t prod;
+
+  gf = fft->gf;
+  n = fft->n;
+  nc = fft->kp + fft->m;
+  q = fft->q;
+
+  erased = (int *) calloc(n, sizeof(int));
+  lp = (uint32_t *) malloc(sizeof(uint32_t) * n);
+  r = (void **) malloc(sizeof(void *) * n);
+  if (erased == NULL || lp == NULL || r == NULL) {
+    free(erased); free(lp); free(r);
+    return 0;
+  }
+
+  e = 0;
+  rv = 1;
+  for (i = 0; rv && erasures[i] != -1; i++) {
+    if (erasures[i] < 0 || erasures[i] >= fft->k + fft->m) { rv = 0; break; }
+    p = (erasures[i] < fft->k) ? erasures[i] : erasures[i] - fft->k + fft->kp;
+    if (!erased[p]) e++;
+    erased[p] = 1;
+  }
+  if (e > fft->m) rv = 0;
+  mem = NULL;
+  if (e == 0 || !rv) goto done;
+  for (i = nc; i < n; i++) erased[i] = 1;
+
+  /* lp[i] = the sum of log(i ^ e) over the erasures, mod q.  2^w is one mod q,
+     so 1/N is 2^(w-t). */
+
+  for (i = 0; i < n; i++) lp[i] = erased[i];
+  gf_fft_fwht(lp, n, q);
+  for (i = 0; i < n; i++) {
+    prod = (uint64_t) lp[i] * fft->walsh[i];
+    lp[i] = prod % q;
+  }
+  gf_fft_fwht(lp, n, q);
+  ninv = (1 << (((gf_internal_t *) gf->scratch)->w - fft->t)) % q;
+  for (i = 0; i < n; i++) lp[i] = ((uint64_t) lp[i] * ninv) % q;
+
+  mem = gf_fft_alloc_regions(data[0], n, bytes, r);
+  if (mem == NULL) { rv = 0; goto done; }
+
+  for (i = 0; i < n; i++) {
+    if (erased[i] || (i >= fft->k && i < fft->kp)) {
+      memset(r[i], 0, bytes);
+    } else {
+      src = (i < fft->k) ? data[i] : coding[i - fft->kp];
+      gf->multiply_region.w32(gf, src, r[i], fft->exp[lp[i]], bytes, 0);
+    }
+  }
+
+  gf_fft_inverse(fft, r, n, 0, bytes);
+  gf_fft_derivative(fft, r, n, bytes);
+  gf_fft_forward(fft, r, n, 0, nc, bytes);
+
+  for (i = 0; i < nc; i++) {
+    if (!erased[i] || (i >= fft->k && i < fft->kp)) continue;
+    v = fft->exp[(q - lp[i]) % q];
+    gf->multiply_region.w32(gf, r[i], (i < fft->k) ? data[i] : coding[i - fft->kp], v, bytes, 0);
+  }
+
+done:
+  free(mem);
+  free(erased);
+  free(lp);
+  free(r);
+  return rv;
+}
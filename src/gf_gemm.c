@@ -0,0 +1,344 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_gemm.c
+ *
+ * Tiled matrix-matrix multiplication.  See gf_gemm.h.
+ */
+
+#include "gf_int.h"
+#include "gf_gemm.h"
+#include "gf_matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/* Rows of A per register block, bytes of C per tile, and the size of the B
+   block that should stay in cache. */
+
+#define GF_GEMM_ROWS (4)
+#define GF_GEMM_TILE (32)
+#define GF_GEMM_L2 (256 * 1024)
+
+typedef struct {
+  gf_t *gf;
+  int w;
+  int m;
+  int k;
+  uint32_t *a;
+  uint8_t **b;
+  uint8_t **c;
+  int xor;
+  uint8_t *tables;    /* Split tables for every element of A, or NULL */
+  int tsize;          /* Bytes of tables per element */
+  int start;          /* This thread's byte range of the columns */
+  int end;
+} gf_gemm_job_t;
+
+/* For w = 8, the tables of a are a*x and a*(x << 4), for x < 16.  For w = 16,
+   they are the low and then the high bytes of a*(x << 4j), for j = 0 to 3.
+   Since multiplication is linear, only a times each bit is computed with
+   multiply, and the rest are XORs of those. */
+
+static void gf_gemm_build_tables(gf_t *gf, int w, uint32_t a, uint8_t *t)
+{
+  uint32_t bit[16], v;
+  int j, x, b;
+
+  for (b = 0; b < w; b++) bit[b] = gf->multiply.w32(gf, a, 1 << b);
+  for (j = 0; j < w/4; j++) {
+    for (x = 0; x < 16; x++) {
+      v = 0;
+      for (b = 0; b < 4; b++) if (x & (1 << b)) v ^= bit[4*j+b];
+      if (w == 8) {
+        t[j*16+x] = v;
+      } else {
+        t[j*16+x] = v & 0xff;
+        t[64+j*16+x] = v >> 8;
+      }
+    }
+  }
+}
+
+#ifdef INTEL_SSSE3
+
+/* Rows i0 to i0+R-1 of C, for the tiles in [off, end).  R is a constant at
+   each call, so that the accumulators live in registers. */
+
+static inline void gf_gemm_w8_block(gf_gemm_job_t *job, int i0, int R, int off, int end)
+{
+  __m128i acc[GF_GEMM_ROWS][2], mask, b0, b1, l0, l1, h0, h1, tl, th;
+  uint8_t *t;
+  int o, l, r;
+
+  mask = _mm_set1_epi8(0x0f);
+  for (o = off; o + GF_GEMM_TILE <= end; o += GF_GEMM_TILE) {
+    for (r = 0; r < R; r++) {
+      if (job->xor) {
+        acc[r][0] = _mm_loadu_si128((__m128i *) (job->c[i0+r] + o));
+        acc[r][1] = _mm_loadu_si128((__m128i *) (job->c[i0+r] + o + 16));
+      } else {
+        acc[r][0] = _mm_setzero_si128();
+        acc[r][1] = _mm_setzero_si128();
+      }
+    }
+    for (l = 0; l < job->k; l++) {
+      b0 = _mm_loadu_si128((__m128i *) (job->b[l] + o));
+      b1 = _mm_loadu_si128((__m128i *) (job->b[l] + o + 16));
+      l0 = _mm_and_si128(b0, mask);
+      l1 = _mm_and_si128(b1, mask);
+      h0 = _mm_and_si128(_mm_srli_epi64(b0, 4), mask);
+      h1 = _mm_and_si128(_mm_srli_epi64(b1, 4), mask);
+      for (r = 0; r < R; r++) {
+        t = job->tables + ((size_t) (i0+r) * job->k + l) * 32;
+        tl = _mm_load_si128((__m128i *) t);
+        th = _mm_load_si128((__m128i *) (t + 16));
+        acc[r][0] = _mm_xor_si128(acc[r][0], _mm_xor_si128(_mm_shuffle_epi8(tl, l0), _mm_shuffle_epi8(th, h0)));
+        acc[r][1] = _mm_xor_si128(acc[r][1], _mm_xor_si128(_mm_shuffle_epi8(tl, l1), _mm_shuffle_epi8(th, h1)));
+      }
+    }
+    for (r = 0; r < R; r++) {
+      _mm_storeu_si128((__m128i *) (job->c[i0+r] + o), acc[r][0]);
+      _mm_storeu_si128((__m128i *) (job->c[i0+r] + o + 16), acc[r][1]);
+    }
+  }
+}
+
+/* For w = 16, a tile is 16 words.  They are split into a vector of low bytes
+   and one of high bytes, and the accumulators stay split until the store. */
+
+static inline void gf_gemm_w16_block(gf_gemm_job_t *job, int i0, int R, int off, int end)
+{
+  __m128i lo[GF_GEMM_ROWS], hi[GF_GEMM_ROWS], mask, bmask, v0, v1, vl, vh, n[4];
+  uint8_t *t;
+  int o, l, r, j;
+
+  mask = _mm_set1_epi8(0x0f);
+  bmask = _mm_set1_epi16(0x00ff);
+  for (o = off; o + GF_GEMM_TILE <= end; o += GF_GEMM_TILE) {
+    for (r = 0; r < R; r++) {
+      if (job->xor) {
+        v0 = _mm_loadu_si128((__m128i *) (job->c[i0+r] + o));
+        v1 = _mm_loadu_si128((__m128i *) (job->c[i0+r] + o + 16));
+        lo[r] = _mm_packus_epi16(_mm_and_si128(v0, bmask), _mm_and_si128(v1, bmask));
+        hi[r] = _mm_packus_epi16(_mm_srli_epi16(v0, 8), _mm_srli_epi16(v1, 8));
+      } else {
+        lo[r] = _mm_setzero_si128();
+        hi[r] = _mm_setzero_si128();
+      }
+    }
+    for (l = 0; l < job->k; l++) {
+      v0 = _mm_loadu_si128((__m128i *) (job->b[l] + o));
+      v1 = _mm_loadu_si128((__m128i *) (job->b[l] + o + 16));
+      vl = _mm_packus_epi16(_mm_and_si128(v0, bmask), _mm_and_si128(v1, bmask));
+      vh = _mm_packus_epi16(_mm_srli_epi16(v0, 8), _mm_srli_epi16(v1, 8));
+      n[0] = _mm_and_si128(vl, mask);
+      n[1] = _mm_and_si128(_mm_srli_epi64(vl, 4), mask);
+      n[2] = _mm_and_si128(vh, mask);
+      n[3] = _mm_and_si128(_mm_srli_epi64(vh, 4), mask);
+      for (r = 0; r < R; r++) {
+        t = job->tables + ((size_t) (i0+r) * job->k + l) * 128;
+        for (j = 0; j < 4; j++) {
+          lo[r] = _mm_xor_si128(lo[r], _mm_shuffle_epi8(_mm_load_si128((__m128i *) (t + j*16)), n[j]));
+          hi[r] = _mm_xor_si128(hi[r], _mm_shuffle_epi8(_mm_load_si128((__m128i *) (t + 64 + j*16)), n[j]));
+        }
+      }
+    }
+    for (r = 0; r < R; r++) {
+      _mm_storeu_si128((__m128i *) (job->c[i0+r] + o), _mm_unpacklo_epi8(lo[r], hi[r]));
+      _mm_storeu_si128((__m128i *) (job->c[i0+r] + o + 16), _mm_unpackhi_epi8(lo[r], hi[r]));
+    }
+  }
+}
+
+/* The bytes past the last whole tile, one word at a time, so that the tiled
+   path has no alignment requirements at all. */
+
+static void gf_gemm_tail(gf_gemm_job_t *job, int off, int end)
+{
+  gf_t *gf;
+  int i, l, o, wb;
+  uint32_t sum, v;
+  uint8_t *p;
+
+  gf = job->gf;
+  wb = job->w / 8;
+  for (i = 0; i < job->m; i++) {
+    for (o = off; o + wb <= end; o += wb) {
+      p = job->c[i] + o;
+      sum = (!job->xor) ? 0 : (wb == 1) ? p[0] : (p[0] | (p[1] << 8));
+      for (l = 0; l < job->k; l++) {
+        p = job->b[l] + o;
+        v = (wb == 1) ? p[0] : (p[0] | (p[1] << 8));
+        sum ^= gf->multiply.w32(gf, job->a[i*job->k+l], v);
+      }
+      p = job->c[i] + o;
+      p[0] = sum;
+      if (wb == 2) p[1] = sum >> 8;
+    }
+  }
+}
+
+static void gf_gemm_block(gf_gemm_job_t *job, int i0, int off, int end)
+{
+  int rows;
+
+  rows = job->m - i0;
+  if (job->w == 8) {
+    switch (rows) {
+      case 1: gf_gemm_w8_block(job, i0, 1, off, end); break;
+      case 2: gf_gemm_w8_block(job, i0, 2, off, end); break;
+      case 3: gf_gemm_w8_block(job, i0, 3, off, end); break;
+      default: gf_gemm_w8_block(job, i0, 4, off, end); break;
+    }
+  } else {
+    switch (rows) {
+      case 1: gf_gemm_w16_block(job, i0, 1, off, end); break;
+      case 2: gf_gemm_w16_block(job, i0, 2, off, end); break;
+      case 3: gf_gemm_w16_block(job, i0, 3, off, end); break;
+      default: gf_gemm_w16_block(job, i0, 4, off, end); break;
+    }
+  }
+}
+#endif
+
+/* Does columns [start, end) of C.  With tables, that is column blocks of B
+   that fit in L2, and within each, every block of rows of A.  Otherwise, it's
+   gf_matrix_region_multiply() on the range. */
+
+static void *gf_gemm_thread(void *arg)
+{
+  gf_gemm_job_t *job;
+  uint8_t *bp[256], *cp[256], **b, **c;
+  int i;
+
+  job = (gf_gemm_job_t *) arg;
+
+#ifdef INTEL_SSSE3
+  if (job->tables != NULL) {
+    int nc, off, end;
+
+    nc = (GF_GEMM_L2 / job->k) & ~(GF_GEMM_TILE-1);
+    if (nc < GF_GEMM_TILE) nc = GF_GEMM_TILE;
+    for (off = job->start; off < job->end; off += nc) {
+      end = (off + nc < job->end) ? off + nc : job->end;
+      for (i = 0; i < job->m; i += GF_GEMM_ROWS) gf_gemm_block(job, i, off, end);
+    }
+    gf_gemm_tail(job, job->start + ((job->end - job->start) & ~(GF_GEMM_TILE-1)), job->end);
+    return NULL;
+  }
+#endif
+
+  if (job->start < job->end) {
+    b = (job->k <= 256) ? bp : (uint8_t **) malloc(sizeof(uint8_t *) * job->k);
+    c = (job->m <= 256) ? cp : (uint8_t **) malloc(sizeof(uint8_t *) * job->m);
+    if (b == NULL || c == NULL) {
+      if (b != bp) free(b);
+      if (c != cp) free(c);
+      return (void *) job;
+    }
+    for (i = 0; i < job->k; i++) b[i] = job->b[i] + job->start;
+    for (i = 0; i < job->m; i++) c[i] = job->c[i] + job->start;
+    gf_matrix_region_multiply(job->gf, job->a, job->m, job->k, (void **) b, (void **) c,
+                              job->end - job->start, job->xor);
+    if (b != bp) free(b);
+    if (c != cp) free(c);
+  }
+  return NULL;
+}
+
+int gf_gemm(gf_t *gf, int m, int k, uint32_t *a, void **b, void **c, int bytes,
+            int xor, int nthreads)
+{
+  gf_internal_t *h;
+  gf_gemm_job_t *jobs, *more;
+  pthread_t *tids;
+  void *mem, *rv;
+  int i, t, per, ok, *started;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (m <= 0 || k <= 0 || bytes <= 0) return 1;
+
+  jobs = (gf_gemm_job_t *) malloc(sizeof(gf_gemm_job_t));
+  if (jobs == NULL) return 0;
+  jobs->gf = gf;
+  jobs->w = h->w;
+  jobs->m = m;
+  jobs->k = k;
+  jobs->a = a;
+  jobs->b = (uint8_t **) b;
+  jobs->c = (uint8_t **) c;
+  jobs->xor = xor;
+  jobs->tables = NULL;
+  jobs->tsize = 0;
+  mem = NULL;
+
+#ifdef INTEL_SSSE3
+  if ((h->w == 8 || h->w == 16) && !(h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY))) {
+    jobs->tsize = (h->w == 8) ? 32 : 128;
+    mem = malloc((size_t) m * k * jobs->tsize + 16);
+    if (mem == NULL) { free(jobs); return 0; }
+    jobs->tables = (uint8_t *) (((uintptr_t) mem + 15) & ~((uintptr_t) 15));
+    for (i = 0; i < m*k; i++) gf_gemm_build_tables(gf, h->w, a[i], jobs->tables + (size_t) i * jobs->tsize);
+  }
+#endif
+
+  /* Each thread gets a range of whole 64-byte blocks, so that the regions stay
+     aligned with respect to each other when the fallback cuts them. */
+
+  if (h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY) ||
+      (h->w != 4 && h->w != 8 && h->w != 16 && h->w != 32)) nthreads = 1;
+  if (nthreads > bytes / 64) nthreads = bytes / 64;
+  if (nthreads < 1) nthreads = 1;
+
+  ok = 1;
+  if (nthreads == 1) {
+    jobs->start = 0;
+    jobs->end = bytes;
+    ok = (gf_gemm_thread(jobs) == NULL);
+  } else {
+    more = (gf_gemm_job_t *) realloc(jobs, sizeof(gf_gemm_job_t) * nthreads);
+    if (more != NULL) jobs = more;
+    tids = (pthread_t *) malloc(sizeof(pthread_t) * nthreads);
+    started = (int *) malloc(sizeof(int) * nthreads);
+    if (more == NULL || tids == NULL || started == NULL) {
+      free(jobs);
+      free(tids);
+      free(started);
+      free(mem);
+      return 0;
+    }
+    per = (bytes / 64 / nthreads) * 64;
+    for (t = 0; t < nthreads; t++) {
+      jobs[t] = jobs[0];
+      jobs[t].start = t * per;
+      jobs[t].end = (t == nthreads-1) ? bytes : (t+1) * per;
+    }
+
+    /* The calling thread does the first range, and any range whose thread
+       couldn't be started. */
+
+    for (t = 1; t < nthreads; t++) {
+      started[t] = (pthread_create(&tids[t], NULL, gf_gemm_thread, &jobs[t]) == 0);
+    }
+    for (t = 0; t < nthreads; t++) {
+      if (t == 0 || !started[t]) {
+        if (gf_gemm_thread(&jobs[t]) != NULL) ok = 0;
+      }
+    }
+    for (t = 1; t < nthreads; t++) {
+      if (started[t]) {
+        pthread_join(tids[t], &rv);
+        if (rv != NULL) ok = 0;
+      }
+    }
+    free(tids);
+    free(started);
+  }
+
+  free(jobs);
+  free(mem);
+  return ok;
+}
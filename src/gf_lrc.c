@@ -0,0 +1,290 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_lrc.c
+ *
+ * Local Reconstruction Codes over GF(2^w).  See gf_lrc.h.
+ */
+
+#include "gf_int.h"
+#include "gf_lrc.h"
+#include "gf_matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+struct gf_lrc {
+  gf_t *gf;
+  int k;
+  int l;
+  int r;
+  int *start;         /* Group g is data start[g] to start[g+1]-1 */
+  uint32_t *encode;   /* (l+r) x k matrix:  l local rows of ones, then r global rows */
+};
+
+gf_lrc_t *gf_lrc_create(gf_t *gf, int k, int l, int r)
+{
+  gf_internal_t *h;
+  gf_lrc_t *lrc;
+  int g, i, j;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (h->w > 32) return NULL;
+  if (k <= 0 || l <= 0 || l > k || r < 0) return NULL;
+  if (h->w < 32 && k + r > (1 << h->w)) return NULL;
+
+  lrc = (gf_lrc_t *) malloc(sizeof(gf_lrc_t));
+  if (lrc == NULL) return NULL;
+  lrc->gf = gf;
+  lrc->k = k;
+  lrc->l = l;
+  lrc->r = r;
+  lrc->start = (int *) malloc(sizeof(int)*(l+1));
+  lrc->encode = (uint32_t *) malloc(sizeof(uint32_t)*(l+r)*k);
+  if (lrc->start == NULL || lrc->encode == NULL) {
+    gf_lrc_free(lrc);
+    return NULL;
+  }
+
+  for (g = 0; g <= l; g++) lrc->start[g] = g*k/l;
+  for (g = 0; g < l; g++) {
+    for (i = 0; i < k; i++) lrc->encode[g*k+i] = (i >= lrc->start[g] && i < lrc->start[g+1]);
+  }
+
+  /* The global rows are the Cauchy matrix 1/(x_j + y_i), with x_j = j and
+     y_i = r+i.  Every square submatrix of a Cauchy matrix is invertible. */
+
+  for (j = 0; j < r; j++) {
+    for (i = 0; i < k; i++) lrc->encode[(l+j)*k+i] = gf->inverse.w32(gf, j ^ (r+i));
+  }
+  return lrc;
+}
+
+void gf_lrc_free(gf_lrc_t *lrc)
+{
+  if (lrc == NULL) return;
+  free(lrc->start);
+  free(lrc->encode);
+  free(lrc);
+}
+
+int gf_lrc_group(gf_lrc_t *lrc, int id)
+{
+  int g;
+
+  if (id < 0) return -1;
+  if (id >= lrc->k) return (id < lrc->k + lrc->l) ? id - lrc->k : -1;
+  for (g = 0; id >= lrc->start[g+1]; g++) ;
+  return g;
+}
+
+void gf_lrc_encode(gf_lrc_t *lrc, void **data, void **coding, int bytes)
+{
+  gf_matrix_region_multiply(lrc->gf, lrc->encode, lrc->l + lrc->r, lrc->k, data, coding, bytes, 0);
+}
+
+int gf_lrc_repair(gf_lrc_t *lrc, int lost, void **data, void **coding, int bytes)
+{
+  int g, i, written;
+  uint8_t *dest;
+
+  if (lost < 0 || lost >= lrc->k + lrc->l + lrc->r) return 0;
+
+  if (lost >= lrc->k + lrc->l) {
+    i = lost - lrc->k;
+    gf_matrix_region_multiply(lrc->gf, lrc->encode + i*lrc->k, 1, lrc->k, data, coding + i, bytes, 0);
+    return 1;
+  }
+
+  /* The group's data and its local parity XOR to zero, so the lost member is
+     the XOR of the others. */
+
+  g = gf_lrc_group(lrc, lost);
+  dest = (uint8_t *) ((lost < lrc->k) ? data[lost] : coding[g]);
+  written = 0;
+  for (i = lrc->start[g]; i < lrc->start[g+1]; i++) {
+    if (i == lost) continue;
+    gf_multby_one(data[i], dest, bytes, written);
+    written = 1;
+  }
+  if (lost < lrc->k) gf_multby_one(coding[g], dest, bytes, written);
+  return 1;
+}
+
+/* Allocates a region that has the same alignment, mod 16, as ref.  The pointer
+   to free is put into *mem. */
+
+static uint8_t *gf_lrc_alloc_like(void *ref, int bytes, void **mem)
+{
+  uint8_t *p;
+
+  *mem = malloc(bytes + 32);
+  if (*mem == NULL) return NULL;
+  p = (uint8_t *) (((uintptr_t) *mem + 15) & ~((uintptr_t) 15));
+  return p + ((uintptr_t) ref & 15);
+}
+
+/* Solves for the erased data fragments, using the surviving parities.  Each
+   surviving parity gives an equation over the erased data:
+
+     sum over erased i of c_i * d_i  =  parity + sum over surviving i of c_i * d_i
+
+   We pick e independent equations, compute the right hand sides as regions, and
+   multiply them by the inverse of the e x e system. */
+
+static int gf_lrc_solve(gf_lrc_t *lrc, int *erased, void **data, void **coding, int bytes)
+{
+  gf_t *gf;
+  int k, n, e, nk, i, j, t, p, npar, ok;
+  int *lost, *known, *eqs, *pivot;
+  uint32_t *row, *basis, *a, *inv, *rhsm, f;
+  void **src, **rhs, **dest, **mem;
+
+  gf = lrc->gf;
+  k = lrc->k;
+  n = k + lrc->l + lrc->r;
+
+  lost = (int *) malloc(sizeof(int)*k*2);
+  if (lost == NULL) return 0;
+  known = lost + k;
+  e = 0;
+  nk = 0;
+  for (i = 0; i < k; i++) {
+    if (erased[i]) lost[e++] = i; else known[nk++] = i;
+  }
+  if (e == 0) { free(lost); return 1; }
+
+  /* Pick e independent equations, by reducing each candidate against the
+     ones that we have already picked. */
+
+  eqs = (int *) malloc(sizeof(int)*e*2);
+  pivot = eqs + e;
+  row = (uint32_t *) malloc(sizeof(uint32_t)*e);
+  basis = (uint32_t *) malloc(sizeof(uint32_t)*e*e);
+  if (eqs == NULL || row == NULL || basis == NULL) {
+    free(lost);
+    free(eqs);
+    free(row);
+    free(basis);
+    return 0;
+  }
+  t = 0;
+  for (p = k; p < n && t < e; p++) {
+    if (erased[p]) continue;
+    for (i = 0; i < e; i++) row[i] = lrc->encode[(p-k)*k + lost[i]];
+    for (j = 0; j < t; j++) {
+      f = row[pivot[j]];
+      if (f == 0) continue;
+      for (i = 0; i < e; i++) row[i] ^= gf->multiply.w32(gf, basis[j*e+i], f);
+    }
+    for (i = 0; i < e && row[i] == 0; i++) ;
+    if (i == e) continue;
+
+    /* Scale the new basis row so that its pivot is one. */
+
+    f = gf->inverse.w32(gf, row[i]);
+    for (j = 0; j < e; j++) basis[t*e+j] = gf->multiply.w32(gf, row[j], f);
+    pivot[t] = i;
+    eqs[t++] = p;
+  }
+  free(row);
+  free(basis);
+  if (t < e) {
+    free(lost);
+    free(eqs);
+    return 0;
+  }
+
+  /* The system matrix, and the matrix that computes the right hand sides from
+     the surviving data and the chosen parities. */
+
+  a = (uint32_t *) malloc(sizeof(uint32_t)*e*e);
+  inv = (uint32_t *) malloc(sizeof(uint32_t)*e*e);
+  npar = nk + e;
+  rhsm = (uint32_t *) malloc(sizeof(uint32_t)*e*npar);
+  src = (void **) malloc(sizeof(void *)*(npar + 3*e));
+  if (a == NULL || inv == NULL || rhsm == NULL || src == NULL) {
+    free(a);
+    free(inv);
+    free(rhsm);
+    free(src);
+    free(lost);
+    free(eqs);
+    return 0;
+  }
+  for (t = 0; t < e; t++) {
+    for (i = 0; i < e; i++) a[t*e+i] = lrc->encode[(eqs[t]-k)*k + lost[i]];
+    for (i = 0; i < nk; i++) rhsm[t*npar+i] = lrc->encode[(eqs[t]-k)*k + known[i]];
+    for (i = 0; i < e; i++) rhsm[t*npar+nk+i] = (i == t);
+  }
+  ok = gf_matrix_invert(gf, a, inv, e);
+
+  rhs = src + npar;
+  dest = rhs + e;
+  mem = dest + e;
+  for (i = 0; i < nk; i++) src[i] = data[known[i]];
+  for (t = 0; t < e; t++) src[nk+t] = coding[eqs[t]-k];
+  for (i = 0; i < e; i++) {
+    dest[i] = data[lost[i]];
+    rhs[i] = gf_lrc_alloc_like(dest[i], bytes, &mem[i]);
+    if (rhs[i] == NULL) ok = 0;
+  }
+
+  if (ok) {
+    gf_matrix_region_multiply(gf, rhsm, e, npar, src, rhs, bytes, 0);
+    gf_matrix_region_multiply(gf, inv, e, e, rhs, dest, bytes, 0);
+  }
+
+  for (i = 0; i < e; i++) free(mem[i]);
+  free(src);
+  free(a);
+  free(inv);
+  free(rhsm);
+  free(lost);
+  free(eqs);
+  if (ok) {
+    for (i = 0; i < k; i++) erased[i] = 0;
+  }
+  return ok;
+}
+
+int gf_lrc_decode(gf_lrc_t *lrc, int *erasures, void **data, void **coding, int bytes)
+{
+  int *erased, n, g, i, m, lost, rv;
+
+  n = lrc->k + lrc->l + lrc->r;
+  erased = (int *) calloc(n, sizeof(int));
+  if (erased == NULL) return 0;
+  for (i = 0; erasures[i] != -1; i++) {
+    if (erasures[i] < 0 || erasures[i] >= n) { free(erased); return 0; }
+    erased[erasures[i]] = 1;
+  }
+
+  /* First, repair every group that is only missing one member.  Each repair
+     can't enable another one, since groups don't overlap, so one sweep is
+     enough. */
+
+  for (g = 0; g < lrc->l; g++) {
+    m = erased[lrc->k + g];
+    lost = lrc->k + g;
+    for (i = lrc->start[g]; i < lrc->start[g+1]; i++) {
+      if (erased[i]) { m++; lost = i; }
+    }
+    if (m == 1) {
+      gf_lrc_repair(lrc, lost, data, coding, bytes);
+      erased[lost] = 0;
+    }
+  }
+
+  /* Then solve for the remaining data, and recompute the lost parities. */
+
+  rv = gf_lrc_solve(lrc, erased, data, coding, bytes);
+  if (rv) {
+    for (i = lrc->k; i < n; i++) {
+      if (erased[i]) gf_lrc_repair(lrc, i, data, coding, bytes);
+    }
+  }
+  free(erased);
+  return rv;
+}
@@ -0,0 +1,493 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_matrix.c
+ *
+ * Matrix inversion over GF(2^w), a cache of decoding matrices, and
+ * multiplication of a matrix by a vector of regions.
+ */
+
+#include "gf_int.h"
+#include "gf_matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+int gf_matrix_invert(gf_t *gf, uint32_t *mat, uint32_t *inv, int rows)
+{
+  gf_internal_t *h;
+  int i, j, k;
+  uint32_t tmp, e, *ri, *rj, *ii, *ij;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (h->w > 32 || rows <= 0) return 0;
+
+  for (i = 0; i < rows*rows; i++) inv[i] = 0;
+  for (i = 0; i < rows; i++) inv[i*rows+i] = 1;
+
+  for (i = 0; i < rows; i++) {
+
+    /* Find a row with a non-zero i,i element, and swap it into row i.
+       If there isn't one, then the matrix is not invertible. */
+
+    for (j = i; j < rows && mat[j*rows+i] == 0; j++) ;
+    if (j == rows) return 0;
+    if (j != i) {
+      for (k = 0; k < rows; k++) {
+        tmp = mat[i*rows+k]; mat[i*rows+k] = mat[j*rows+k]; mat[j*rows+k] = tmp;
+        tmp = inv[i*rows+k]; inv[i*rows+k] = inv[j*rows+k]; inv[j*rows+k] = tmp;
+      }
+    }
+
+    ri = mat + i*rows;
+    ii = inv + i*rows;
+
+    /* Scale row i so that the i,i element is one. */
+
+    if (ri[i] != 1) {
+      e = gf->inverse.w32(gf, ri[i]);
+      for (k = 0; k < rows; k++) {
+        ri[k] = gf->multiply.w32(gf, ri[k], e);
+        ii[k] = gf->multiply.w32(gf, ii[k], e);
+      }
+    }
+
+    /* Now zero out column i in every other row, by adding a multiple of row i. */
+
+    for (j = 0; j < rows; j++) {
+      if (j == i) continue;
+      rj = mat + j*rows;
+      e = rj[i];
+      if (e == 0) continue;
+      ij = inv + j*rows;
+      if (e == 1) {
+        for (k = 0; k < rows; k++) {
+          rj[k] ^= ri[k];
+          ij[k] ^= ii[k];
+        }
+      } else {
+        for (k = 0; k < rows; k++) {
+          rj[k] ^= gf->multiply.w32(gf, ri[k], e);
+          ij[k] ^= gf->multiply.w32(gf, ii[k], e);
+        }
+      }
+    }
+  }
+  return 1;
+}
+
+/* The decode cache is a hash table of entries, keyed by the sorted ids of the
+   survivors, threaded onto a doubly linked list in least recently used order.
+   The head of the list is the most recently used entry. */
+
+struct gf_decode_entry {
+  uint64_t hash;
+  int *ids;
+  uint32_t *inv;
+  struct gf_decode_entry *hnext;
+  struct gf_decode_entry *prev;
+  struct gf_decode_entry *next;
+};
+
+struct gf_decode_cache {
+  gf_t *gf;
+  int k;
+  int m;
+  uint32_t *coding;
+  int capacity;
+  int size;
+  int nbuckets;
+  struct gf_decode_entry **buckets;
+  struct gf_decode_entry *head;
+  struct gf_decode_entry *tail;
+  uint64_t hits;
+  uint64_t misses;
+  pthread_mutex_t lock;
+};
+
+gf_decode_cache_t *gf_decode_cache_create(gf_t *gf, int k, int m, uint32_t *coding_matrix, int capacity)
+{
+  gf_decode_cache_t *c;
+
+  if (((gf_internal_t *) gf->scratch)->w > 32) return NULL;
+  if (k <= 0 || m < 0 || capacity <= 0) return NULL;
+
+  c = (gf_decode_cache_t *) malloc(sizeof(gf_decode_cache_t));
+  if (c == NULL) return NULL;
+  c->gf = gf;
+  c->k = k;
+  c->m = m;
+  c->capacity = capacity;
+  c->size = 0;
+  c->hits = 0;
+  c->misses = 0;
+  c->head = NULL;
+  c->tail = NULL;
+
+  /* Keep the load factor at or below one half. */
+
+  for (c->nbuckets = 16; c->nbuckets < capacity*2; c->nbuckets <<= 1) ;
+  c->buckets = (struct gf_decode_entry **) calloc(c->nbuckets, sizeof(struct gf_decode_entry *));
+  c->coding = (uint32_t *) malloc(sizeof(uint32_t) * (m > 0 ? m*k : 1));
+  if (c->buckets == NULL || c->coding == NULL) {
+    free(c->buckets);
+    free(c->coding);
+    free(c);
+    return NULL;
+  }
+  memcpy(c->coding, coding_matrix, sizeof(uint32_t)*m*k);
+  pthread_mutex_init(&c->lock, NULL);
+  return c;
+}
+
+void gf_decode_cache_free(gf_decode_cache_t *c)
+{
+  struct gf_decode_entry *e, *next;
+
+  if (c == NULL) return;
+  for (e = c->head; e != NULL; e = next) {
+    next = e->next;
+    free(e->ids);
+    free(e->inv);
+    free(e);
+  }
+  pthread_mutex_destroy(&c->lock);
+  free(c->buckets);
+  free(c->coding);
+  free(c);
+}
+
+void gf_decode_cache_stats(gf_decode_cache_t *c, uint64_t *hits, uint64_t *misses)
+{
+  pthread_mutex_lock(&c->lock);
+  if (hits != NULL) *hits = c->hits;
+  if (misses != NULL) *misses = c->misses;
+  pthread_mutex_unlock(&c->lock);
+}
+
+/* FNV-1a over the sorted survivor ids. */
+
+static uint64_t gf_decode_hash(int *ids, int k)
+{
+  uint64_t h;
+  int i;
+
+  h = 0xcbf29ce484222325ULL;
+  for (i = 0; i < k; i++) {
+    h ^= (uint64_t) ids[i];
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+static struct gf_decode_entry *gf_decode_find(gf_decode_cache_t *c, int *ids, uint64_t hash)
+{
+  struct gf_decode_entry *e;
+
+  for (e = c->buckets[hash & (c->nbuckets-1)]; e != NULL; e = e->hnext) {
+    if (e->hash == hash && memcmp(e->ids, ids, sizeof(int)*c->k) == 0) return e;
+  }
+  return NULL;
+}
+
+static void gf_decode_unlink(gf_decode_cache_t *c, struct gf_decode_entry *e)
+{
+  if (e->prev != NULL) e->prev->next = e->next; else c->head = e->next;
+  if (e->next != NULL) e->next->prev = e->prev; else c->tail = e->prev;
+}
+
+static void gf_decode_push_front(gf_decode_cache_t *c, struct gf_decode_entry *e)
+{
+  e->prev = NULL;
+  e->next = c->head;
+  if (c->head != NULL) c->head->prev = e;
+  c->head = e;
+  if (c->tail == NULL) c->tail = e;
+}
+
+static void gf_decode_evict(gf_decode_cache_t *c)
+{
+  struct gf_decode_entry *e, **p;
+
+  e = c->tail;
+  gf_decode_unlink(c, e);
+  for (p = &c->buckets[e->hash & (c->nbuckets-1)]; *p != e; p = &(*p)->hnext) ;
+  *p = e->hnext;
+  c->size--;
+  free(e->ids);
+  free(e->inv);
+  free(e);
+}
+
+int gf_decode_cache_lookup(gf_decode_cache_t *c, int *survivors, uint32_t *inv)
+{
+  int *ids, i, j, k, n, t;
+  uint32_t *mat;
+  uint64_t hash;
+  struct gf_decode_entry *e, *e2;
+
+  k = c->k;
+  n = c->k + c->m;
+
+  /* Sort the survivors (insertion sort -- k is small), and make sure that they
+     are distinct and legal. */
+
+  ids = (int *) malloc(sizeof(int)*k);
+  if (ids == NULL) return 0;
+  for (i = 0; i < k; i++) {
+    t = survivors[i];
+    if (t < 0 || t >= n) { free(ids); return 0; }
+    for (j = i; j > 0 && ids[j-1] > t; j--) ids[j] = ids[j-1];
+    ids[j] = t;
+  }
+  for (i = 1; i < k; i++) {
+    if (ids[i] == ids[i-1]) { free(ids); return 0; }
+  }
+  hash = gf_decode_hash(ids, k);
+
+  pthread_mutex_lock(&c->lock);
+  e = gf_decode_find(c, ids, hash);
+  if (e != NULL) {
+    c->hits++;
+    if (e != c->head) {
+      gf_decode_unlink(c, e);
+      gf_decode_push_front(c, e);
+    }
+    memcpy(inv, e->inv, sizeof(uint32_t)*k*k);
+    pthread_mutex_unlock(&c->lock);
+    free(ids);
+    return 1;
+  }
+  c->misses++;
+  pthread_mutex_unlock(&c->lock);
+
+  /* It's a miss -- build the rows of the distribution matrix for the survivors
+     and invert them.  This is done without holding the lock, so that other
+     threads can keep hitting the cache while we do the elimination. */
+
+  mat = (uint32_t *) malloc(sizeof(uint32_t)*k*k);
+  if (mat == NULL) {
+    free(ids);
+    return 0;
+  }
+  for (i = 0; i < k; i++) {
+    if (ids[i] < k) {
+      for (j = 0; j < k; j++) mat[i*k+j] = (j == ids[i]);
+    } else {
+      memcpy(mat+i*k, c->coding+(ids[i]-k)*k, sizeof(uint32_t)*k);
+    }
+  }
+  if (!gf_matrix_invert(c->gf, mat, inv, k)) {
+    free(mat);
+    free(ids);
+    return 0;
+  }
+  free(mat);
+
+  /* inv is right either way, so if there's no memory to cache it, it just
+     isn't cached. */
+
+  e = (struct gf_decode_entry *) malloc(sizeof(struct gf_decode_entry));
+  if (e == NULL) {
+    free(ids);
+    return 1;
+  }
+  e->hash = hash;
+  e->ids = ids;
+  e->inv = (uint32_t *) malloc(sizeof(uint32_t)*k*k);
+  if (e->inv == NULL) {
+    free(ids);
+    free(e);
+    return 1;
+  }
+  memcpy(e->inv, inv, sizeof(uint32_t)*k*k);
+
+  /* Another thread may have inserted the same pattern while we weren't looking. */
+
+  pthread_mutex_lock(&c->lock);
+  e2 = gf_decode_find(c, ids, hash);
+  if (e2 != NULL) {
+    pthread_mutex_unlock(&c->lock);
+    free(e->ids);
+    free(e->inv);
+    free(e);
+    return 1;
+  }
+  if (c->size == c->capacity) gf_decode_evict(c);
+  e->hnext = c->buckets[hash & (c->nbuckets-1)];
+  c->buckets[hash & (c->nbuckets-1)] = e;
+  gf_decode_push_front(c, e);
+  c->size++;
+  pthread_mutex_unlock(&c->lock);
+  return 1;
+}
+
+int gf_decode_cache_range(gf_decode_cache_t *c, int *survivors, void **frags,
+                          int nwant, int *want, void **out, int offset, int len)
+{
+  gf_internal_t *h;
+  uint32_t *inv, *rows, e;
+  void **src;
+  int *ids, i, j, l, t, k, rv;
+
+  h = (gf_internal_t *) c->gf->scratch;
+  k = c->k;
+  if (h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY)) return 0;
+  if (nwant <= 0 || offset < 0 || len < 0) return 0;
+  for (i = 0; i < nwant; i++) {
+    if (want[i] < 0 || want[i] >= k + c->m) return 0;
+  }
+
+  inv = (uint32_t *) malloc(sizeof(uint32_t) * k * (k + nwant));
+  ids = (int *) malloc(sizeof(int) * k);
+  src = (void **) malloc(sizeof(void *) * k);
+  if (inv == NULL || ids == NULL || src == NULL) {
+    free(inv); free(ids); free(src);
+    return 0;
+  }
+  rows = inv + k*k;
+
+  rv = gf_decode_cache_lookup(c, survivors, inv);
+  if (rv) {
+
+    /* The columns of inv go with the survivors in sorted order.  The lookup
+       has checked that they are distinct. */
+
+    for (i = 0; i < k; i++) {
+      t = survivors[i];
+      for (j = i; j > 0 && ids[j-1] > t; j--) ids[j] = ids[j-1];
+      ids[j] = t;
+    }
+    for (i = 0; i < k; i++) src[i] = (uint8_t *) frags[ids[i]] + offset;
+
+    for (i = 0; i < nwant; i++) {
+      if (want[i] < k) {
+        memcpy(rows + i*k, inv + want[i]*k, sizeof(uint32_t) * k);
+        continue;
+      }
+      memset(rows + i*k, 0, sizeof(uint32_t) * k);
+      for (l = 0; l < k; l++) {
+        e = c->coding[(want[i]-k)*k + l];
+        if (e == 0) continue;
+        for (j = 0; j < k; j++) rows[i*k+j] ^= c->gf->multiply.w32(c->gf, e, inv[l*k+j]);
+      }
+    }
+    gf_matrix_region_multiply(c->gf, rows, nwant, k, src, out, len, 0);
+  }
+
+  free(inv);
+  free(ids);
+  free(src);
+  return rv;
+}
+
+/* The chunk size for gf_matrix_region_multiply().  With a dozen or so
+   sources, this keeps the working set in L1/L2. */
+
+#define GF_MATRIX_CHUNK (4096)
+
+void gf_matrix_region_multiply(gf_t *gf, uint32_t *matrix, int rows, int cols,
+                               void **src, void **dest, int bytes, int xor)
+{
+  gf_internal_t *h;
+  int i, j, off, len, chunk, written;
+  uint32_t e;
+  uint8_t *s8, *d8;
+
+  h = (gf_internal_t *) gf->scratch;
+
+  /* With ALTMAP and CAUCHY, the layout of a region depends on where it starts
+     and how big it is, so the regions can't be cut into chunks. */
+
+  chunk = (h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY) || h->w > 32 ||
+           (h->w != 4 && h->w != 8 && h->w != 16 && h->w != 32)) ? bytes : GF_MATRIX_CHUNK;
+  if (chunk <= 0) return;
+
+  for (off = 0; off < bytes; off += chunk) {
+    len = (bytes - off < chunk) ? bytes - off : chunk;
+    for (i = 0; i < rows; i++) {
+      d8 = (uint8_t *) dest[i] + off;
+      written = xor;
+      for (j = 0; j < cols; j++) {
+        e = matrix[i*cols+j];
+        if (e == 0) continue;
+        s8 = (uint8_t *) src[j] + off;
+        gf->multiply_region.w32(gf, s8, d8, e, len, written);
+        written = 1;
+      }
+      if (!written) gf_multby_zero(d8, len, 0);
+    }
+  }
+}
+
+/* Returns whether every piece of a strided src/dest pair is a legal region:
+   the pieces start at src + i*src_stride and dest + i*dest_stride, so they
+   are all aligned with respect to each other exactly when the bases and the
+   strides are.  These are the rules that gf_set_region_data() enforces. */
+
+static int gf_strided_pair_ok(gf_internal_t *h, void *src, int src_stride,
+                              void *dest, int dest_stride, int chunk)
+{
+  uintptr_t s, d;
+  int wb;
+
+  if (h->region_type & GF_REGION_CAUCHY) return (chunk % h->w == 0);
+  s = (uintptr_t) src;
+  d = (uintptr_t) dest;
+  if (s % 16 != d % 16 || (unsigned) src_stride % 16 != (unsigned) dest_stride % 16) return 0;
+  wb = (h->w < 8) ? 1 : h->w / 8;
+  return (s % wb == 0 && src_stride % wb == 0 && chunk % wb == 0);
+}
+
+int gf_region_multiply_strided(gf_t *gf, void *src, int src_stride, void *dest, int dest_stride,
+                               gf_val_32_t val, int chunk, int nchunks, int xor)
+{
+  gf_internal_t *h;
+  int i;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (h->w > 32 || chunk <= 0 || nchunks < 0 || src_stride < 0 || dest_stride < 0) return 0;
+  if (!gf_strided_pair_ok(h, src, src_stride, dest, dest_stride, chunk)) return 0;
+
+  for (i = 0; i < nchunks; i++) {
+    gf->multiply_region.w32(gf, (uint8_t *) src + (size_t) i * src_stride,
+                            (uint8_t *) dest + (size_t) i * dest_stride, val, chunk, xor);
+  }
+  return 1;
+}
+
+int gf_matrix_region_multiply_strided(gf_t *gf, uint32_t *matrix, int rows, int cols,
+                                      void **src, int src_stride, void **dest, int dest_stride,
+                                      int chunk, int nchunks, int xor)
+{
+  gf_internal_t *h;
+  void **sp, **dp;
+  int i, j;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (h->w > 32 || rows <= 0 || cols <= 0) return 0;
+  if (chunk <= 0 || nchunks < 0 || src_stride < 0 || dest_stride < 0) return 0;
+  for (i = 0; i < rows; i++) {
+    for (j = 0; j < cols; j++) {
+      if (!gf_strided_pair_ok(h, src[j], src_stride, dest[i], dest_stride, chunk)) return 0;
+    }
+  }
+
+  sp = (void **) malloc(sizeof(void *) * (rows + cols));
+  if (sp == NULL) return 0;
+  dp = sp + cols;
+
+  /* One piece of every fragment at a time:  with interleaved fragments, the
+     pieces of a stripe sit next to each other, so each stripe is streamed
+     through once. */
+
+  for (i = 0; i < nchunks; i++) {
+    for (j = 0; j < cols; j++) sp[j] = (uint8_t *) src[j] + (size_t) i * src_stride;
+    for (j = 0; j < rows; j++) dp[j] = (uint8_t *) dest[j] + (size_t) i * dest_stride;
+    gf_matrix_region_multiply(gf, matrix, rows, cols, sp, dp, chunk, xor);
+  }
+  free(sp);
+  return 1;
+}
@@ -139,6 +139,9 @@ int create_gf_from_argv(gf_t *gf, int w, int argc, char **argv, int starting)
         } else if (strcmp(argv[starting], "ALTMAP") == 0) {
           region_type |= GF_REGION_ALTMAP;
           starting++;
+        } else if (strcmp(argv[starting], "ONLY") == 0) {
+          region_type |= GF_REGION_ONLY;
+          starting++;
         } else {
           if (base != NULL) gf_free(base, 1);
           _gf_errno = GF_E_UNK_REG;
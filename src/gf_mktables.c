@@ -0,0 +1,224 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_mktables.c
+ *
+ * Writes the C source of the tables for the default polynomials, which are
+ * compiled into the library as constant data, so that gf_init_hard() can
+ * point at them instead of building them:
+ *
+ *   gf_mktables 8   -- the w=8 TABLE / DEFAULT tables          (0x11d)
+ *   gf_mktables 16  -- the w=16 log tables and SPLIT 8,8 tables (0x1100b)
+ *   gf_mktables 32  -- the w=32 GROUP reduction table, g_r = 8 (0x400007)
+ *
+ * It is run at build time, so it doesn't use the library.  The tables are
+ * the same ones that the init routines build for other polynomials.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+static void usage()
+{
+  fprintf(stderr, "usage: gf_mktables 8|16|32 - writes the default tables as C source\n");
+  exit(1);
+}
+
+/* Prints n values, sixteen to a line, as the body of an array initializer. */
+
+static void print_values(uint32_t *v, int n, char *indent)
+{
+  int i;
+
+  for (i = 0; i < n; i++) {
+    if (i % 16 == 0) printf("%s", indent);
+    printf("%u%s", v[i], (i == n-1) ? "\n" : ((i % 16 == 15) ? ",\n" : ","));
+  }
+}
+
+/* Prints a rows x cols array as the body of an initializer, one brace-enclosed
+   row after another. */
+
+static void print_rows(uint32_t *v, int rows, int cols, char *indent, char *row_indent)
+{
+  int i;
+
+  for (i = 0; i < rows; i++) {
+    printf("%s{\n", indent);
+    print_values(v + i * cols, cols, row_indent);
+    printf("%s}%s\n", indent, (i == rows-1) ? "" : ",");
+  }
+}
+
+static void header(char *h)
+{
+  printf("/* Generated by gf_mktables -- do not edit. */\n\n");
+  printf("#include \"gf_int.h\"\n");
+  printf("#include \"%s\"\n\n", h);
+}
+
+static uint32_t w8_multiply(uint32_t a, uint32_t b)
+{
+  uint32_t product, i;
+
+  product = 0;
+  for (i = 0; i < 8; i++) {
+    if (a & (1 << i)) product ^= (b << i);
+  }
+  for (i = 15; i >= 8; i--) {
+    if (product & (1 << i)) product ^= (0x11d << (i-8));
+  }
+  return product;
+}
+
+/* struct gf_w8_default_data: high, low, multtable, divtable. */
+
+static void w8_tables()
+{
+  uint32_t *high, *low, *div, *mult;
+  int a, b, prod;
+
+  high = (uint32_t *) calloc(256 * 16, sizeof(uint32_t));
+  low = (uint32_t *) calloc(256 * 16, sizeof(uint32_t));
+  div = (uint32_t *) calloc(256 * 256, sizeof(uint32_t));
+  mult = (uint32_t *) calloc(256 * 256, sizeof(uint32_t));
+  if (high == NULL || low == NULL || div == NULL || mult == NULL) exit(1);
+
+  for (a = 1; a < 256; a++) {
+    for (b = 1; b < 256; b++) {
+      prod = w8_multiply(a, b);
+      mult[a*256+b] = prod;
+      div[prod*256+b] = a;
+      if ((b & 0xf) == b) low[a*16+b] = prod;
+      if ((b & 0xf0) == b) high[a*16+(b>>4)] = prod;
+    }
+  }
+
+  header("gf_w8.h");
+  printf("const struct gf_w8_default_data gf_w8_default_tables = {\n");
+  printf("  {\n"); print_rows(high, 256, 16, "    ", "      "); printf("  },\n");
+  printf("  {\n"); print_rows(low, 256, 16, "    ", "      "); printf("  },\n");
+  printf("  {\n"); print_rows(mult, 256, 256, "    ", "      "); printf("  },\n");
+  printf("  {\n"); print_rows(div, 256, 256, "    ", "      "); printf("  }\n");
+  printf("};\n");
+}
+
+#define W16_POLY (0x1100b)
+#define W16_MULTBY_TWO(p) (((p) & (1 << 15)) ? (((p) << 1) ^ W16_POLY) : (p) << 1)
+
+/* struct gf_w16_logtable_data and struct gf_w16_split_8_8_data. */
+
+static void w16_tables()
+{
+  uint32_t *log_tbl, *antilog_tbl, *inv_tbl, *tables;
+  uint32_t p, basep, tmp;
+  int i, j, b, exp;
+
+  log_tbl = (uint32_t *) calloc(65536, sizeof(uint32_t));
+  antilog_tbl = (uint32_t *) calloc(65536 * 2, sizeof(uint32_t));
+  inv_tbl = (uint32_t *) calloc(65536, sizeof(uint32_t));
+  tables = (uint32_t *) calloc(3 * 256 * 256, sizeof(uint32_t));
+  if (log_tbl == NULL || antilog_tbl == NULL || inv_tbl == NULL || tables == NULL) exit(1);
+
+  b = 1;
+  for (i = 0; i < 65535; i++) {
+    log_tbl[b] = i;
+    antilog_tbl[i] = b;
+    antilog_tbl[i+65535] = b;
+    b <<= 1;
+    if (b & 65536) b = b ^ W16_POLY;
+  }
+  inv_tbl[0] = 0;
+  inv_tbl[1] = 1;
+  for (i = 2; i < 65536; i++) inv_tbl[i] = antilog_tbl[65535-log_tbl[i]];
+
+  /* tables[exp][i][j] = i * j * x^(8*exp) */
+
+  basep = 1;
+  for (exp = 0; exp < 3; exp++) {
+    uint32_t *t = tables + exp * 65536;
+
+    t[1*256+1] = basep;
+    for (i = 2; i < 256; i++) {
+      if (i&1) {
+        t[i*256+1] = t[(i^1)*256+1] ^ basep;
+      } else {
+        p = t[(i>>1)*256+1];
+        t[i*256+1] = W16_MULTBY_TWO(p) & 0xffff;
+      }
+    }
+    for (i = 1; i < 256; i++) {
+      p = t[i*256+1];
+      for (j = 1; j < 256; j++) {
+        if (j&1) {
+          t[i*256+j] = t[i*256+(j^1)] ^ p;
+        } else {
+          tmp = t[i*256+(j>>1)];
+          t[i*256+j] = W16_MULTBY_TWO(tmp) & 0xffff;
+        }
+      }
+    }
+    for (i = 0; i < 8; i++) basep = W16_MULTBY_TWO(basep);
+  }
+
+  header("gf_w16.h");
+  printf("const struct gf_w16_logtable_data gf_w16_default_log_tables = {\n");
+  printf("  {\n"); print_values(log_tbl, 65536, "    "); printf("  },\n");
+  printf("  {\n"); print_values(antilog_tbl, 65536 * 2, "    "); printf("  },\n");
+  printf("  (uint16_t *) gf_w16_default_log_tables.antilog_tbl + 65535,\n");
+  printf("  {\n"); print_values(inv_tbl, 65536, "    "); printf("  }\n");
+  printf("};\n\n");
+  printf("const struct gf_w16_split_8_8_data gf_w16_default_split_8_8_tables = {\n");
+  printf("  {\n");
+  for (exp = 0; exp < 3; exp++) {
+    printf("    {\n");
+    print_rows(tables + exp * 65536, 256, 256, "      ", "        ");
+    printf("    }%s\n", (exp == 2) ? "" : ",");
+  }
+  printf("  }\n");
+  printf("};\n");
+}
+
+/* The GROUP reduction table for g_r = 8, as in gf_w32_group_init(). */
+
+static void w32_tables()
+{
+  uint32_t reduce[256], i, j, p, index;
+  uint64_t pp;
+
+  pp = 0x400007;
+  for (i = 0; i < 256; i++) {
+    p = 0;
+    index = 0;
+    for (j = 0; j < 8; j++) {
+      if (i & (1 << j)) {
+        p ^= (pp << j);
+        index ^= (1 << j);
+        index ^= (pp >> (32-j));
+      }
+    }
+    reduce[index] = p;
+  }
+
+  header("gf_w32.h");
+  printf("const uint32_t gf_w32_default_group_reduce[256] = {\n");
+  print_values(reduce, 256, "  ");
+  printf("};\n");
+}
+
+int main(int argc, char **argv)
+{
+  int w;
+
+  if (argc != 2 || sscanf(argv[1], "%d", &w) != 1) usage();
+  switch (w) {
+    case 8: w8_tables(); break;
+    case 16: w16_tables(); break;
+    case 32: w32_tables(); break;
+    default: usage();
+  }
+  return 0;
+}
@@ -0,0 +1,507 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_parallel.c
+ *
+ * Library-owned thread pool and parallel region multiply.  See gf_parallel.h.
+ */
+
+#include "config.h"
+
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <sched.h>
+#endif
+
+#include "gf_int.h"
+#include "gf_parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define GF_PARALLEL_THRESHOLD (1 << 20)
+
+/* Chunks are multiples of a cache line, and there are about this many per
+   thread, so that a thread that falls behind holds up the others by less. */
+
+#define GF_PARALLEL_ALIGN (64)
+#define GF_PARALLEL_CHUNKS_PER_THREAD (4)
+
+/* The pool runs one job at a time.  A job is a function that every thread
+   calls, with its id:  0 for the caller and 1 to nthreads-1 for the workers.
+   The workers wait for the generation to change, and the caller waits for
+   running to drop to zero, so a job's threads are all done with it before the
+   next one starts. */
+
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t work;
+  pthread_cond_t done;
+  int nthreads;
+  int threshold;
+  pthread_t *tids;
+  uint64_t generation;
+  void (*fn)(void *arg, int id);
+  void *arg;
+  int running;
+  int busy;
+  int quit;
+} gf_parallel_pool_t;
+
+static gf_parallel_pool_t gf_pool = { .lock = PTHREAD_MUTEX_INITIALIZER,
+                                      .work = PTHREAD_COND_INITIALIZER,
+                                      .done = PTHREAD_COND_INITIALIZER,
+                                      .nthreads = 1,
+                                      .threshold = GF_PARALLEL_THRESHOLD };
+
+typedef struct {
+  int id;
+  uint64_t generation;
+} gf_parallel_worker_t;
+
+static void *gf_parallel_worker(void *arg)
+{
+  gf_parallel_worker_t *wk;
+  void (*fn)(void *, int);
+  void *fn_arg;
+  uint64_t seen;
+  int id;
+
+  wk = (gf_parallel_worker_t *) arg;
+  id = wk->id;
+  seen = wk->generation;
+  free(wk);
+
+  pthread_mutex_lock(&gf_pool.lock);
+  while (1) {
+    while (!gf_pool.quit && gf_pool.generation == seen) pthread_cond_wait(&gf_pool.work, &gf_pool.lock);
+    if (gf_pool.quit) break;
+    seen = gf_pool.generation;
+    fn = gf_pool.fn;
+    fn_arg = gf_pool.arg;
+    pthread_mutex_unlock(&gf_pool.lock);
+    fn(fn_arg, id);
+    pthread_mutex_lock(&gf_pool.lock);
+    if (--gf_pool.running == 0) pthread_cond_broadcast(&gf_pool.done);
+  }
+  pthread_mutex_unlock(&gf_pool.lock);
+  return NULL;
+}
+
+/* Pins worker id to the id-th of the CPUs the process may run on, wrapping
+   around.  The caller's thread is left where it is. */
+
+static void gf_parallel_pin(pthread_t tid, int id)
+{
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+  cpu_set_t allowed, one;
+  int c, n;
+
+  if (pthread_getaffinity_np(pthread_self(), sizeof(allowed), &allowed) != 0) return;
+  n = CPU_COUNT(&allowed);
+  if (n <= 1) return;
+  id %= n;
+  for (c = 0; c < CPU_SETSIZE; c++) {
+    if (CPU_ISSET(c, &allowed) && id-- == 0) {
+      CPU_ZERO(&one);
+      CPU_SET(c, &one);
+      pthread_setaffinity_np(tid, sizeof(one), &one);
+      return;
+    }
+  }
+#endif
+}
+
+/* Stops the workers.  Called with the lock held and busy set, so that no
+   job starts while the lock is dropped for the joins. */
+
+static void gf_parallel_stop(void)
+{
+  pthread_t *tids;
+  int i, n;
+
+  gf_pool.quit = 1;
+  pthread_cond_broadcast(&gf_pool.work);
+  tids = gf_pool.tids;
+  n = gf_pool.nthreads;
+  pthread_mutex_unlock(&gf_pool.lock);
+  for (i = 1; i < n; i++) pthread_join(tids[i], NULL);
+  pthread_mutex_lock(&gf_pool.lock);
+  free(tids);
+  gf_pool.tids = NULL;
+  gf_pool.nthreads = 1;
+  gf_pool.quit = 0;
+}
+
+int gf_parallel_init(int nthreads, int threshold)
+{
+  gf_parallel_worker_t *wk;
+  pthread_t *tids;
+  int i;
+
+  if (nthreads <= 0) nthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if (nthreads <= 0) nthreads = 1;
+
+  pthread_mutex_lock(&gf_pool.lock);
+
+  /* busy stops other jobs while the pool is replaced. */
+
+  while (gf_pool.busy) pthread_cond_wait(&gf_pool.done, &gf_pool.lock);
+  gf_pool.busy = 1;
+  if (gf_pool.nthreads > 1) gf_parallel_stop();
+  gf_pool.threshold = (threshold > 0) ? threshold : GF_PARALLEL_THRESHOLD;
+
+  tids = (pthread_t *) malloc(sizeof(pthread_t) * nthreads);
+  if (tids == NULL) {
+    gf_pool.busy = 0;
+    pthread_cond_broadcast(&gf_pool.done);
+    pthread_mutex_unlock(&gf_pool.lock);
+    return 0;
+  }
+  gf_pool.tids = tids;
+  for (i = 1; i < nthreads; i++) {
+    wk = (gf_parallel_worker_t *) malloc(sizeof(gf_parallel_worker_t));
+    if (wk == NULL) break;
+    wk->id = i;
+    wk->generation = gf_pool.generation;
+    if (pthread_create(tids + i, NULL, gf_parallel_worker, wk) != 0) {
+      free(wk);
+      break;
+    }
+    gf_parallel_pin(tids[i], i);
+  }
+  gf_pool.nthreads = i;
+  gf_pool.busy = 0;
+  pthread_cond_broadcast(&gf_pool.done);
+  pthread_mutex_unlock(&gf_pool.lock);
+  return 1;
+}
+
+void gf_parallel_free(void)
+{
+  pthread_mutex_lock(&gf_pool.lock);
+  while (gf_pool.busy) pthread_cond_wait(&gf_pool.done, &gf_pool.lock);
+  gf_pool.busy = 1;
+  if (gf_pool.nthreads > 1) gf_parallel_stop();
+  gf_pool.threshold = GF_PARALLEL_THRESHOLD;
+  gf_pool.busy = 0;
+  pthread_cond_broadcast(&gf_pool.done);
+  pthread_mutex_unlock(&gf_pool.lock);
+}
+
+/* Runs fn on every thread of the pool and returns the number of threads, or
+   returns 0 without running it if there are no workers or the pool is busy,
+   which is also the case when fn itself calls back in. */
+
+static int gf_parallel_run(void (*fn)(void *, int), void *arg)
+{
+  int n;
+
+  pthread_mutex_lock(&gf_pool.lock);
+  n = gf_pool.nthreads;
+  if (n <= 1 || gf_pool.busy) {
+    pthread_mutex_unlock(&gf_pool.lock);
+    return 0;
+  }
+  gf_pool.busy = 1;
+  gf_pool.fn = fn;
+  gf_pool.arg = arg;
+  gf_pool.running = n - 1;
+  gf_pool.generation++;
+  pthread_cond_broadcast(&gf_pool.work);
+  pthread_mutex_unlock(&gf_pool.lock);
+
+  fn(arg, 0);
+
+  pthread_mutex_lock(&gf_pool.lock);
+  while (gf_pool.running > 0) pthread_cond_wait(&gf_pool.done, &gf_pool.lock);
+  gf_pool.busy = 0;
+  pthread_cond_broadcast(&gf_pool.done);
+  pthread_mutex_unlock(&gf_pool.lock);
+  return n;
+}
+
+typedef struct {
+  gf_t *gf;
+  uint8_t *src;
+  uint8_t *dest;
+  gf_general_t *val;
+  int xor;
+  int bytes;
+  int head;           /* Bytes before the first 64-byte boundary of src */
+  int chunk;
+  int nchunks;
+  int next;           /* The next chunk to take */
+  pthread_mutex_t lock;
+} gf_parallel_region_t;
+
+static void gf_parallel_region_thread(void *arg, int id)
+{
+  gf_parallel_region_t *r;
+  int c, start, end;
+
+  (void) id;
+  r = (gf_parallel_region_t *) arg;
+  while (1) {
+    pthread_mutex_lock(&r->lock);
+    c = r->next++;
+    pthread_mutex_unlock(&r->lock);
+    if (c >= r->nchunks) return;
+
+    /* Chunk 0 also takes the unaligned head, and the last one the rest. */
+
+    start = (c == 0) ? 0 : r->head + c * r->chunk;
+    end = (c == r->nchunks-1) ? r->bytes : r->head + (c+1) * r->chunk;
+    gf_general_do_region_multiply(r->gf, r->val, r->src + start, r->dest + start,
+                                  end - start, r->xor);
+  }
+}
+
+void gf_parallel_multiply_region(gf_t *gf, void *src, void *dest, gf_general_t *val,
+                                 int bytes, int xor)
+{
+  gf_parallel_region_t r;
+  gf_internal_t *h;
+  int w, n, threshold;
+
+  h = (gf_internal_t *) gf->scratch;
+  w = h->w;
+
+  /* If the pool changes after this, gf_parallel_run() sees it. */
+
+  pthread_mutex_lock(&gf_pool.lock);
+  n = gf_pool.nthreads;
+  threshold = gf_pool.threshold;
+  pthread_mutex_unlock(&gf_pool.lock);
+
+  if (n <= 1 || bytes < threshold || bytes < 2 * GF_PARALLEL_ALIGN ||
+      (h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY)) ||
+      (w != 4 && w != 8 && w != 16 && w != 32 && w != 64 && w != 128)) {
+    gf_general_do_region_multiply(gf, val, src, dest, bytes, xor);
+    return;
+  }
+
+  r.gf = gf;
+  r.src = (uint8_t *) src;
+  r.dest = (uint8_t *) dest;
+  r.val = val;
+  r.xor = xor;
+  r.bytes = bytes;
+  r.head = (GF_PARALLEL_ALIGN - ((uintptr_t) src % GF_PARALLEL_ALIGN)) % GF_PARALLEL_ALIGN;
+  r.chunk = (bytes - r.head) / (n * GF_PARALLEL_CHUNKS_PER_THREAD);
+  r.chunk = (r.chunk + GF_PARALLEL_ALIGN - 1) / GF_PARALLEL_ALIGN * GF_PARALLEL_ALIGN;
+  if (r.chunk == 0) r.chunk = GF_PARALLEL_ALIGN;
+  r.nchunks = (bytes - r.head) / r.chunk;
+  if (r.nchunks == 0) r.nchunks = 1;
+  r.next = 0;
+  pthread_mutex_init(&r.lock, NULL);
+
+  if (gf_parallel_run(gf_parallel_region_thread, &r) == 0) {
+    gf_general_do_region_multiply(gf, val, src, dest, bytes, xor);
+  }
+  pthread_mutex_destroy(&r.lock);
+}
+
+/* Stripe batches.  A task is one block of one stripe.  Thread t's deque is
+   the run of tasks [top, bottom) of the task array, which it takes from the
+   top, while thieves take from the bottom, as far from where the owner is
+   working as they can get.  No tasks are added once the batch starts, so a
+   thread that finds every deque empty is done. */
+
+#define GF_PARALLEL_BLOCK (64 * 1024)
+
+typedef struct {
+  int stripe;
+  int offset;
+  int len;
+} gf_parallel_task_t;
+
+typedef struct {
+  pthread_mutex_t lock;
+  int top;
+  int bottom;
+} __attribute__((aligned(64))) gf_parallel_deque_t;   /* One per cache line */
+
+typedef struct {
+  gf_t *gf;
+  gf_decode_cache_t *cache;   /* NULL when encoding */
+  int k;
+  int m;
+  uint32_t *matrix;
+  gf_parallel_stripe_t *stripes;
+  gf_parallel_task_t *tasks;
+  gf_parallel_deque_t *deques;
+  int nthreads;
+  void **ptrs;        /* nptrs region pointers per thread */
+  int nptrs;
+  int failed;
+  pthread_mutex_t lock;
+} gf_parallel_batch_t;
+
+/* Returns the index of the next task for thread id, or -1 if there are none
+   left anywhere. */
+
+static int gf_parallel_batch_take(gf_parallel_batch_t *b, int id)
+{
+  gf_parallel_deque_t *d;
+  int i, t;
+
+  for (i = 0; i < b->nthreads; i++) {
+    d = b->deques + (id + i) % b->nthreads;
+    t = -1;
+    pthread_mutex_lock(&d->lock);
+    if (d->top < d->bottom) t = (i == 0) ? d->top++ : --d->bottom;
+    pthread_mutex_unlock(&d->lock);
+    if (t >= 0) return t;
+  }
+  return -1;
+}
+
+static void gf_parallel_batch_thread(void *arg, int id)
+{
+  gf_parallel_batch_t *b;
+  gf_parallel_stripe_t *s;
+  gf_parallel_task_t *t;
+  void **ptrs;
+  int i, j, ok;
+
+  b = (gf_parallel_batch_t *) arg;
+
+  /* The batch was sized for the pool as it was before gf_parallel_run().
+     If gf_parallel_init() has grown it since, the new workers sit this one
+     out. */
+
+  if (id >= b->nthreads) return;
+  ptrs = b->ptrs + id * b->nptrs;
+  while ((i = gf_parallel_batch_take(b, id)) >= 0) {
+    t = b->tasks + i;
+    s = b->stripes + t->stripe;
+    if (b->cache == NULL) {
+      for (j = 0; j < b->k; j++) ptrs[j] = (uint8_t *) s->src[j] + t->offset;
+      for (j = 0; j < b->m; j++) ptrs[b->k+j] = (uint8_t *) s->dest[j] + t->offset;
+      gf_matrix_region_multiply(b->gf, b->matrix, b->m, b->k, ptrs, ptrs + b->k, t->len, 0);
+    } else {
+      for (j = 0; j < s->nwant; j++) ptrs[j] = (uint8_t *) s->dest[j] + t->offset;
+      ok = gf_decode_cache_range(b->cache, s->survivors, s->src, s->nwant, s->want,
+                                 ptrs, t->offset, t->len);
+      if (!ok) {
+        pthread_mutex_lock(&b->lock);
+        b->failed = 1;
+        pthread_mutex_unlock(&b->lock);
+      }
+    }
+  }
+}
+
+/* Cuts the stripes into tasks, deals them out and runs the batch on the
+   pool, or on the calling thread if the pool has no workers or is busy. */
+
+static int gf_parallel_batch(gf_parallel_batch_t *b, int nstripes)
+{
+  gf_internal_t *h;
+  int i, ntasks, per, off, len, whole, n;
+
+  h = (gf_internal_t *) b->gf->scratch;
+  whole = (h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY)) ||
+          (h->w != 4 && h->w != 8 && h->w != 16 && h->w != 32);
+
+  ntasks = 0;
+  for (i = 0; i < nstripes; i++) {
+    if (b->stripes[i].bytes < 0) return 0;
+    ntasks += whole ? (b->stripes[i].bytes > 0) :
+              (b->stripes[i].bytes + GF_PARALLEL_BLOCK - 1) / GF_PARALLEL_BLOCK;
+  }
+
+  pthread_mutex_lock(&gf_pool.lock);
+  n = gf_pool.nthreads;
+  pthread_mutex_unlock(&gf_pool.lock);
+
+  b->nthreads = n;
+  b->failed = 0;
+  b->tasks = (gf_parallel_task_t *) malloc(sizeof(gf_parallel_task_t) * (ntasks + 1));
+  if (posix_memalign((void **) &b->deques, 64, sizeof(gf_parallel_deque_t) * n) != 0) {
+    b->deques = NULL;
+  }
+  b->ptrs = (void **) malloc(sizeof(void *) * b->nptrs * n);
+  if (b->tasks == NULL || b->deques == NULL || b->ptrs == NULL) {
+    free(b->tasks);
+    free(b->deques);
+    free(b->ptrs);
+    return 0;
+  }
+
+  ntasks = 0;
+  for (i = 0; i < nstripes; i++) {
+    for (off = 0; off < b->stripes[i].bytes; off += len) {
+      len = b->stripes[i].bytes - off;
+      if (!whole && len > GF_PARALLEL_BLOCK) len = GF_PARALLEL_BLOCK;
+      b->tasks[ntasks].stripe = i;
+      b->tasks[ntasks].offset = off;
+      b->tasks[ntasks].len = len;
+      ntasks++;
+    }
+  }
+
+  per = ntasks / n;
+  for (i = 0; i < n; i++) {
+    pthread_mutex_init(&b->deques[i].lock, NULL);
+    b->deques[i].top = i * per;
+    b->deques[i].bottom = (i == n-1) ? ntasks : (i+1) * per;
+  }
+  pthread_mutex_init(&b->lock, NULL);
+
+  if (gf_parallel_run(gf_parallel_batch_thread, b) == 0) gf_parallel_batch_thread(b, 0);
+
+  for (i = 0; i < n; i++) pthread_mutex_destroy(&b->deques[i].lock);
+  pthread_mutex_destroy(&b->lock);
+  free(b->tasks);
+  free(b->deques);
+  free(b->ptrs);
+  return !b->failed;
+}
+
+int gf_parallel_encode_stripes(gf_t *gf, int k, int m, uint32_t *coding_matrix,
+                               gf_parallel_stripe_t *stripes, int nstripes)
+{
+  gf_parallel_batch_t b;
+  gf_internal_t *h;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (h->w > 32 || k <= 0 || m <= 0 || nstripes < 0) return 0;
+
+  b.gf = gf;
+  b.cache = NULL;
+  b.k = k;
+  b.m = m;
+  b.matrix = coding_matrix;
+  b.stripes = stripes;
+  b.nptrs = k + m;
+  return gf_parallel_batch(&b, nstripes);
+}
+
+int gf_parallel_decode_stripes(gf_t *gf, gf_decode_cache_t *cache,
+                               gf_parallel_stripe_t *stripes, int nstripes)
+{
+  gf_parallel_batch_t b;
+  int i;
+
+  if (nstripes < 0) return 0;
+
+  b.gf = gf;
+  b.cache = cache;
+  b.k = 0;
+  b.m = 0;
+  b.matrix = NULL;
+  b.stripes = stripes;
+  b.nptrs = 1;
+  for (i = 0; i < nstripes; i++) {
+    if (stripes[i].nwant <= 0) return 0;
+    if (stripes[i].nwant > b.nptrs) b.nptrs = stripes[i].nwant;
+  }
+  return gf_parallel_batch(&b, nstripes);
+}
@@ -0,0 +1,635 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_poly.c
+ *
+ * Polynomials over GF(2^w).  See gf_poly.h.
+ */
+
+#include "gf_int.h"
+#include "gf_poly.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Products whose shorter operand has fewer than GF_POLY_KARATSUBA
+   coefficients are schoolbook.  Divisions whose divisor and quotient both
+   have at least GF_POLY_NEWTON coefficients use Newton iteration.  Schoolbook
+   loops use multiply_region when the rows have at least GF_POLY_REGION
+   coefficients.  Subproduct tree nodes with at most GF_POLY_LEAF points are
+   evaluated with Horner's rule. */
+
+#define GF_POLY_KARATSUBA (32)
+#define GF_POLY_NEWTON (256)
+#define GF_POLY_REGION (128)
+#define GF_POLY_LEAF (32)
+
+/* Adding polynomials is XOR'ing their coefficient arrays. */
+
+#define GF_POLY_XOR(src, dest, n) gf_multby_one((src), (dest), sizeof(uint32_t) * (n), 1)
+
+/* ---------------------------------------------------------------------- */
+/* Region layout */
+
+/* Returns the word size in bytes if the schoolbook loops can use
+   multiply_region, and 0 if they can't. */
+
+static int gf_poly_region_bytes(gf_t *gf)
+{
+  gf_internal_t *h;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY)) return 0;
+  if (h->w == 8 || h->w == 16 || h->w == 32) return h->w / 8;
+  return 0;
+}
+
+static void gf_poly_pack(uint32_t *p, int n, uint8_t *r, int wb)
+{
+  int i;
+
+  switch (wb) {
+    case 1: for (i = 0; i < n; i++) r[i] = p[i]; break;
+    case 2: for (i = 0; i < n; i++) ((uint16_t *) r)[i] = p[i]; break;
+    default: memcpy(r, p, sizeof(uint32_t) * n); break;
+  }
+}
+
+static void gf_poly_unpack(uint8_t *r, int n, uint32_t *p, int wb)
+{
+  int i;
+
+  switch (wb) {
+    case 1: for (i = 0; i < n; i++) p[i] = r[i]; break;
+    case 2: for (i = 0; i < n; i++) p[i] = ((uint16_t *) r)[i]; break;
+    default: memcpy(p, r, sizeof(uint32_t) * n); break;
+  }
+}
+
+static uint32_t gf_poly_word(uint8_t *r, int i, int wb)
+{
+  switch (wb) {
+    case 1: return r[i];
+    case 2: return ((uint16_t *) r)[i];
+    default: return ((uint32_t *) r)[i];
+  }
+}
+
+/* The schoolbook loops add multiples of one polynomial (p) into another (r)
+   at every coefficient offset.  multiply_region needs the source and the
+   destination to have the same alignment mod 16, so p is packed 16/wb times:
+   copy s starts s words past a 16-byte boundary, and is the source whenever
+   the destination offset is s mod 16/wb.  r is packed once, aligned.  Returns
+   the memory to free, or NULL if it runs out. */
+
+static void *gf_poly_region_setup(uint32_t *p, int np, int nr, int wb, uint8_t **copy, uint8_t **r)
+{
+  int s, stride;
+  uint8_t *base;
+  void *mem;
+
+  stride = (np * wb + 31) & ~15;
+  mem = malloc((size_t) stride * (16 / wb) + nr * wb + 16);
+  if (mem == NULL) return NULL;
+  base = (uint8_t *) (((uintptr_t) mem + 15) & ~((uintptr_t) 15));
+  for (s = 0; s < 16 / wb; s++) {
+    copy[s] = base + s * stride + s * wb;
+    gf_poly_pack(p, np, copy[s], wb);
+  }
+  *r = base + (size_t) stride * (16 / wb);
+  return mem;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Multiplication */
+
+/* c = a * b, where c has na + nb - 1 entries, with one multiply_region per
+   coefficient of b, or with single multiplications. */
+
+static void gf_poly_school(gf_t *gf, uint32_t *a, int na, uint32_t *b, int nb, uint32_t *c)
+{
+  uint8_t *copy[16], *r;
+  void *mem;
+  int i, j, wb, n;
+
+  n = na + nb - 1;
+  wb = gf_poly_region_bytes(gf);
+  if (wb != 0 && na >= GF_POLY_REGION) {
+    mem = gf_poly_region_setup(a, na, n, wb, copy, &r);
+    if (mem != NULL) {
+      memset(r, 0, n * wb);
+      for (i = 0; i < nb; i++) {
+        if (b[i] != 0) gf->multiply_region.w32(gf, copy[i % (16 / wb)], r + i * wb, b[i], na * wb, 1);
+      }
+      gf_poly_unpack(r, n, c, wb);
+      free(mem);
+      return;
+    }
+  }
+
+  memset(c, 0, sizeof(uint32_t) * n);
+  for (i = 0; i < nb; i++) {
+    if (b[i] == 0) continue;
+    for (j = 0; j < na; j++) c[i+j] ^= gf->multiply.w32(gf, a[j], b[i]);
+  }
+}
+
+/* c = a * b, where c has na + nb - 1 entries.  Returns 0 if it runs out of
+   memory.
+
+   With a = a0 + x^m a1 and b = b0 + x^m b1, Karatsuba computes a0 b0, a1 b1
+   and (a0 + a1)(b0 + b1), whose sum is the middle term.  When b is less than
+   half as long as a, a is cut into pieces as long as b instead. */
+
+static int gf_poly_mult(gf_t *gf, uint32_t *a, int na, uint32_t *b, int nb, uint32_t *c)
+{
+  uint32_t *t, *sa, *sb, *z1;
+  int i, m, n1, off, len, rv;
+
+  if (na < nb) {
+    t = a; a = b; b = t;
+    i = na; na = nb; nb = i;
+  }
+  if (nb < GF_POLY_KARATSUBA) {
+    gf_poly_school(gf, a, na, b, nb, c);
+    return 1;
+  }
+
+  if (2 * nb <= na) {
+    t = (uint32_t *) malloc(sizeof(uint32_t) * 2 * nb);
+    if (t == NULL) return 0;
+    memset(c, 0, sizeof(uint32_t) * (na + nb - 1));
+    for (off = 0; off < na; off += nb) {
+      len = (na - off < nb) ? na - off : nb;
+      if (!gf_poly_mult(gf, a + off, len, b, nb, t)) {
+        free(t);
+        return 0;
+      }
+      GF_POLY_XOR(t, c + off, len + nb - 1);
+    }
+    free(t);
+    return 1;
+  }
+
+  /* Here nb > na/2, so b0 has all m coefficients, and b1 may be empty. */
+
+  m = (na + 1) / 2;
+  n1 = nb - m;
+  t = (uint32_t *) malloc(sizeof(uint32_t) * 4 * m);
+  if (t == NULL) return 0;
+  sa = t;
+  sb = t + m;
+  z1 = t + 2 * m;
+
+  memcpy(sa, a, sizeof(uint32_t) * m);
+  GF_POLY_XOR(a + m, sa, na - m);
+  memcpy(sb, b, sizeof(uint32_t) * m);
+  if (n1 > 0) GF_POLY_XOR(b + m, sb, n1);
+
+  memset(c + 2 * m - 1, 0, sizeof(uint32_t) * (na + nb - 2 * m));
+  rv = gf_poly_mult(gf, a, m, b, m, c) && gf_poly_mult(gf, sa, m, sb, m, z1);
+  if (rv && n1 > 0) rv = gf_poly_mult(gf, a + m, na - m, b + m, n1, c + 2 * m);
+
+  if (rv) {
+    GF_POLY_XOR(c, z1, 2 * m - 1);
+    if (n1 > 0) GF_POLY_XOR(c + 2 * m, z1, na + nb - 2 * m - 1);
+
+    /* When b1 is empty and na is odd, z1's top coefficient is zero, and is
+       past the end of c. */
+
+    len = (na + nb - 1 - m < 2 * m - 1) ? na + nb - 1 - m : 2 * m - 1;
+    GF_POLY_XOR(z1, c + m, len);
+  }
+  free(t);
+  return rv;
+}
+
+int gf_poly_degree(uint32_t *p, int n)
+{
+  while (n > 0 && p[n-1] == 0) n--;
+  return n - 1;
+}
+
+int gf_poly_add(gf_t *gf, uint32_t *a, int da, uint32_t *b, int db, uint32_t *c)
+{
+  uint32_t *t;
+  int i;
+
+  (void) gf;    /* Addition is field-independent; gf keeps the signature in line with the others */
+  if (da < db) {
+    t = a; a = b; b = t;
+    i = da; da = db; db = i;
+  }
+  if (c == b) {
+    if (db >= 0) GF_POLY_XOR(a, c, db + 1);
+    memcpy(c + db + 1, a + db + 1, sizeof(uint32_t) * (da - db));
+  } else {
+    if (c != a) memmove(c, a, sizeof(uint32_t) * (da + 1));
+    if (db >= 0) GF_POLY_XOR(b, c, db + 1);
+  }
+  return gf_poly_degree(c, da + 1);
+}
+
+int gf_poly_multiply(gf_t *gf, uint32_t *a, int da, uint32_t *b, int db, uint32_t *c)
+{
+  da = gf_poly_degree(a, da + 1);
+  db = gf_poly_degree(b, db + 1);
+  if (da < 0 || db < 0) return -1;
+  if (!gf_poly_mult(gf, a, da + 1, b, db + 1, c)) return -3;
+  return da + db;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Division */
+
+/* Long division, for da >= db and b[db] != 0.  r has da + 1 entries, and the
+   remainder ends up in the first db.  r may be a. */
+
+static void gf_poly_div_school(gf_t *gf, uint32_t *a, int da, uint32_t *b, int db,
+                               uint32_t *q, uint32_t *r)
+{
+  uint8_t *copy[16], *rr;
+  uint32_t inv, t;
+  void *mem;
+  int i, j, wb;
+
+  inv = gf->inverse.w32(gf, b[db]);
+  wb = gf_poly_region_bytes(gf);
+  if (wb != 0 && db + 1 >= GF_POLY_REGION) {
+    mem = gf_poly_region_setup(b, db + 1, da + 1, wb, copy, &rr);
+    if (mem != NULL) {
+      gf_poly_pack(a, da + 1, rr, wb);
+      for (j = da - db; j >= 0; j--) {
+        t = gf_poly_word(rr, j + db, wb);
+        if (t != 0) {
+          t = gf->multiply.w32(gf, t, inv);
+          gf->multiply_region.w32(gf, copy[j % (16 / wb)], rr + j * wb, t, (db + 1) * wb, 1);
+        }
+        if (q != NULL) q[j] = t;
+      }
+      gf_poly_unpack(rr, db, r, wb);
+      free(mem);
+      return;
+    }
+  }
+
+  if (r != a) memmove(r, a, sizeof(uint32_t) * (da + 1));
+  for (j = da - db; j >= 0; j--) {
+    t = r[j + db];
+    if (t != 0) {
+      t = gf->multiply.w32(gf, t, inv);
+      for (i = 0; i <= db; i++) r[j+i] ^= gf->multiply.w32(gf, t, b[i]);
+    }
+    if (q != NULL) q[j] = t;
+  }
+}
+
+/* g = f^-1 mod x^k, where f has nf coefficients and f[0] != 0.  If
+   f g = 1 + x^m e, then f (f g^2) = 1 + x^2m e^2, so each step is
+   g = f g^2 mod x^2m.  Squaring is linear in characteristic 2:  g^2 is just
+   the squares of g's coefficients, spread out.  Returns 0 if it runs out of
+   memory. */
+
+static int gf_poly_inverse_series(gf_t *gf, uint32_t *f, int nf, int k, uint32_t *g)
+{
+  uint32_t *t, *u;
+  int i, m, m2, nt;
+
+  t = (uint32_t *) malloc(sizeof(uint32_t) * 3 * k);
+  if (t == NULL) return 0;
+  u = t + k;
+
+  g[0] = gf->inverse.w32(gf, f[0]);
+  for (m = 1; m < k; m = m2) {
+    m2 = (2 * m < k) ? 2 * m : k;
+    memset(t, 0, sizeof(uint32_t) * m2);
+    for (i = 0; i < m && 2 * i < m2; i++) t[2*i] = gf->multiply.w32(gf, g[i], g[i]);
+    nt = (nf < m2) ? nf : m2;
+    if (!gf_poly_mult(gf, f, nt, t, m2, u)) {
+      free(t);
+      return 0;
+    }
+    memcpy(g, u, sizeof(uint32_t) * m2);
+  }
+  free(t);
+  return 1;
+}
+
+/* Division by Newton iteration, for da >= db and b[db] != 0.  With n = da -
+   db + 1, reversing the coefficients turns a = q b + r into rev(a) = rev(q)
+   rev(b) mod x^n, so rev(q) is rev(a) times the inverse series of rev(b).
+   The remainder is then a - q b.  r may be a.  Returns 0 if it runs out of
+   memory. */
+
+static int gf_poly_div_newton(gf_t *gf, uint32_t *a, int da, uint32_t *b, int db,
+                              uint32_t *q, uint32_t *r)
+{
+  uint32_t *ra, *rb, *inv, *qq, *prod;
+  int i, n, nb;
+
+  n = da - db + 1;
+  nb = (db + 1 < n) ? db + 1 : n;
+  ra = (uint32_t *) malloc(sizeof(uint32_t) * (n + nb + n + n + (da + 1) + 2 * n));
+  if (ra == NULL) return 0;
+  rb = ra + n;
+  inv = rb + nb;
+  qq = inv + n;
+  prod = qq + n;
+
+  for (i = 0; i < n; i++) ra[i] = a[da-i];
+  for (i = 0; i < nb; i++) rb[i] = b[db-i];
+  if (!gf_poly_inverse_series(gf, rb, nb, n, inv) || !gf_poly_mult(gf, ra, n, inv, n, prod)) {
+    free(ra);
+    return 0;
+  }
+  for (i = 0; i < n; i++) qq[i] = prod[n-1-i];
+
+  if (!gf_poly_mult(gf, b, db + 1, qq, n, prod)) {
+    free(ra);
+    return 0;
+  }
+  if (r != a) memcpy(r, a, sizeof(uint32_t) * db);
+  GF_POLY_XOR(prod, r, db);
+  if (q != NULL) memcpy(q, qq, sizeof(uint32_t) * n);
+  free(ra);
+  return 1;
+}
+
+int gf_poly_divide(gf_t *gf, uint32_t *a, int da, uint32_t *b, int db, uint32_t *q, uint32_t *r)
+{
+  db = gf_poly_degree(b, db + 1);
+  if (db < 0) return -2;
+  da = gf_poly_degree(a, da + 1);
+  if (da < db) {
+    if (r != a) memmove(r, a, sizeof(uint32_t) * (da + 1));
+    return da;
+  }
+
+  if (db + 1 >= GF_POLY_NEWTON && da - db + 1 >= GF_POLY_NEWTON) {
+    if (!gf_poly_div_newton(gf, a, da, b, db, q, r)) return -3;
+  } else {
+    gf_poly_div_school(gf, a, da, b, db, q, r);
+  }
+  return gf_poly_degree(r, db);
+}
+
+int gf_poly_gcd(gf_t *gf, uint32_t *a, int da, uint32_t *b, int db, uint32_t *g)
+{
+  uint32_t *u, *v, *s, *t, inv;
+  int i, n, du, dv, dr;
+
+  n = ((da > db) ? da : db) + 1;
+  if (n <= 0) return -1;
+  u = (uint32_t *) malloc(sizeof(uint32_t) * 2 * n);
+  if (u == NULL) return -3;
+  v = u + n;
+  t = u;
+
+  du = gf_poly_degree(a, da + 1);
+  dv = gf_poly_degree(b, db + 1);
+  memcpy(u, a, sizeof(uint32_t) * (du + 1));
+  memcpy(v, b, sizeof(uint32_t) * (dv + 1));
+
+  /* u = u mod v, then swap them, until v is zero. */
+
+  while (dv >= 0) {
+    dr = gf_poly_divide(gf, u, du, v, dv, NULL, u);
+    if (dr == -3) {
+      free(t);
+      return -3;
+    }
+    s = u; u = v; v = s;
+    du = dv;
+    dv = dr;
+  }
+
+  if (du >= 0) {
+    inv = gf->inverse.w32(gf, u[du]);
+    for (i = 0; i <= du; i++) g[i] = gf->multiply.w32(gf, u[i], inv);
+  }
+  free(t);
+  return du;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Evaluation and interpolation */
+
+uint32_t gf_poly_evaluate(gf_t *gf, uint32_t *p, int d, uint32_t x)
+{
+  uint32_t v;
+  int i;
+
+  v = 0;
+  for (i = d; i >= 0; i--) v = gf->multiply.w32(gf, v, x) ^ p[i];
+  return v;
+}
+
+/* The subproduct tree of n points.  Node j of level l is the product of
+   (x + xs[i]) over the points i in [j 2^l, (j+1) 2^l), which is monic, and
+   whose degree is the number of those points.  It is stored at
+   level[l] + j (2^l + 1).  The root is level[levels-1]. */
+
+typedef struct {
+  int n;
+  int levels;
+  uint32_t **level;
+} gf_poly_tree_t;
+
+static int gf_poly_tree_count(gf_poly_tree_t *t, int l, int j)
+{
+  int lo;
+
+  lo = j << l;
+  return (t->n - lo < (1 << l)) ? t->n - lo : (1 << l);
+}
+
+static void gf_poly_tree_free(gf_poly_tree_t *t)
+{
+  int l;
+
+  if (t->level == NULL) return;
+  for (l = 0; l < t->levels; l++) free(t->level[l]);
+  free(t->level);
+}
+
+static int gf_poly_tree_build(gf_t *gf, uint32_t *xs, int n, gf_poly_tree_t *t)
+{
+  uint32_t *left, *right, *dest;
+  int l, j, half, nodes, cl, cr;
+
+  t->n = n;
+  for (t->levels = 1; (1 << (t->levels - 1)) < n; t->levels++) ;
+  t->level = (uint32_t **) calloc(t->levels, sizeof(uint32_t *));
+  if (t->level == NULL) return 0;
+  for (l = 0; l < t->levels; l++) {
+    nodes = (n + (1 << l) - 1) >> l;
+    t->level[l] = (uint32_t *) malloc(sizeof(uint32_t) * nodes * ((1 << l) + 1));
+    if (t->level[l] == NULL) {
+      gf_poly_tree_free(t);
+      return 0;
+    }
+  }
+
+  for (j = 0; j < n; j++) {
+    t->level[0][2*j] = xs[j];
+    t->level[0][2*j+1] = 1;
+  }
+
+  for (l = 1; l < t->levels; l++) {
+    half = 1 << (l-1);
+    nodes = (n + (1 << l) - 1) >> l;
+    for (j = 0; j < nodes; j++) {
+      left = t->level[l-1] + (2*j) * (half + 1);
+      right = left + half + 1;
+      dest = t->level[l] + j * (2 * half + 1);
+      cl = gf_poly_tree_count(t, l-1, 2*j);
+      if (2*j+1 < ((n + half - 1) >> (l-1))) {
+        cr = gf_poly_tree_count(t, l-1, 2*j+1);
+        if (!gf_poly_mult(gf, left, cl + 1, right, cr + 1, dest)) {
+          gf_poly_tree_free(t);
+          return 0;
+        }
+      } else {
+        memcpy(dest, left, sizeof(uint32_t) * (cl + 1));
+      }
+    }
+  }
+  return 1;
+}
+
+/* Evaluates r, of degree dr, at the points of node j of level l, by reducing
+   it modulo the children's products and descending. */
+
+static int gf_poly_descend(gf_t *gf, gf_poly_tree_t *t, uint32_t *xs, uint32_t *ys,
+                           int l, int j, uint32_t *r, int dr)
+{
+  uint32_t *c;
+  int i, lo, cnt, half, child, cc, dc;
+
+  lo = j << l;
+  cnt = gf_poly_tree_count(t, l, j);
+  if (cnt <= GF_POLY_LEAF) {
+    for (i = 0; i < cnt; i++) ys[lo+i] = gf_poly_evaluate(gf, r, dr, xs[lo+i]);
+    return 1;
+  }
+
+  half = 1 << (l-1);
+  c = (uint32_t *) malloc(sizeof(uint32_t) * (((dr > half) ? dr : half) + 1));
+  if (c == NULL) return 0;
+  for (child = 2*j; child < 2*j+2 && (child << (l-1)) < t->n; child++) {
+    cc = gf_poly_tree_count(t, l-1, child);
+    dc = gf_poly_divide(gf, r, dr, t->level[l-1] + child * (half + 1), cc, NULL, c);
+    if (dc == -3 || !gf_poly_descend(gf, t, xs, ys, l-1, child, c, dc)) {
+      free(c);
+      return 0;
+    }
+  }
+  free(c);
+  return 1;
+}
+
+static int gf_poly_evaluate_tree(gf_t *gf, gf_poly_tree_t *t, uint32_t *p, int d,
+                                 uint32_t *xs, uint32_t *ys)
+{
+  uint32_t *r;
+  int n, rv;
+
+  n = t->n;
+  r = (uint32_t *) malloc(sizeof(uint32_t) * (((d > n) ? d : n) + 1));
+  if (r == NULL) return 0;
+  d = gf_poly_divide(gf, p, d, t->level[t->levels-1], n, NULL, r);
+  rv = (d != -3 && gf_poly_descend(gf, t, xs, ys, t->levels-1, 0, r, d));
+  free(r);
+  return rv;
+}
+
+int gf_poly_evaluate_multi(gf_t *gf, uint32_t *p, int d, uint32_t *xs, int n, uint32_t *ys)
+{
+  gf_poly_tree_t t;
+  int i, rv;
+
+  if (n <= GF_POLY_LEAF || d < GF_POLY_LEAF) {
+    for (i = 0; i < n; i++) ys[i] = gf_poly_evaluate(gf, p, d, xs[i]);
+    return 1;
+  }
+  if (!gf_poly_tree_build(gf, xs, n, &t)) return 0;
+  rv = gf_poly_evaluate_tree(gf, &t, p, d, xs, ys);
+  gf_poly_tree_free(&t);
+  return rv;
+}
+
+/* Lagrange interpolation with the subproduct tree.  With M the root, p is
+   the sum of ys[i] / M'(xs[i]) * M / (x + xs[i]).  The weights come from
+   evaluating M' at the xs, and are zero exactly when a point repeats.  The
+   sum is built up the tree:  a node's sum is its left child's times the
+   right child's product, plus the right child's times the left's. */
+
+int gf_poly_interpolate(gf_t *gf, uint32_t *xs, uint32_t *ys, int n, uint32_t *p)
+{
+  gf_poly_tree_t t;
+  uint32_t *m, *dm, *wt, *cur, *next, *prod, *pl, *pr;
+  int i, j, l, half, nodes, cl, cr, rv;
+
+  if (n <= 0) return -1;
+  if (!gf_poly_tree_build(gf, xs, n, &t)) return -3;
+
+  dm = (uint32_t *) malloc(sizeof(uint32_t) * 4 * (n + 1));
+  if (dm == NULL) {
+    gf_poly_tree_free(&t);
+    return -3;
+  }
+  wt = dm + n;
+  cur = wt + n;
+  prod = cur + n;
+
+  /* In characteristic 2, M' keeps the odd-degree terms of M, shifted down. */
+
+  m = t.level[t.levels-1];
+  for (i = 0; i < n; i++) dm[i] = (i & 1) ? 0 : m[i+1];
+
+  rv = -3;
+  if (!gf_poly_evaluate_tree(gf, &t, dm, n - 1, xs, wt)) goto out;
+  rv = -2;
+  for (i = 0; i < n; i++) {
+    if (wt[i] == 0) goto out;
+    cur[i] = gf->divide.w32(gf, ys[i], wt[i]);
+  }
+
+  /* cur holds the sums of level l-1, node j at cur + j 2^(l-1), with as many
+     coefficients as the node has points. */
+
+  rv = -3;
+  for (l = 1; l < t.levels; l++) {
+    half = 1 << (l-1);
+    nodes = (n + (1 << l) - 1) >> l;
+    next = (uint32_t *) malloc(sizeof(uint32_t) * n);
+    if (next == NULL) goto out;
+    for (j = 0; j < nodes; j++) {
+      pl = cur + (2*j) * half;
+      cl = gf_poly_tree_count(&t, l-1, 2*j);
+      if ((2*j+1) * half >= n) {
+        memcpy(next + j * 2 * half, pl, sizeof(uint32_t) * cl);
+        continue;
+      }
+      pr = pl + half;
+      cr = gf_poly_tree_count(&t, l-1, 2*j+1);
+      if (!gf_poly_mult(gf, pl, cl, t.level[l-1] + (2*j+1) * (half + 1), cr + 1, next + j * 2 * half) ||
+          !gf_poly_mult(gf, pr, cr, t.level[l-1] + (2*j) * (half + 1), cl + 1, prod)) {
+        free(next);
+        goto out;
+      }
+      GF_POLY_XOR(prod, next + j * 2 * half, cl + cr);
+    }
+    memcpy(cur, next, sizeof(uint32_t) * n);
+    free(next);
+  }
+
+  memcpy(p, cur, sizeof(uint32_t) * n);
+  rv = gf_poly_degree(p, n);
+
+out:
+  free(dm);
+  gf_poly_tree_free(&t);
+  return rv;
+}
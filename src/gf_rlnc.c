@@ -0,0 +1,180 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_rlnc.c
+ *
+ * Random linear network coding over GF(2^w).  See gf_rlnc.h.
+ */
+
+#include "gf_int.h"
+#include "gf_rlnc.h"
+#include "gf_matrix.h"
+#include "gf_rand.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Row j of the decoder has its leading one in column pivot[j], and every
+   other row is zero in that column.  row_of[c] is the row whose pivot is
+   column c, or -1.  payload[j] is the payload of row j, and work is where an
+   arriving packet is reduced before it becomes a row. */
+
+struct gf_rlnc_decoder {
+  gf_t *gf;
+  int k;
+  int bytes;
+  int rank;
+  uint32_t *coefs;    /* k x k, one row per received innovative packet */
+  int *pivot;
+  int *row_of;
+  uint8_t **payload;
+  uint8_t *work;
+  void *mem;
+};
+
+void gf_rlnc_encode(gf_t *gf, int k, void **src, uint32_t *coefs, void *dest, int bytes)
+{
+  gf_matrix_region_multiply(gf, coefs, 1, k, src, &dest, bytes, 0);
+}
+
+void gf_rlnc_random_coefficients(gf_t *gf, int k, uint32_t *coefs)
+{
+  int i, w;
+
+  w = ((gf_internal_t *) gf->scratch)->w;
+  for (i = 0; i < k; i++) coefs[i] = MOA_Random_W(w, 1);
+}
+
+gf_rlnc_decoder_t *gf_rlnc_decoder_create(gf_t *gf, int k, int bytes)
+{
+  gf_rlnc_decoder_t *dec;
+  uint8_t *p;
+  int i, size;
+
+  if (((gf_internal_t *) gf->scratch)->w > 32) return NULL;
+  if (k <= 0 || bytes <= 0) return NULL;
+
+  dec = (gf_rlnc_decoder_t *) malloc(sizeof(gf_rlnc_decoder_t));
+  if (dec == NULL) return NULL;
+  dec->gf = gf;
+  dec->k = k;
+  dec->bytes = bytes;
+  dec->rank = 0;
+
+  /* All of the payloads start on 16-byte boundaries, so that they are aligned
+     with respect to each other for the SIMD region kernels. */
+
+  size = (bytes + 15) & ~15;
+  dec->coefs = (uint32_t *) malloc(sizeof(uint32_t)*k*k);
+  dec->pivot = (int *) malloc(sizeof(int)*k*2);
+  dec->payload = (uint8_t **) malloc(sizeof(uint8_t *)*k);
+  dec->mem = malloc((size_t) size*(k+1) + 16);
+  if (dec->coefs == NULL || dec->pivot == NULL || dec->payload == NULL || dec->mem == NULL) {
+    gf_rlnc_decoder_free(dec);
+    return NULL;
+  }
+  dec->row_of = dec->pivot + k;
+  for (i = 0; i < k; i++) dec->row_of[i] = -1;
+
+  p = (uint8_t *) (((uintptr_t) dec->mem + 15) & ~((uintptr_t) 15));
+  for (i = 0; i < k; i++) dec->payload[i] = p + (size_t) i*size;
+  dec->work = p + (size_t) k*size;
+  return dec;
+}
+
+void gf_rlnc_decoder_free(gf_rlnc_decoder_t *dec)
+{
+  if (dec == NULL) return;
+  free(dec->coefs);
+  free(dec->pivot);
+  free(dec->payload);
+  free(dec->mem);
+  free(dec);
+}
+
+int gf_rlnc_decoder_rank(gf_rlnc_decoder_t *dec)
+{
+  return dec->rank;
+}
+
+int gf_rlnc_decoder_add(gf_rlnc_decoder_t *dec, uint32_t *coefs, void *packet)
+{
+  gf_t *gf;
+  int k, i, j, q, r;
+  uint32_t *c, *rj, f;
+
+  gf = dec->gf;
+  k = dec->k;
+  if (dec->rank == k) return 0;
+
+  r = dec->rank;
+  c = dec->coefs + r*k;
+  memcpy(c, coefs, sizeof(uint32_t)*k);
+
+  /* Reduce the new row by every existing row.  Since the existing rows are
+     zero in each other's pivot columns, the coefficient to eliminate with is
+     just the new row's entry in the pivot column.  The coefficients are
+     reduced first, so that a packet that isn't innovative costs no region
+     operations. */
+
+  for (j = 0; j < r; j++) {
+    f = c[dec->pivot[j]];
+    if (f == 0) continue;
+    rj = dec->coefs + j*k;
+    for (i = 0; i < k; i++) c[i] ^= gf->multiply.w32(gf, rj[i], f);
+  }
+  for (q = 0; q < k && c[q] == 0; q++) ;
+  if (q == k) return 0;
+
+  /* It's innovative.  Now do the same elimination on the payload.  Row j's
+     multiplier never changed while we reduced by the other rows, so it is
+     the original coefficient, which is still in coefs. */
+
+  memcpy(dec->work, packet, dec->bytes);
+  for (j = 0; j < r; j++) {
+    f = coefs[dec->pivot[j]];
+    if (f == 0) continue;
+    gf->multiply_region.w32(gf, dec->payload[j], dec->work, f, dec->bytes, 1);
+  }
+
+  /* Scale the new row so that its pivot is one. */
+
+  f = gf->inverse.w32(gf, c[q]);
+  for (i = 0; i < k; i++) c[i] = gf->multiply.w32(gf, c[i], f);
+  gf->multiply_region.w32(gf, dec->work, dec->payload[r], f, dec->bytes, 0);
+
+  /* Eliminate column q from the existing rows, to keep the matrix reduced. */
+
+  for (j = 0; j < r; j++) {
+    rj = dec->coefs + j*k;
+    f = rj[q];
+    if (f == 0) continue;
+    for (i = 0; i < k; i++) rj[i] ^= gf->multiply.w32(gf, c[i], f);
+    gf->multiply_region.w32(gf, dec->payload[r], dec->payload[j], f, dec->bytes, 1);
+  }
+
+  dec->pivot[r] = q;
+  dec->row_of[q] = r;
+  dec->rank++;
+  return 1;
+}
+
+void *gf_rlnc_decoder_packet(gf_rlnc_decoder_t *dec, int i)
+{
+  int j, r;
+  uint32_t *c;
+
+  if (i < 0 || i >= dec->k) return NULL;
+  r = dec->row_of[i];
+  if (r == -1) return NULL;
+
+  /* The row decodes source packet i when its only non-zero entry is the
+     pivot. */
+
+  c = dec->coefs + r*dec->k;
+  for (j = 0; j < dec->k; j++) {
+    if (j != i && c[j] != 0) return NULL;
+  }
+  return dec->payload[r];
+}
@@ -0,0 +1,453 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_rs.c
+ *
+ * Reed-Solomon error correction over GF(2^8) and GF(2^16).  See gf_rs.h.
+ */
+
+#include "gf_int.h"
+#include "gf_rs.h"
+#include "gf_matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Syndromes are computed on chunks of this many bytes of every region, so that
+   the Horner accumulators stay in cache while we sweep over the symbols. */
+
+#define GF_RS_CHUNK (1024)
+
+struct gf_rs {
+  gf_t *gf;
+  int wb;             /* Bytes per word: 1 or 2 */
+  int k;
+  int nroots;
+  int n;
+  int t;              /* The number of correctable errors: nroots/2 */
+  uint32_t *encode;   /* nroots x k matrix that maps data to parity */
+  uint32_t *roots;    /* roots[j] = a^(j+1) */
+  uint32_t *apow;     /* apow[i] = a^i, for i < n */
+  void *chien_mem;
+  uint8_t **chien;    /* chien[j][i] = a^(-i*(j+1)), as regions of n words */
+  uint8_t *ones;      /* A region of n words equal to one */
+};
+
+/* Rounds p up to a 16-byte boundary, so that all of our regions are aligned
+   with respect to each other for the SIMD region kernels. */
+
+static uint8_t *gf_rs_align(void *p)
+{
+  return (uint8_t *) (((uintptr_t) p + 15) & ~((uintptr_t) 15));
+}
+
+static inline uint32_t gf_rs_get(uint8_t *r, int wb, int i)
+{
+  return (wb == 1) ? r[i] : ((uint16_t *) r)[i];
+}
+
+static inline void gf_rs_put(uint8_t *r, int wb, int i, uint32_t v)
+{
+  if (wb == 1) r[i] = v; else ((uint16_t *) r)[i] = v;
+}
+
+/* Symbol i of the codewords:  parity for i < nroots, and data otherwise. */
+
+static inline uint8_t *gf_rs_symbol(gf_rs_t *rs, void **data, void **parity, int i)
+{
+  return (i < rs->nroots) ? (uint8_t *) parity[i] : (uint8_t *) data[i - rs->nroots];
+}
+
+gf_rs_t *gf_rs_create(gf_t *gf, int k, int nroots)
+{
+  gf_internal_t *h;
+  gf_rs_t *rs;
+  uint32_t *g, *rem, top, x, v;
+  int w, i, j, order, tsize;
+
+  h = (gf_internal_t *) gf->scratch;
+  w = h->w;
+  if (w != 8 && w != 16) return NULL;
+  if (h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY)) return NULL;
+  if (k <= 0 || nroots <= 0 || k + nroots > (1 << w) - 1) return NULL;
+
+  /* Make sure that a = 2 generates the multiplicative group. */
+
+  x = 2;
+  for (order = 1; x != 1 && order < (1 << w); order++) x = gf->multiply.w32(gf, x, 2);
+  if (order != (1 << w) - 1) return NULL;
+
+  rs = (gf_rs_t *) malloc(sizeof(gf_rs_t));
+  if (rs == NULL) return NULL;
+  rs->encode = NULL;
+  rs->roots = NULL;
+  rs->chien_mem = NULL;
+  rs->chien = NULL;
+  g = NULL;
+  rem = NULL;
+
+  rs->gf = gf;
+  rs->wb = w/8;
+  rs->k = k;
+  rs->nroots = nroots;
+  rs->n = k + nroots;
+  rs->t = nroots/2;
+
+  rs->apow = (uint32_t *) malloc(sizeof(uint32_t) * rs->n);
+  rs->roots = (uint32_t *) malloc(sizeof(uint32_t) * nroots);
+  g = (uint32_t *) malloc(sizeof(uint32_t) * (nroots+1));
+  rs->encode = (uint32_t *) malloc(sizeof(uint32_t) * nroots * k);
+  rem = (uint32_t *) malloc(sizeof(uint32_t) * nroots);
+  tsize = (rs->n * rs->wb + 15) & ~15;
+  rs->chien_mem = malloc(tsize * (rs->t + 1) + 16);
+  rs->chien = (uint8_t **) malloc(sizeof(uint8_t *) * (rs->t + 1));
+  if (rs->apow == NULL || rs->roots == NULL || g == NULL || rs->encode == NULL ||
+      rem == NULL || rs->chien_mem == NULL || rs->chien == NULL) {
+    free(g);
+    free(rem);
+    gf_rs_free(rs);
+    return NULL;
+  }
+
+  rs->apow[0] = 1;
+  for (i = 1; i < rs->n; i++) rs->apow[i] = gf->multiply.w32(gf, rs->apow[i-1], 2);
+
+  x = 1;
+  for (j = 0; j < nroots; j++) {
+    x = gf->multiply.w32(gf, x, 2);
+    rs->roots[j] = x;
+  }
+
+  /* The generator polynomial g(x) = prod (x - roots[j]).  g[i] is the
+     coefficient of x^i. */
+
+  g[0] = 1;
+  for (j = 0; j < nroots; j++) {
+    g[j+1] = g[j];
+    for (i = j; i > 0; i--) g[i] = g[i-1] ^ gf->multiply.w32(gf, g[i], rs->roots[j]);
+    g[0] = gf->multiply.w32(gf, g[0], rs->roots[j]);
+  }
+
+  /* Column i of the encoding matrix is x^(nroots+i) mod g(x).  Start with
+     x^nroots mod g(x), which is g(x) without its leading term, and multiply
+     by x for each successive column. */
+
+  for (j = 0; j < nroots; j++) rem[j] = g[j];
+  for (i = 0; i < k; i++) {
+    for (j = 0; j < nroots; j++) rs->encode[j*k+i] = rem[j];
+    top = rem[nroots-1];
+    for (j = nroots-1; j > 0; j--) rem[j] = rem[j-1] ^ gf->multiply.w32(gf, top, g[j]);
+    rem[0] = gf->multiply.w32(gf, top, g[0]);
+  }
+  free(rem);
+  free(g);
+
+  /* The Chien tables.  Evaluating lambda(x) at a^(-i) for every position i is
+     then a sum of t region multiplications, one per coefficient of lambda. */
+
+  rs->ones = gf_rs_align(rs->chien_mem);
+  for (j = 0; j < rs->t; j++) rs->chien[j] = rs->ones + (j+1)*tsize;
+  for (i = 0; i < rs->n; i++) {
+    gf_rs_put(rs->ones, rs->wb, i, 1);
+    x = gf->inverse.w32(gf, rs->apow[i]);
+    v = 1;
+    for (j = 0; j < rs->t; j++) {
+      v = gf->multiply.w32(gf, v, x);
+      gf_rs_put(rs->chien[j], rs->wb, i, v);
+    }
+  }
+
+  return rs;
+}
+
+void gf_rs_free(gf_rs_t *rs)
+{
+  if (rs == NULL) return;
+  free(rs->encode);
+  free(rs->roots);
+  free(rs->apow);
+  free(rs->chien);
+  free(rs->chien_mem);
+  free(rs);
+}
+
+void gf_rs_encode(gf_rs_t *rs, void **data, void **parity, int bytes)
+{
+  gf_matrix_region_multiply(rs->gf, rs->encode, rs->nroots, rs->k, data, parity, bytes, 0);
+}
+
+/* Computes the syndromes of len bytes of the codewords, starting at offset
+   off, into acc[0..nroots-1], using Horner's rule on each root:
+
+     S_j = (((r_(n-1) * root_j) + r_(n-2)) * root_j + ...) + r_0
+
+   acc and tmp are arrays of nroots chunk buffers.  Each step copies the
+   next symbol into tmp and adds root_j times acc into it with a single
+   region multiply, and then swaps the two.  Each symbol chunk is read from
+   memory once, and then from cache for the remaining roots.  The buffers are
+   only permuted between acc and tmp, so the caller can free them all. */
+
+static void gf_rs_chunk_syndromes(gf_rs_t *rs, void **data, void **parity,
+                                  int off, int len, uint8_t **acc, uint8_t **tmp)
+{
+  gf_t *gf;
+  uint8_t *sym, *swap;
+  int i, j;
+
+  gf = rs->gf;
+  sym = gf_rs_symbol(rs, data, parity, rs->n-1) + off;
+  for (j = 0; j < rs->nroots; j++) memcpy(acc[j], sym, len);
+
+  for (i = rs->n-2; i >= 0; i--) {
+    sym = gf_rs_symbol(rs, data, parity, i) + off;
+    for (j = 0; j < rs->nroots; j++) {
+      memcpy(tmp[j], sym, len);
+      gf->multiply_region.w32(gf, acc[j], tmp[j], rs->roots[j], len, 1);
+      swap = acc[j];
+      acc[j] = tmp[j];
+      tmp[j] = swap;
+    }
+  }
+}
+
+/* Allocates the 2*nroots aligned chunk buffers for gf_rs_chunk_syndromes().
+   Returns the memory to free along with *acc, or NULL if it runs out. */
+
+static void *gf_rs_chunk_buffers(gf_rs_t *rs, uint8_t ***acc, uint8_t ***tmp)
+{
+  void *mem;
+  uint8_t *p;
+  int j;
+
+  mem = malloc(GF_RS_CHUNK * 2 * rs->nroots + 16);
+  *acc = (uint8_t **) malloc(sizeof(uint8_t *) * rs->nroots * 2);
+  *tmp = NULL;
+  if (mem == NULL || *acc == NULL) {
+    free(mem);
+    free(*acc);
+    return NULL;
+  }
+  *tmp = *acc + rs->nroots;
+  p = gf_rs_align(mem);
+  for (j = 0; j < rs->nroots * 2; j++) (*acc)[j] = p + j*GF_RS_CHUNK;
+  return mem;
+}
+
+int gf_rs_syndromes(gf_rs_t *rs, void **data, void **parity, void **syndromes, int bytes)
+{
+  uint8_t **acc, **tmp;
+  void *mem;
+  int off, len, j;
+
+  mem = gf_rs_chunk_buffers(rs, &acc, &tmp);
+  if (mem == NULL) return 0;
+  for (off = 0; off < bytes; off += GF_RS_CHUNK) {
+    len = (bytes - off < GF_RS_CHUNK) ? bytes - off : GF_RS_CHUNK;
+    gf_rs_chunk_syndromes(rs, data, parity, off, len, acc, tmp);
+    for (j = 0; j < rs->nroots; j++) memcpy((uint8_t *) syndromes[j] + off, acc[j], len);
+  }
+  free(acc);
+  free(mem);
+  return 1;
+}
+
+/* Berlekamp-Massey.  Puts the error locator polynomial into lambda (nroots+1
+   coefficients) and returns its degree L. */
+
+static int gf_rs_berlekamp_massey(gf_rs_t *rs, uint32_t *synd, uint32_t *lambda, uint32_t *b, uint32_t *t)
+{
+  gf_t *gf;
+  int L, m, i, r, nr;
+  uint32_t d, bd, scale;
+
+  gf = rs->gf;
+  nr = rs->nroots;
+  for (i = 0; i <= nr; i++) { lambda[i] = 0; b[i] = 0; }
+  lambda[0] = 1;
+  b[0] = 1;
+  L = 0;
+  m = 1;
+  bd = 1;
+
+  for (r = 0; r < nr; r++) {
+
+    /* The discrepancy between S_r and what lambda predicts for it. */
+
+    d = synd[r];
+    for (i = 1; i <= L; i++) d ^= gf->multiply.w32(gf, lambda[i], synd[r-i]);
+
+    if (d == 0) {
+      m++;
+      continue;
+    }
+
+    /* lambda -= (d/bd) x^m b */
+
+    scale = gf->divide.w32(gf, d, bd);
+    memcpy(t, lambda, sizeof(uint32_t) * (nr+1));
+    for (i = 0; i + m <= nr; i++) {
+      if (b[i] != 0) lambda[i+m] ^= gf->multiply.w32(gf, scale, b[i]);
+    }
+    if (2*L <= r) {
+      L = r + 1 - L;
+      memcpy(b, t, sizeof(uint32_t) * (nr+1));
+      bd = d;
+      m = 1;
+    } else {
+      m++;
+    }
+  }
+  return L;
+}
+
+/* The workspace of gf_rs_correct_ws():  n words for the Chien search,
+   rounded up to 16 bytes, and then the four polynomials of nroots+1
+   coefficients. */
+
+static int gf_rs_ws_size(gf_rs_t *rs)
+{
+  return ((rs->n * rs->wb + 15) & ~15) + sizeof(uint32_t) * (rs->nroots+1) * 4;
+}
+
+/* The body of gf_rs_correct().  ws is a workspace of gf_rs_ws_size()
+   bytes, aligned on a 16-byte boundary. */
+
+static int gf_rs_correct_ws(gf_rs_t *rs, uint32_t *synd, int *locs, uint32_t *vals, uint8_t *ws)
+{
+  gf_t *gf;
+  uint32_t *lambda, *b, *t, *omega, x, num, den, xp;
+  int L, i, j, nr, nerr, rv;
+
+  gf = rs->gf;
+  nr = rs->nroots;
+  lambda = (uint32_t *) (ws + ((rs->n * rs->wb + 15) & ~15));
+  b = lambda + (nr+1);
+  t = b + (nr+1);
+  omega = t + (nr+1);
+
+  rv = -1;
+  L = gf_rs_berlekamp_massey(rs, synd, lambda, b, t);
+  if (L > rs->t) goto done;
+
+  /* Chien search, vectorized over the positions:  ws[i] = lambda(a^(-i)). */
+
+  memcpy(ws, rs->ones, rs->n * rs->wb);
+  for (j = 1; j <= L; j++) {
+    if (lambda[j] != 0) {
+      gf->multiply_region.w32(gf, rs->chien[j-1], ws, lambda[j], rs->n * rs->wb, 1);
+    }
+  }
+
+  nerr = 0;
+  for (i = 0; i < rs->n; i++) {
+    if (gf_rs_get(ws, rs->wb, i) == 0) {
+      if (nerr == L) goto done;
+      locs[nerr++] = i;
+    }
+  }
+  if (nerr != L) goto done;
+
+  /* Forney:  omega(x) = S(x) lambda(x) mod x^nroots, and the error at
+     position i, with X = a^i, is omega(1/X) / lambda'(1/X). */
+
+  for (i = 0; i < nr; i++) {
+    omega[i] = 0;
+    for (j = 0; j <= i && j <= L; j++) omega[i] ^= gf->multiply.w32(gf, lambda[j], synd[i-j]);
+  }
+
+  for (i = 0; i < nerr; i++) {
+    x = gf->inverse.w32(gf, rs->apow[locs[i]]);
+
+    num = 0;
+    for (j = nr-1; j >= 0; j--) num = gf->multiply.w32(gf, num, x) ^ omega[j];
+
+    /* The formal derivative only keeps the odd terms in characteristic two. */
+
+    den = 0;
+    xp = 1;
+    for (j = 1; j <= L; j += 2) {
+      den ^= gf->multiply.w32(gf, lambda[j], xp);
+      xp = gf->multiply.w32(gf, xp, gf->multiply.w32(gf, x, x));
+    }
+    if (den == 0) goto done;
+    vals[i] = gf->divide.w32(gf, num, den);
+  }
+  rv = nerr;
+
+done:
+  return rv;
+}
+
+int gf_rs_correct(gf_rs_t *rs, uint32_t *syndromes, int *locations, uint32_t *values)
+{
+  void *mem;
+  int rv;
+
+  mem = malloc(gf_rs_ws_size(rs) + 16);
+  if (mem == NULL) return -1;
+  rv = gf_rs_correct_ws(rs, syndromes, locations, values, gf_rs_align(mem));
+  free(mem);
+  return rv;
+}
+
+int gf_rs_decode(gf_rs_t *rs, void **data, void **parity, int bytes)
+{
+  uint8_t **acc, **tmp, *ws, *sym;
+  void *mem, *wsmem;
+  uint32_t *synd, *vals, any;
+  int *locs, off, len, p, j, e, total, failed;
+
+  mem = gf_rs_chunk_buffers(rs, &acc, &tmp);
+  wsmem = malloc(gf_rs_ws_size(rs) + 16);
+  synd = (uint32_t *) malloc(sizeof(uint32_t) * (rs->nroots + rs->t + 1));
+  locs = (int *) malloc(sizeof(int) * (rs->t + 1));
+  if (mem == NULL || wsmem == NULL || synd == NULL || locs == NULL) {
+    if (mem != NULL) {
+      free(acc);
+      free(mem);
+    }
+    free(wsmem);
+    free(synd);
+    free(locs);
+    return -1;
+  }
+  ws = gf_rs_align(wsmem);
+  vals = synd + rs->nroots;
+
+  total = 0;
+  failed = 0;
+  for (off = 0; off < bytes; off += GF_RS_CHUNK) {
+    len = (bytes - off < GF_RS_CHUNK) ? bytes - off : GF_RS_CHUNK;
+    gf_rs_chunk_syndromes(rs, data, parity, off, len, acc, tmp);
+
+    /* Only the codewords with a non-zero syndrome need any more work. */
+
+    for (p = 0; p < len / rs->wb; p++) {
+      any = 0;
+      for (j = 0; j < rs->nroots; j++) {
+        synd[j] = gf_rs_get(acc[j], rs->wb, p);
+        any |= synd[j];
+      }
+      if (any == 0) continue;
+
+      e = gf_rs_correct_ws(rs, synd, locs, vals, ws);
+      if (e < 0) {
+        failed = 1;
+        continue;
+      }
+      for (j = 0; j < e; j++) {
+        sym = gf_rs_symbol(rs, data, parity, locs[j]) + off;
+        gf_rs_put(sym, rs->wb, p, gf_rs_get(sym, rs->wb, p) ^ vals[j]);
+      }
+      total += e;
+    }
+  }
+
+  free(acc);
+  free(mem);
+  free(wsmem);
+  free(synd);
+  free(locs);
+  return (failed) ? -1 : total;
+}
@@ -0,0 +1,109 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_shamir.c
+ *
+ * Shamir secret sharing of regions.  See gf_shamir.h.
+ */
+
+#include "gf_int.h"
+#include "gf_shamir.h"
+#include "gf_matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* The chunk size for gf_shamir_split().  The secret and random coefficients
+   are read once per chunk, instead of once per share. */
+
+#define GF_SHAMIR_CHUNK (4096)
+
+int gf_shamir_split(gf_t *gf, int t, int n, void *secret, void **random,
+                    void **shares, int bytes)
+{
+  gf_internal_t *h;
+  int i, j, off, len, chunk;
+  uint8_t *y, *z, *tmp, *s8;
+  void *mem;
+  uint32_t x;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (t <= 0 || n < t || bytes <= 0) return 0;
+  if (h->w < 32 && n > (1 << h->w) - 1) return 0;
+  if (h->w > 32) return 0;
+
+  /* With ALTMAP and CAUCHY, the layout of a region depends on where it starts
+     and how big it is, so the regions can't be cut into chunks. */
+
+  chunk = (h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY) ||
+           (h->w != 4 && h->w != 8 && h->w != 16 && h->w != 32)) ? bytes : GF_SHAMIR_CHUNK;
+
+  /* Horner's rule, one step per coefficient:  y = a_j + x*y.  multiply_region
+     can't work in place, so the steps alternate between the share and tmp,
+     starting with whichever one makes the last step land in the share.  tmp
+     has the same alignment as the secret. */
+
+  mem = malloc(chunk + 32);
+  if (mem == NULL) return 0;
+  tmp = (uint8_t *) (((uintptr_t) mem + 15) & ~((uintptr_t) 15));
+  tmp += (uintptr_t) secret & 15;
+
+  for (off = 0; off < bytes; off += chunk) {
+    len = (bytes - off < chunk) ? bytes - off : chunk;
+    s8 = (uint8_t *) secret + off;
+    for (i = 0; i < n; i++) {
+      x = i+1;
+      if (t == 1) {
+        memcpy((uint8_t *) shares[i] + off, s8, len);
+        continue;
+      }
+      y = (uint8_t *) random[t-2] + off;
+      for (j = t-2; j >= 0; j--) {
+        z = (j % 2 == 0) ? (uint8_t *) shares[i] + off : tmp;
+        memcpy(z, (j == 0) ? s8 : (uint8_t *) random[j-1] + off, len);
+        gf->multiply_region.w32(gf, y, z, x, len, 1);
+        y = z;
+      }
+    }
+  }
+
+  free(mem);
+  return 1;
+}
+
+/* The secret is the value at zero, so share i is weighted by its Lagrange
+   coefficient at zero:  the product over j != i of x_j / (x_j - x_i). */
+
+int gf_shamir_recover(gf_t *gf, int t, int *ids, void **shares, void *secret, int bytes)
+{
+  gf_internal_t *h;
+  uint32_t *lambda, xi, xj, num, den;
+  int i, j;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (t <= 0 || h->w > 32) return 0;
+  for (i = 0; i < t; i++) {
+    if (ids[i] < 0 || (h->w < 32 && ids[i] >= (1 << h->w) - 1)) return 0;
+    for (j = 0; j < i; j++) if (ids[j] == ids[i]) return 0;
+  }
+
+  lambda = (uint32_t *) malloc(sizeof(uint32_t) * t);
+  if (lambda == NULL) return 0;
+  for (i = 0; i < t; i++) {
+    xi = ids[i] + 1;
+    num = 1;
+    den = 1;
+    for (j = 0; j < t; j++) {
+      if (j == i) continue;
+      xj = ids[j] + 1;
+      num = gf->multiply.w32(gf, num, xj);
+      den = gf->multiply.w32(gf, den, xj ^ xi);
+    }
+    lambda[i] = gf->divide.w32(gf, num, den);
+  }
+
+  gf_matrix_region_multiply(gf, lambda, 1, t, shares, &secret, bytes, 0);
+  free(lambda);
+  return 1;
+}
@@ -0,0 +1,315 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_stream.c
+ *
+ * Pipelined streaming encoder.  See gf_stream.h.
+ */
+
+#include "gf_int.h"
+#include "gf_stream.h"
+#include "gf_matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/* A slot goes FREE -> READ (by the reader) -> ENCODED (by the encoder) ->
+   FREE (by the writer).  Each stage visits the slots in order, so stripes
+   come out in the order they went in. */
+
+#define GF_STREAM_FREE (0)
+#define GF_STREAM_READ (1)
+#define GF_STREAM_ENCODED (2)
+
+typedef struct {
+  int state;
+  int bytes;        /* Input bytes in this stripe */
+  int last;         /* Set on the stripe that hit the end of the input */
+  uint8_t *base;    /* k+m chunks, 64-byte aligned */
+} gf_stream_slot_t;
+
+struct gf_stream {
+  gf_t *gf;
+  int k;
+  int m;
+  int chunk;
+  int depth;
+  uint32_t *matrix;
+  gf_stream_slot_t *slot;
+  void *mem;
+
+  /* The current gf_stream_encode() call */
+
+  int in_fd;
+  int *data_fds;
+  int *coding_fds;
+  int64_t total;
+  int error;        /* errno of the first failure, which stops every stage */
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+};
+
+gf_stream_t *gf_stream_create(gf_t *gf, int k, int m, uint32_t *coding_matrix, int chunk, int depth)
+{
+  gf_internal_t *h;
+  gf_stream_t *s;
+  uint8_t *base;
+  size_t sbytes;
+  int i;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (h->w > 32 || k <= 0 || m <= 0 || depth < 2) return NULL;
+  if (chunk <= 0 || chunk % 64 != 0 || (int64_t) chunk * k > INT32_MAX) return NULL;
+
+  s = (gf_stream_t *) calloc(1, sizeof(gf_stream_t));
+  if (s == NULL) return NULL;
+  s->gf = gf;
+  s->k = k;
+  s->m = m;
+  s->chunk = chunk;
+  s->depth = depth;
+
+  sbytes = (size_t) chunk * (k + m);
+  s->matrix = (uint32_t *) malloc(sizeof(uint32_t) * k * m);
+  s->slot = (gf_stream_slot_t *) malloc(sizeof(gf_stream_slot_t) * depth);
+  s->mem = malloc(sbytes * depth + 64);
+  if (s->matrix == NULL || s->slot == NULL || s->mem == NULL) {
+    free(s->matrix);
+    free(s->slot);
+    free(s->mem);
+    free(s);
+    return NULL;
+  }
+  memcpy(s->matrix, coding_matrix, sizeof(uint32_t) * k * m);
+  base = (uint8_t *) (((uintptr_t) s->mem + 63) & ~((uintptr_t) 63));
+  for (i = 0; i < depth; i++) s->slot[i].base = base + sbytes * i;
+
+  pthread_mutex_init(&s->lock, NULL);
+  pthread_cond_init(&s->cond, NULL);
+  return s;
+}
+
+void gf_stream_free(gf_stream_t *s)
+{
+  if (s == NULL) return;
+  pthread_mutex_destroy(&s->lock);
+  pthread_cond_destroy(&s->cond);
+  free(s->matrix);
+  free(s->slot);
+  free(s->mem);
+  free(s);
+}
+
+/* Reads until the buffer is full or the input ends.  Returns the number of
+   bytes read, or -1 with errno set. */
+
+static int gf_stream_read_full(int fd, uint8_t *buf, int bytes)
+{
+  ssize_t n;
+  int done;
+
+  for (done = 0; done < bytes; done += n) {
+    n = read(fd, buf + done, bytes - done);
+    if (n < 0 && errno == EINTR) {
+      n = 0;
+      continue;
+    }
+    if (n < 0) return -1;
+    if (n == 0) break;
+  }
+  return done;
+}
+
+static int gf_stream_write_full(int fd, uint8_t *buf, int bytes)
+{
+  ssize_t n;
+  int done;
+
+  for (done = 0; done < bytes; done += n) {
+    n = write(fd, buf + done, bytes - done);
+    if (n < 0 && errno == EINTR) {
+      n = 0;
+      continue;
+    }
+    if (n < 0) return 0;
+    if (n == 0) {
+      errno = EIO;
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* The work of each stage on one slot.  Each returns 0 with errno set if it
+   fails. */
+
+static int gf_stream_fill(gf_stream_t *s, gf_stream_slot_t *sl)
+{
+  int n, full;
+
+  full = s->k * s->chunk;
+  n = gf_stream_read_full(s->in_fd, sl->base, full);
+  if (n < 0) return 0;
+  if (n < full) memset(sl->base + n, 0, full - n);
+  sl->bytes = n;
+  sl->last = (n < full);
+  return 1;
+}
+
+static void gf_stream_code(gf_stream_t *s, gf_stream_slot_t *sl, void **ptrs)
+{
+  int i;
+
+  if (sl->bytes == 0) return;
+  for (i = 0; i < s->k + s->m; i++) ptrs[i] = sl->base + (size_t) i * s->chunk;
+  gf_matrix_region_multiply(s->gf, s->matrix, s->m, s->k, ptrs, ptrs + s->k, s->chunk, 0);
+}
+
+static int gf_stream_drain(gf_stream_t *s, gf_stream_slot_t *sl)
+{
+  int i, fd;
+
+  if (sl->bytes == 0) return 1;
+  for (i = 0; i < s->k + s->m; i++) {
+    fd = (i < s->k) ? s->data_fds[i] : s->coding_fds[i - s->k];
+    if (!gf_stream_write_full(fd, sl->base + (size_t) i * s->chunk, s->chunk)) return 0;
+  }
+  s->total += sl->bytes;
+  return 1;
+}
+
+/* Waits until slot i is in the given state.  Returns 0 if some stage has
+   failed instead. */
+
+static int gf_stream_wait(gf_stream_t *s, int i, int state)
+{
+  int ok;
+
+  pthread_mutex_lock(&s->lock);
+  while (s->slot[i].state != state && s->error == 0) pthread_cond_wait(&s->cond, &s->lock);
+  ok = (s->error == 0);
+  pthread_mutex_unlock(&s->lock);
+  return ok;
+}
+
+static void gf_stream_post(gf_stream_t *s, int i, int state)
+{
+  pthread_mutex_lock(&s->lock);
+  s->slot[i].state = state;
+  pthread_cond_broadcast(&s->cond);
+  pthread_mutex_unlock(&s->lock);
+}
+
+static void gf_stream_fail(gf_stream_t *s, int err)
+{
+  pthread_mutex_lock(&s->lock);
+  if (s->error == 0) s->error = (err != 0) ? err : EIO;
+  pthread_cond_broadcast(&s->cond);
+  pthread_mutex_unlock(&s->lock);
+}
+
+static void *gf_stream_reader(void *arg)
+{
+  gf_stream_t *s;
+  int i, last;
+
+  s = (gf_stream_t *) arg;
+  for (i = 0; ; i = (i + 1) % s->depth) {
+    if (!gf_stream_wait(s, i, GF_STREAM_FREE)) break;
+    if (!gf_stream_fill(s, &s->slot[i])) {
+      gf_stream_fail(s, errno);
+      break;
+    }
+    last = s->slot[i].last;
+    gf_stream_post(s, i, GF_STREAM_READ);
+    if (last) break;
+  }
+  return NULL;
+}
+
+static void *gf_stream_writer(void *arg)
+{
+  gf_stream_t *s;
+  int i, last;
+
+  s = (gf_stream_t *) arg;
+  for (i = 0; ; i = (i + 1) % s->depth) {
+    if (!gf_stream_wait(s, i, GF_STREAM_ENCODED)) break;
+    if (!gf_stream_drain(s, &s->slot[i])) {
+      gf_stream_fail(s, errno);
+      break;
+    }
+    last = s->slot[i].last;
+    gf_stream_post(s, i, GF_STREAM_FREE);
+    if (last) break;
+  }
+  return NULL;
+}
+
+int64_t gf_stream_encode(gf_stream_t *s, int in_fd, int *data_fds, int *coding_fds)
+{
+  pthread_t reader, writer;
+  int i, r_ok, w_ok, last;
+  void **ptrs;
+
+  ptrs = (void **) malloc(sizeof(void *) * (s->k + s->m));
+  if (ptrs == NULL) {
+    errno = ENOMEM;
+    return -1;
+  }
+  s->in_fd = in_fd;
+  s->data_fds = data_fds;
+  s->coding_fds = coding_fds;
+  s->total = 0;
+  s->error = 0;
+  for (i = 0; i < s->depth; i++) s->slot[i].state = GF_STREAM_FREE;
+
+  /* The writer starts first, since stopping it doesn't lose any input. */
+
+  w_ok = (pthread_create(&writer, NULL, gf_stream_writer, s) == 0);
+  r_ok = w_ok && (pthread_create(&reader, NULL, gf_stream_reader, s) == 0);
+
+  if (r_ok) {
+    for (i = 0; ; i = (i + 1) % s->depth) {
+      if (!gf_stream_wait(s, i, GF_STREAM_READ)) break;
+      gf_stream_code(s, &s->slot[i], ptrs);
+      last = s->slot[i].last;
+      gf_stream_post(s, i, GF_STREAM_ENCODED);
+      if (last) break;
+    }
+    pthread_join(reader, NULL);
+    pthread_join(writer, NULL);
+  } else {
+
+    /* If a stage's thread can't be started, run the stages one after the
+       other on this thread. */
+
+    if (w_ok) {
+      gf_stream_fail(s, EAGAIN);
+      pthread_join(writer, NULL);
+      s->error = 0;
+    }
+    do {
+      if (!gf_stream_fill(s, &s->slot[0])) {
+        s->error = errno;
+        break;
+      }
+      gf_stream_code(s, &s->slot[0], ptrs);
+      if (!gf_stream_drain(s, &s->slot[0])) {
+        s->error = errno;
+        break;
+      }
+    } while (!s->slot[0].last);
+  }
+
+  free(ptrs);
+  if (s->error != 0) {
+    errno = s->error;
+    return -1;
+  }
+  return s->total;
+}
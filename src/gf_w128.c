@@ -27,6 +27,10 @@
   a[i] = 0; \
   a[i + 1] = 0;}
 
+/* The split tables and the GROUP m_table depend on the multiplier, so they
+   are kept in the per-thread region context rather than the scratch
+   memory. */
+
 struct gf_w128_split_4_128_data {
   uint64_t last_value[2];
   uint64_t tables[2][32][16];
@@ -38,7 +42,6 @@ struct gf_w128_split_8_128_data {
 };
 
 typedef struct gf_group_tables_s {
-  gf_val_128_t m_table;
   gf_val_128_t r_table;
 } gf_group_tables_t;
 
@@ -522,6 +525,7 @@ gf_w128_split_4_128_multiply_region(gf_t *gf, void *src, void *dest, gf_val_128_
   gf_region_data rd;
   uint64_t v[2], s;
   struct gf_w128_split_4_128_data *ld;
+  int fresh;
 
   /* We only do this to check on alignment. */
   gf_set_region_data(&rd, gf, src, dest, bytes, 0, xor, 8);
@@ -532,13 +536,13 @@ gf_w128_split_4_128_multiply_region(gf_t *gf, void *src, void *dest, gf_val_128_
   }
     
   h = (gf_internal_t *) gf->scratch;
-  ld = (struct gf_w128_split_4_128_data *) h->private;
+  ld = (struct gf_w128_split_4_128_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_w128_split_4_128_data), &fresh);
 
   s64 = (uint64_t *) rd.s_start;
   d64 = (uint64_t *) rd.d_start;
   top = (uint64_t *) rd.d_top;
 
-  if (val[0] != ld->last_value[0] || val[1] != ld->last_value[1]) {
+  if (fresh || val[0] != ld->last_value[0] || val[1] != ld->last_value[1]) {
     v[0] = val[0];
     v[1] = val[1];
     for (i = 0; i < 32; i++) {
@@ -604,6 +608,7 @@ gf_w128_split_4_128_sse_multiply_region(gf_t *gf, void *src, void *dest, gf_val_
   uint64_t pp, v[2], s, *s64, *d64, *top;
   __m128i p, tables[32][16];
   struct gf_w128_split_4_128_data *ld;
+  int fresh;
   gf_region_data rd;
 
   if (val[0] == 0) {
@@ -624,9 +629,9 @@ gf_w128_split_4_128_sse_multiply_region(gf_t *gf, void *src, void *dest, gf_val_
   d64 = (uint64_t *) rd.d_start;
   top = (uint64_t *) rd.d_top;
  
-  ld = (struct gf_w128_split_4_128_data *) h->private;
+  ld = (struct gf_w128_split_4_128_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_w128_split_4_128_data), &fresh);
 
-  if (val[0] != ld->last_value[0] || val[1] != ld->last_value[1]) {
+  if (fresh || val[0] != ld->last_value[0] || val[1] != ld->last_value[1]) {
     v[0] = val[0];
     v[1] = val[1];
     for (i = 0; i < 32; i++) {
@@ -702,6 +707,7 @@ gf_w128_split_4_128_sse_altmap_multiply_region(gf_t *gf, void *src, void *dest,
   uint64_t pp, v[2], *s64, *d64, *top;
   __m128i si, tables[32][16], p[16], v0, mask1;
   struct gf_w128_split_4_128_data *ld;
+  int fresh;
   uint8_t btable[16];
   gf_region_data rd;
 
@@ -723,9 +729,9 @@ gf_w128_split_4_128_sse_altmap_multiply_region(gf_t *gf, void *src, void *dest,
   d64 = (uint64_t *) rd.d_start;
   top = (uint64_t *) rd.d_top;
  
-  ld = (struct gf_w128_split_4_128_data *) h->private;
+  ld = (struct gf_w128_split_4_128_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_w128_split_4_128_data), &fresh);
 
-  if (val[0] != ld->last_value[0] || val[1] != ld->last_value[1]) {
+  if (fresh || val[0] != ld->last_value[0] || val[1] != ld->last_value[1]) {
     v[0] = val[0];
     v[1] = val[1];
     for (i = 0; i < 32; i++) {
@@ -812,6 +818,7 @@ gf_w128_split_8_128_multiply_region(gf_t *gf, void *src, void *dest, gf_val_128_
   gf_region_data rd;
   uint64_t v[2], s;
   struct gf_w128_split_8_128_data *ld;
+  int fresh;
 
   /* Check on alignment. Ignore it otherwise. */
   gf_set_region_data(&rd, gf, src, dest, bytes, 0, xor, 8);
@@ -822,13 +829,13 @@ gf_w128_split_8_128_multiply_region(gf_t *gf, void *src, void *dest, gf_val_128_
   }
     
   h = (gf_internal_t *) gf->scratch;
-  ld = (struct gf_w128_split_8_128_data *) h->private;
+  ld = (struct gf_w128_split_8_128_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_w128_split_8_128_data), &fresh);
 
   s64 = (uint64_t *) rd.s_start;
   d64 = (uint64_t *) rd.d_start;
   top = (uint64_t *) rd.d_top;
 
-  if (val[0] != ld->last_value[0] || val[1] != ld->last_value[1]) {
+  if (fresh || val[0] != ld->last_value[0] || val[1] != ld->last_value[1]) {
     v[0] = val[0];
     v[1] = val[1];
     for (i = 0; i < 16; i++) {
@@ -945,38 +952,54 @@ gf_w128_bytwo_b_multiply_region(gf_t *gf, void *src, void *dest, gf_val_128_t va
 }
 
 static
-void gf_w128_group_m_init(gf_t *gf, gf_val_128_t b128)
+void gf_w128_group_m_init(gf_t *gf, uint64_t *m_table, gf_val_128_t b128)
 {
   int i, j;
   int g_m;
   uint64_t prim_poly, lbit;
   gf_internal_t *scratch;
-  gf_group_tables_t *gt;
   uint64_t a128[2];
   scratch = (gf_internal_t *) gf->scratch;
-  gt = scratch->private;
   g_m = scratch->arg1;
   prim_poly = scratch->prim_poly;
 
 
-  set_zero(gt->m_table, 0);
-  a_get_b(gt->m_table, 2, b128, 0);
+  set_zero(m_table, 0);
+  a_get_b(m_table, 2, b128, 0);
   lbit = 1;
   lbit <<= 63;
 
   for (i = 2; i < (1 << g_m); i <<= 1) {
-    a_get_b(a128, 0, gt->m_table, 2 * (i >> 1));
+    a_get_b(a128, 0, m_table, 2 * (i >> 1));
     two_x(a128);
-    a_get_b(gt->m_table, 2 * i, a128, 0);
-    if (gt->m_table[2 * (i >> 1)] & lbit) gt->m_table[(2 * i) + 1] ^= prim_poly;
+    a_get_b(m_table, 2 * i, a128, 0);
+    if (m_table[2 * (i >> 1)] & lbit) m_table[(2 * i) + 1] ^= prim_poly;
     for (j = 0; j < i; j++) {
-      gt->m_table[(2 * i) + (2 * j)] = gt->m_table[(2 * i)] ^ gt->m_table[(2 * j)];
-      gt->m_table[(2 * i) + (2 * j) + 1] = gt->m_table[(2 * i) + 1] ^ gt->m_table[(2 * j) + 1];
+      m_table[(2 * i) + (2 * j)] = m_table[(2 * i)] ^ m_table[(2 * j)];
+      m_table[(2 * i) + (2 * j) + 1] = m_table[(2 * i) + 1] ^ m_table[(2 * j) + 1];
     }
   }
   return;
 }
 
+/* Returns this thread's m_table for b128 in context "key", building it
+   unless it already holds b128 (m_table[2..3] is b128 itself). */
+
+static
+uint64_t *gf_w128_group_m_table(gf_t *gf, int key, gf_val_128_t b128)
+{
+  gf_internal_t *scratch;
+  uint64_t *m_table;
+  int fresh;
+
+  scratch = (gf_internal_t *) gf->scratch;
+  m_table = (uint64_t *) gf_region_context(gf, key, (1 << scratch->arg1) * 2 * sizeof(uint64_t), &fresh);
+  if (fresh || b128[0] != m_table[2] || b128[1] != m_table[3]) {
+    gf_w128_group_m_init(gf, m_table, b128);
+  }
+  return m_table;
+}
+
 void
 gf_w128_group_multiply(GFP gf, gf_val_128_t a128, gf_val_128_t b128, gf_val_128_t c128)
 {
@@ -988,6 +1011,7 @@ gf_w128_group_multiply(GFP gf, gf_val_128_t a128, gf_val_128_t b128, gf_val_128_
   uint64_t p_i[2], a[2];
   gf_internal_t *scratch;
   gf_group_tables_t *gt;
+  uint64_t *m_table;
 
   scratch = (gf_internal_t *) gf->scratch;
   gt = scratch->private;
@@ -997,9 +1021,7 @@ gf_w128_group_multiply(GFP gf, gf_val_128_t a128, gf_val_128_t b128, gf_val_128_
   mask_m = (1 << g_m) - 1;
   mask_r = (1 << g_r) - 1;
 
-  if (b128[0] != gt->m_table[2] || b128[1] != gt->m_table[3]) {
-    gf_w128_group_m_init(gf, b128);
-  }
+  m_table = gf_w128_group_m_table(gf, GF_CONTEXT_MULTIPLY, b128);
   
   p_i[0] = 0;
   p_i[1] = 0;
@@ -1016,8 +1038,8 @@ gf_w128_group_multiply(GFP gf, gf_val_128_t a128, gf_val_128_t b128, gf_val_128_
     p_i[0] <<= g_m;
     p_i[0] ^= (p_i[1] >> (64-g_m));
     p_i[1] <<= g_m;
-    p_i[0] ^= gt->m_table[2 * i_m];
-    p_i[1] ^= gt->m_table[(2 * i_m) + 1];
+    p_i[0] ^= m_table[2 * i_m];
+    p_i[1] ^= m_table[(2 * i_m) + 1];
     t_m += g_m;
     if (t_m == g_r) {
       p_i[1] ^= gt->r_table[i_r];
@@ -1034,8 +1056,8 @@ gf_w128_group_multiply(GFP gf, gf_val_128_t a128, gf_val_128_t b128, gf_val_128_
     p_i[0] <<= g_m;
     p_i[0] ^= (p_i[1] >> (64-g_m));
     p_i[1] <<= g_m;
-    p_i[0] ^= gt->m_table[2 * i_m];
-    p_i[1] ^= gt->m_table[(2 * i_m) + 1];
+    p_i[0] ^= m_table[2 * i_m];
+    p_i[1] ^= m_table[(2 * i_m) + 1];
     t_m += g_m;
     if (t_m == g_r) {
       p_i[1] ^= gt->r_table[i_r];
@@ -1061,7 +1083,7 @@ gf_w128_group_multiply_region(gf_t *gf, void *src, void *dest, gf_val_128_t val,
   gf_internal_t *scratch;
   gf_group_tables_t *gt;
   gf_region_data rd;
-  uint64_t *a128, *c128, *top;
+  uint64_t *a128, *c128, *top, *m_table;
 
   /* We only do this to check on alignment. */
   gf_set_region_data(&rd, gf, src, dest, bytes, 0, xor, 8);
@@ -1079,9 +1101,7 @@ gf_w128_group_multiply_region(gf_t *gf, void *src, void *dest, gf_val_128_t val,
   mask_m = (1 << g_m) - 1;
   mask_r = (1 << g_r) - 1;
 
-  if (val[0] != gt->m_table[2] || val[1] != gt->m_table[3]) {
-    gf_w128_group_m_init(gf, val);
-  }
+  m_table = gf_w128_group_m_table(gf, GF_CONTEXT_REGION, val);
 
   a128 = (uint64_t *) src;
   c128 = (uint64_t *) dest;
@@ -1104,8 +1124,8 @@ gf_w128_group_multiply_region(gf_t *gf, void *src, void *dest, gf_val_128_t val,
       p_i[0] ^= (p_i[1] >> (64-g_m));
       p_i[1] <<= g_m;
       
-      p_i[0] ^= gt->m_table[2 * i_m];
-      p_i[1] ^= gt->m_table[(2 * i_m) + 1];
+      p_i[0] ^= m_table[2 * i_m];
+      p_i[1] ^= m_table[(2 * i_m) + 1];
       t_m += g_m;
       if (t_m == g_r) {
         p_i[1] ^= gt->r_table[i_r];
@@ -1121,8 +1141,8 @@ gf_w128_group_multiply_region(gf_t *gf, void *src, void *dest, gf_val_128_t val,
       p_i[0] <<= g_m;
       p_i[0] ^= (p_i[1] >> (64-g_m));
       p_i[1] <<= g_m;
-      p_i[0] ^= gt->m_table[2 * i_m];
-      p_i[1] ^= gt->m_table[(2 * i_m) + 1];
+      p_i[0] ^= m_table[2 * i_m];
+      p_i[1] ^= m_table[(2 * i_m) + 1];
       t_m += g_m;
       if (t_m == g_r) {
         p_i[1] ^= gt->r_table[i_r];
@@ -1519,8 +1539,6 @@ void gf_w128_group_r_sse_init(gf_t *gf)
   static 
 int gf_w128_split_init(gf_t *gf)
 {
-  struct gf_w128_split_4_128_data *sd4;
-  struct gf_w128_split_8_128_data *sd8;
   gf_internal_t *h;
 
   h = (gf_internal_t *) gf->scratch;
@@ -1535,14 +1553,8 @@ int gf_w128_split_init(gf_t *gf)
   gf->inverse.w128 = gf_w128_euclid;
 
   if ((h->arg1 != 4 && h->arg2 != 4) || h->mult_type == GF_MULT_DEFAULT) {
-    sd8 = (struct gf_w128_split_8_128_data *) h->private;
-    sd8->last_value[0] = 0;
-    sd8->last_value[1] = 0;
     gf->multiply_region.w128 = gf_w128_split_8_128_multiply_region;
   } else {
-    sd4 = (struct gf_w128_split_4_128_data *) h->private;
-    sd4->last_value[0] = 0;
-    sd4->last_value[1] = 0;
     if((h->region_type & GF_REGION_ALTMAP))
     {
       #ifdef INTEL_SSE4
@@ -1574,17 +1586,11 @@ int gf_w128_group_init(gf_t *gf)
 {
   gf_internal_t *scratch;
   gf_group_tables_t *gt;
-  int g_r, size_r;
 
   scratch = (gf_internal_t *) gf->scratch;
   gt = scratch->private;
-  g_r = scratch->arg2;
-  size_r = (1 << g_r);
 
   gt->r_table = (gf_val_128_t)((uint8_t *)scratch->private + (2 * sizeof(uint64_t *)));
-  gt->m_table = gt->r_table + size_r;
-  gt->m_table[2] = 0;
-  gt->m_table[3] = 0;
 
   gf->multiply.w128 = gf_w128_group_multiply;
   gf->inverse.w128 = gf_w128_euclid;
@@ -1674,7 +1680,7 @@ void gf_w128_composite_extract_word(gf_t *gf, void *start, int bytes, int index,
 
 int gf_w128_scratch_size(int mult_type, int region_type, int divide_type, int arg1, int arg2)
 {
-  int size_m, size_r;
+  int size_r;
   if (divide_type==GF_DIVIDE_MATRIX) return 0;
 
   switch(mult_type)
@@ -1691,22 +1697,22 @@ int gf_w128_scratch_size(int mult_type, int region_type, int divide_type, int ar
       break;
     case GF_MULT_DEFAULT: 
     case GF_MULT_SPLIT_TABLE:
-      if ((arg1 == 4 && arg2 == 128) || (arg1 == 128 && arg2 == 4)) {
-        return sizeof(gf_internal_t) + sizeof(struct gf_w128_split_4_128_data) + 64;
-      } else if ((arg1 == 8 && arg2 == 128) || (arg1 == 128 && arg2 == 8) || mult_type == GF_MULT_DEFAULT) {
-        return sizeof(gf_internal_t) + sizeof(struct gf_w128_split_8_128_data) + 64;
+      /* The region tables live in the per-thread region context. */
+      if ((arg1 == 4 && arg2 == 128) || (arg1 == 128 && arg2 == 4) ||
+          (arg1 == 8 && arg2 == 128) || (arg1 == 128 && arg2 == 8) || mult_type == GF_MULT_DEFAULT) {
+        return sizeof(gf_internal_t) + 64;
       }
       return 0;
       break;
     case GF_MULT_GROUP:
       /* JSP We've already error checked the arguments. */
-      size_m = (1 << arg1) * 2 * sizeof(uint64_t);
       size_r = (1 << arg2) * 2 * sizeof(uint64_t);
       /* 
        * two pointers prepend the table data for structure
-       * because the tables are of dynamic size
+       * because the tables are of dynamic size.  The m_table is in
+       * the per-thread region context.
        */
-      return sizeof(gf_internal_t) + size_m + size_r + 4 * sizeof(uint64_t *);
+      return sizeof(gf_internal_t) + size_r + 4 * sizeof(uint64_t *);
       break;
     case GF_MULT_COMPOSITE:
       if (arg1 == 2) {
@@ -1756,7 +1762,10 @@ int gf_w128_init(gf_t *gf)
 
   /* Ben: Used to be h->region_type == GF_REGION_ALTMAP, but failed since there
      are multiple flags in h->region_type */
-  if (h->mult_type == GF_MULT_SPLIT_TABLE && (h->region_type & GF_REGION_ALTMAP)) {
+  if (h->region_type == GF_REGION_CAUCHY) {
+    gf->multiply_region.w128 = gf_wgen_cauchy_region_w128;
+    gf->extract_word.w128 = gf_wgen_extract_word_w128;
+  } else if (h->mult_type == GF_MULT_SPLIT_TABLE && (h->region_type & GF_REGION_ALTMAP)) {
     gf->extract_word.w128 = gf_w128_split_extract_word;
   } else if (h->mult_type == GF_MULT_COMPOSITE && h->region_type == GF_REGION_ALTMAP) {
     gf->extract_word.w128 = gf_w128_composite_extract_word;
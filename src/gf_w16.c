@@ -11,6 +11,7 @@
 #include "gf_int.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include "gf_w16.h"
 
 #define AB2(ip, am1 ,am2, b, t1, t2) {\
@@ -645,26 +646,48 @@ gf_w16_log_divide(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
   return (ltd->d_antilog[log_sum]);
 }
 
+/* The inverse table is only used by inverse(), so it is built the first time
+   that needs it. */
+
+#define GF_W16_INVERSE_PART (0)
+
+static
+void gf_w16_log_build_inverse(gf_t *gf, void *tables)
+{
+  struct gf_w16_logtable_data *ltd;
+  int i;
+
+  ltd = (struct gf_w16_logtable_data *) tables;
+  ltd->inv_tbl[0] = 0;  /* Not really, but we need to fill it with something  */
+  ltd->inv_tbl[1] = 1;
+  for (i = 2; i < GF_FIELD_SIZE; i++) {
+    ltd->inv_tbl[i] = ltd->antilog_tbl[GF_MULT_GROUP_SIZE-ltd->log_tbl[i]];
+  }
+}
+
 static
 gf_val_32_t
 gf_w16_log_inverse(gf_t *gf, gf_val_32_t a)
 {
   struct gf_w16_logtable_data *ltd;
 
+  GF_NEED_PART(gf, GF_W16_INVERSE_PART, gf_w16_log_build_inverse);
   ltd = (struct gf_w16_logtable_data *) ((gf_internal_t *) gf->scratch)->private;
   return (ltd->inv_tbl[a]);
 }
 
+/* Fills the log and antilog tables, and returns 0 if the polynomial isn't
+   primitive.  The inverse table is left for gf_w16_log_build_inverse(). */
+
 static
-int gf_w16_log_init(gf_t *gf)
+int gf_w16_log_build(gf_t *gf, void *tables)
 {
   gf_internal_t *h;
   struct gf_w16_logtable_data *ltd;
   int i, b;
-  int check = 0;
 
   h = (gf_internal_t *) gf->scratch;
-  ltd = h->private;
+  ltd = (struct gf_w16_logtable_data *) tables;
   
   for (i = 0; i < GF_MULT_GROUP_SIZE+1; i++)
     ltd->log_tbl[i] = 0;
@@ -672,7 +695,7 @@ int gf_w16_log_init(gf_t *gf)
 
   b = 1;
   for (i = 0; i < GF_MULT_GROUP_SIZE; i++) {
-      if (ltd->log_tbl[b] != 0) check = 1;
+      if (ltd->log_tbl[b] != 0) return 0;
       ltd->log_tbl[b] = i;
       ltd->antilog_tbl[i] = b;
       ltd->antilog_tbl[i+GF_MULT_GROUP_SIZE] = b;
@@ -681,12 +704,31 @@ int gf_w16_log_init(gf_t *gf)
           b = b ^ h->prim_poly;
       }
   }
+  return 1;
+}
+
+/* The log tables for the default polynomial are compiled into the library.
+   Those for other polynomials are shared by every gf_t with the same one.
+   With GF_REGION_ONLY, the shared tables leave out the inverse table, and
+   inverse() divides instead. */
+
+static
+int gf_w16_log_init(gf_t *gf)
+{
+  gf_internal_t *h;
+
+  h = (gf_internal_t *) gf->scratch;
 
   /* If you can't construct the log table, there's a problem.  This code is used for
      some other implementations (e.g. in SPLIT), so if the log table doesn't work in 
      that instance, use CARRY_FREE / SHIFT instead. */
 
-  if (check) {
+  if (h->prim_poly == 0x1100b) {
+    h->private = (void *) &gf_w16_default_log_tables;
+  } else if (!gf_share_tables(gf, (h->region_only) ?
+                                   offsetof(struct gf_w16_logtable_data, inv_tbl) :
+                                   sizeof(struct gf_w16_logtable_data),
+                               gf_w16_log_build)) {
     if (h->mult_type != GF_MULT_LOG_TABLE) {
 
 #if defined(INTEL_SSE4_PCLMUL)
@@ -699,13 +741,7 @@ int gf_w16_log_init(gf_t *gf)
     }
   }
 
-  ltd->inv_tbl[0] = 0;  /* Not really, but we need to fill it with something  */
-  ltd->inv_tbl[1] = 1;
-  for (i = 2; i < GF_FIELD_SIZE; i++) {
-    ltd->inv_tbl[i] = ltd->antilog_tbl[GF_MULT_GROUP_SIZE-ltd->log_tbl[i]];
-  }
-
-  gf->inverse.w32 = gf_w16_log_inverse;
+  gf->inverse.w32 = (h->region_only && h->shared != NULL) ? NULL : gf_w16_log_inverse;
   gf->divide.w32 = gf_w16_log_divide;
   gf->multiply.w32 = gf_w16_log_multiply;
   gf->multiply_region.w32 = gf_w16_log_multiply_region;
@@ -907,12 +943,26 @@ gf_w16_split_8_16_lazy_multiply_region(gf_t *gf, void *src, void *dest, gf_val_3
   gf_do_final_region_alignment(&rd);
 }
 
+/* basis[j] = a * x^j, the basis of the table of a times every value. */
+
+static
+void gf_w16_basis(gf_t *gf, uint32_t a, uint16_t *basis)
+{
+  gf_internal_t *h;
+  int j;
+
+  h = (gf_internal_t *) gf->scratch;
+  for (j = 0; j < GF_FIELD_WIDTH; j++) {
+    basis[j] = a;
+    a = GF_MULTBY_TWO(a);
+  }
+}
+
 static void
 gf_w16_table_lazy_multiply_region(gf_t *gf, void *src, void *dest, gf_val_32_t val, int bytes, int xor)
 {
-  uint64_t c;
-  gf_internal_t *h;
-  struct gf_w16_lazytable_data *ltd;
+  uint16_t basis[GF_FIELD_WIDTH];
+  uint16_t *lazytable;
   gf_region_data rd;
 
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
@@ -921,30 +971,14 @@ gf_w16_table_lazy_multiply_region(gf_t *gf, void *src, void *dest, gf_val_32_t v
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 8);
   gf_do_initial_region_alignment(&rd);
 
-  h = (gf_internal_t *) gf->scratch;
-  ltd = (struct gf_w16_lazytable_data *) h->private;
+  /* The table for val is built in this thread's region context, so that
+     threads sharing the gf_t don't trample each other's tables. */
 
-  ltd->lazytable[0] = 0;
-
-  /*
-  a = val;
-  c = 1;
-  pp = h->prim_poly;
+  lazytable = (uint16_t *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(uint16_t) * GF_FIELD_SIZE, NULL);
+  gf_w16_basis(gf, val, basis);
+  gf_linear_table_16(lazytable, basis, GF_FIELD_WIDTH);
 
-  do {
-    ltd->lazytable[c] = a;
-    c <<= 1;
-    if (c & (1 << GF_FIELD_WIDTH)) c ^= pp;
-    a <<= 1;
-    if (a & (1 << GF_FIELD_WIDTH)) a ^= pp;
-  } while (c != 1);
-  */
-
-  for (c = 1; c < GF_FIELD_SIZE; c++) {
-    ltd->lazytable[c] = gf_w16_shift_multiply(gf, c, val);
-  }
-   
-  gf_two_byte_region_table_multiply(&rd, ltd->lazytable);
+  gf_two_byte_region_table_multiply(&rd, lazytable);
   gf_do_final_region_alignment(&rd);
 }
 
@@ -1211,14 +1245,58 @@ gf_w16_split_8_8_multiply(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
          d8->tables[2][a][b];
 }
 
+/* The 8,8 tables for the default polynomial are compiled into the library.
+   Those for other polynomials are shared by every gf_t with the same one. */
+
+static
+int gf_w16_split_8_8_build(gf_t *gf, void *tables)
+{
+  struct gf_w16_split_8_8_data *d8;
+  uint16_t basis[GF_FIELD_WIDTH], row_basis[GF_FIELD_WIDTH], first[256];
+  int i, exp;
+
+  d8 = (struct gf_w16_split_8_8_data *) tables;
+
+  /* tables[exp][i][j] = i * x^(8*exp) * j.  Column 1, i * x^(8*exp), is
+     spanned by the first eight of the basis of x^(8*exp), and row i by the
+     first eight of the basis of its entry in column 1. */
+
+  gf_w16_basis(gf, 1, basis);
+  for (exp = 0; exp < 3; exp++) {
+    gf_linear_table_16(first, basis, 8);
+    for (i = 0; i < 256; i++) {
+      gf_w16_basis(gf, first[i], row_basis);
+      gf_linear_table_16(d8->tables[exp][i], row_basis, 8);
+    }
+    gf_w16_basis(gf, basis[8], basis);
+  }
+  return 1;
+}
+
+/* SPLIT and TABLE only use the log tables for multiply() and divide().
+   With GF_REGION_ONLY, and a polynomial whose log tables aren't compiled
+   into the library, they multiply with CARRY_FREE or SHIFT instead, and
+   divide with Euclid's algorithm, so the log tables are never built. */
+
+static
+void gf_w16_scalar_init(gf_t *gf)
+{
+  gf_internal_t *h;
+
+  h = (gf_internal_t *) gf->scratch;
+  if (h->region_only && h->prim_poly != 0x1100b) {
+    if (gf_w16_cfm_init(gf) == 0) gf_w16_shift_init(gf);
+  } else {
+    gf_w16_log_init(gf);
+  }
+}
+
 static 
 int gf_w16_split_init(gf_t *gf)
 {
   gf_internal_t *h;
-  struct gf_w16_split_8_8_data *d8;
-  int i, j, exp, issse3;
+  int issse3;
   int isneon = 0;
-  uint32_t p, basep, tmp;
 
   h = (gf_internal_t *) gf->scratch;
 
@@ -1232,33 +1310,10 @@ int gf_w16_split_init(gf_t *gf)
 #endif
 
   if (h->arg1 == 8 && h->arg2 == 8) {
-    d8 = (struct gf_w16_split_8_8_data *) h->private;
-    basep = 1;
-    for (exp = 0; exp < 3; exp++) {
-      for (j = 0; j < 256; j++) d8->tables[exp][0][j] = 0;
-      for (i = 0; i < 256; i++) d8->tables[exp][i][0] = 0;
-      d8->tables[exp][1][1] = basep;
-      for (i = 2; i < 256; i++) {
-        if (i&1) {
-          p = d8->tables[exp][i^1][1];
-          d8->tables[exp][i][1] = p ^ basep;
-        } else {
-          p = d8->tables[exp][i>>1][1];
-          d8->tables[exp][i][1] = GF_MULTBY_TWO(p);
-        }
-      }
-      for (i = 1; i < 256; i++) {
-        p = d8->tables[exp][i][1];
-        for (j = 1; j < 256; j++) {
-          if (j&1) {
-            d8->tables[exp][i][j] = d8->tables[exp][i][j^1] ^ p;
-          } else {
-            tmp = d8->tables[exp][i][j>>1];
-            d8->tables[exp][i][j] = GF_MULTBY_TWO(tmp);
-          }
-        }
-      }
-      for (i = 0; i < 8; i++) basep = GF_MULTBY_TWO(basep);
+    if (h->prim_poly == 0x1100b) {
+      h->private = (void *) &gf_w16_default_split_8_8_tables;
+    } else if (!gf_share_tables(gf, sizeof(struct gf_w16_split_8_8_data), gf_w16_split_8_8_build)) {
+      return 0;
     }
     gf->multiply.w32 = gf_w16_split_8_8_multiply;
     gf->multiply_region.w32 = gf_w16_split_8_16_lazy_multiply_region;
@@ -1269,7 +1324,7 @@ int gf_w16_split_init(gf_t *gf)
   /* We'll be using LOG for multiplication, unless the pp isn't primitive.
      In that case, we'll be using SHIFT. */
 
-  gf_w16_log_init(gf);
+  gf_w16_scalar_init(gf);
 
   /* Defaults */
 
@@ -1311,7 +1366,7 @@ int gf_w16_split_init(gf_t *gf)
 static 
 int gf_w16_table_init(gf_t *gf)
 {
-  gf_w16_log_init(gf);
+  gf_w16_scalar_init(gf);
 
   gf->multiply_region.w32 = gf_w16_table_lazy_multiply_region; 
   return 1;
@@ -2287,10 +2342,13 @@ int gf_w16_group_init(gf_t *gf)
 
 int gf_w16_scratch_size(int mult_type, int region_type, int divide_type, int arg1, int arg2)
 {
+  /* The LOG, TABLE and SPLIT tables are shared (see gf_share_tables()), so
+     they aren't counted here.  gf_w16_shared_size() counts them. */
+
   switch(mult_type)
   {
     case GF_MULT_TABLE:
-      return sizeof(gf_internal_t) + sizeof(struct gf_w16_lazytable_data) + 64;
+      return sizeof(gf_internal_t);
       break;
     case GF_MULT_BYTWO_p:
     case GF_MULT_BYTWO_b:
@@ -2300,17 +2358,17 @@ int gf_w16_scratch_size(int mult_type, int region_type, int divide_type, int arg
       return sizeof(gf_internal_t) + sizeof(struct gf_w16_zero_logtable_data) + 64;
       break;
     case GF_MULT_LOG_TABLE:
-      return sizeof(gf_internal_t) + sizeof(struct gf_w16_logtable_data) + 64;
+      return sizeof(gf_internal_t);
       break;
     case GF_MULT_DEFAULT:
     case GF_MULT_SPLIT_TABLE: 
       if (arg1 == 8 && arg2 == 8) {
-        return sizeof(gf_internal_t) + sizeof(struct gf_w16_split_8_8_data) + 64;
+        return sizeof(gf_internal_t);
       } else if ((arg1 == 8 && arg2 == 16) || (arg2 == 8 && arg1 == 16)) {
-        return sizeof(gf_internal_t) + sizeof(struct gf_w16_logtable_data) + 64;
+        return sizeof(gf_internal_t);
       } else if (mult_type == GF_MULT_DEFAULT || 
                  (arg1 == 4 && arg2 == 16) || (arg2 == 4 && arg1 == 16)) {
-        return sizeof(gf_internal_t) + sizeof(struct gf_w16_logtable_data) + 64;
+        return sizeof(gf_internal_t);
       }
       return 0;
       break;
@@ -2333,6 +2391,25 @@ int gf_w16_scratch_size(int mult_type, int region_type, int divide_type, int arg
    return 0;
 }
 
+/* The size of the LOG, TABLE and SPLIT tables, which have to fit in scratch
+   memory that the caller supplies. */
+
+int gf_w16_shared_size(int mult_type, int region_type, int arg1, int arg2)
+{
+  switch(mult_type)
+  {
+    case GF_MULT_TABLE:
+    case GF_MULT_LOG_TABLE:
+      return sizeof(struct gf_w16_logtable_data) + 64;
+    case GF_MULT_DEFAULT:
+    case GF_MULT_SPLIT_TABLE: 
+      if (arg1 == 8 && arg2 == 8) return sizeof(struct gf_w16_split_8_8_data) + 64;
+      return sizeof(struct gf_w16_logtable_data) + 64;
+    default:
+      return 0;
+  }
+}
+
 int gf_w16_init(gf_t *gf)
 {
   gf_internal_t *h;
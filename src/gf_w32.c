@@ -662,24 +662,44 @@ int gf_w32_shift_init(gf_t *gf)
   return 1;
 }
 
+/* basis[j] = a * x^j, for j < n. */
+
+static
+void gf_w32_basis(gf_internal_t *h, uint32_t a, uint32_t *basis, int n)
+{
+  int j;
+
+  for (j = 0; j < n; j++) {
+    basis[j] = a;
+    a = GF_MULTBY_TWO(a);
+  }
+}
+
 static
   void
 gf_w32_group_set_shift_tables(uint32_t *shift, uint32_t val, gf_internal_t *h)
 {
-  uint32_t i;
-  uint32_t j;
+  uint32_t basis[GF_FIELD_WIDTH];
 
-  shift[0] = 0;
+  gf_w32_basis(h, val, basis, h->arg1);
+  gf_linear_table_32(shift, basis, h->arg1);
+}
 
-  for (i = 1; i < ((uint32_t)1 << h->arg1); i <<= 1) {
-    for (j = 0; j < i; j++) shift[i|j] = shift[j]^val;
-    if (val & GF_FIRST_BIT) {
-      val <<= 1;
-      val ^= h->prim_poly;
-    } else {
-      val <<= 1;
-    }
-  }
+/* Returns this thread's shift table for val in context "key", building it
+   unless it already holds val (shift[1] is val itself).  The single multiply
+   and the region multiplies use different keys, so that neither rebuilds
+   the other's table. */
+
+static
+uint32_t *gf_w32_group_shift_table(gf_t *gf, int key, uint32_t val)
+{
+  gf_internal_t *h = (gf_internal_t *) gf->scratch;
+  uint32_t *shift;
+  int fresh;
+
+  shift = (uint32_t *) gf_region_context(gf, key, sizeof(uint32_t) * (1 << h->arg1), &fresh);
+  if (fresh || shift[1] != val) gf_w32_group_set_shift_tables(shift, val, h);
+  return shift;
 }
 
   static
@@ -690,7 +710,7 @@ void gf_w32_group_s_equals_r_multiply_region(gf_t *gf, void *src, void *dest, gf
   int bits_left;
   int g_s;
   gf_region_data rd;
-  uint32_t *s32, *d32, *top;
+  uint32_t *s32, *d32, *top, *shift;
   struct gf_w32_group_data *gd;
   gf_internal_t *h = (gf_internal_t *) gf->scratch;
 
@@ -699,7 +719,7 @@ void gf_w32_group_s_equals_r_multiply_region(gf_t *gf, void *src, void *dest, gf
 
   gd = (struct gf_w32_group_data *) h->private;
   g_s = h->arg1;
-  gf_w32_group_set_shift_tables(gd->shift, val, h);
+  shift = gf_w32_group_shift_table(gf, GF_CONTEXT_REGION, val);
 
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 4);
   gf_do_initial_region_alignment(&rd);
@@ -716,7 +736,7 @@ void gf_w32_group_s_equals_r_multiply_region(gf_t *gf, void *src, void *dest, gf
     a32 = *s32;
     ind = a32 >> rs;
     a32 <<= leftover;
-    p = gd->shift[ind];
+    p = shift[ind];
 
     bits_left = rs;
     rs = 32 - g_s;
@@ -726,7 +746,7 @@ void gf_w32_group_s_equals_r_multiply_region(gf_t *gf, void *src, void *dest, gf
       ind = a32 >> rs;
       a32 <<= g_s;
       l = p >> rs;
-      p = (gd->shift[ind] ^ gd->reduce[l] ^ (p << g_s));
+      p = (shift[ind] ^ gd->reduce[l] ^ (p << g_s));
     }
     if (xor) p ^= *d32;
     *d32 = p;
@@ -739,7 +759,7 @@ void gf_w32_group_s_equals_r_multiply_region(gf_t *gf, void *src, void *dest, gf
   static
 void gf_w32_group_multiply_region(gf_t *gf, void *src, void *dest, gf_val_32_t val, int bytes, int xor)
 {
-  uint32_t *s32, *d32, *top;
+  uint32_t *s32, *d32, *top, *shift;
   int i;
   int leftover;
   uint64_t p, l, r;
@@ -754,14 +774,12 @@ void gf_w32_group_multiply_region(gf_t *gf, void *src, void *dest, gf_val_32_t v
   gf_internal_t *h = (gf_internal_t *) gf->scratch;
   g_s = h->arg1;
   g_r = h->arg2;
-  gd = (struct gf_w32_group_data *) h->private;
-  gf_w32_group_set_shift_tables(gd->shift, val, h);
 
   leftover = GF_FIELD_WIDTH % g_s;
   if (leftover == 0) leftover = g_s;
 
   gd = (struct gf_w32_group_data *) h->private;
-  gf_w32_group_set_shift_tables(gd->shift, val, h);
+  shift = gf_w32_group_shift_table(gf, GF_CONTEXT_REGION, val);
 
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 4);
   gf_do_initial_region_alignment(&rd);
@@ -773,21 +791,21 @@ void gf_w32_group_multiply_region(gf_t *gf, void *src, void *dest, gf_val_32_t v
   while (d32 < top) {
     a32 = *s32;
     ind = a32 >> (GF_FIELD_WIDTH - leftover);
-    p = gd->shift[ind];
+    p = shift[ind];
     p <<= g_s;
     a32 <<= leftover;
   
     i = (GF_FIELD_WIDTH - leftover);
     while (i > g_s) {
       ind = a32 >> (GF_FIELD_WIDTH-g_s);
-      p ^= gd->shift[ind];
+      p ^= shift[ind];
       a32 <<= g_s;
       p <<= g_s;
       i -= g_s;
     }
   
     ind = a32 >> (GF_FIELD_WIDTH-g_s);
-    p ^= gd->shift[ind];
+    p ^= shift[ind];
   
     for (i = gd->tshift ; i >= 0; i -= g_r) {
       l = p & (gd->rmask << i);
@@ -810,7 +828,7 @@ gf_val_32_t
 gf_w32_group_s_equals_r_multiply(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
 {
   int leftover, rs;
-  uint32_t p, l, ind, a32;
+  uint32_t p, l, ind, a32, *shift;
   int bits_left;
   int g_s;
 
@@ -819,7 +837,7 @@ gf_w32_group_s_equals_r_multiply(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
   g_s = h->arg1;
 
   gd = (struct gf_w32_group_data *) h->private;
-  gf_w32_group_set_shift_tables(gd->shift, b, h);
+  shift = gf_w32_group_shift_table(gf, GF_CONTEXT_MULTIPLY, b);
 
   leftover = 32 % g_s;
   if (leftover == 0) leftover = g_s;
@@ -828,7 +846,7 @@ gf_w32_group_s_equals_r_multiply(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
   a32 = a;
   ind = a32 >> rs;
   a32 <<= leftover;
-  p = gd->shift[ind];
+  p = shift[ind];
 
   bits_left = rs;
   rs = 32 - g_s;
@@ -838,7 +856,7 @@ gf_w32_group_s_equals_r_multiply(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
     ind = a32 >> rs;
     a32 <<= g_s;
     l = p >> rs;
-    p = (gd->shift[ind] ^ gd->reduce[l] ^ (p << g_s));
+    p = (shift[ind] ^ gd->reduce[l] ^ (p << g_s));
   }
   return p;
 }
@@ -848,45 +866,45 @@ inline
 gf_val_32_t
 gf_w32_group_4_4_multiply(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
 {
-  uint32_t p, l, ind, a32;
+  uint32_t p, l, ind, a32, *shift;
 
   struct gf_w32_group_data *d44;
   gf_internal_t *h = (gf_internal_t *) gf->scratch;
 
   d44 = (struct gf_w32_group_data *) h->private;
-  gf_w32_group_set_shift_tables(d44->shift, b, h);
+  shift = gf_w32_group_shift_table(gf, GF_CONTEXT_MULTIPLY, b);
 
   a32 = a;
   ind = a32 >> 28;
   a32 <<= 4;
-  p = d44->shift[ind];
+  p = shift[ind];
   ind = a32 >> 28;
   a32 <<= 4;
   l = p >> 28;
-  p = (d44->shift[ind] ^ d44->reduce[l] ^ (p << 4));
+  p = (shift[ind] ^ d44->reduce[l] ^ (p << 4));
   ind = a32 >> 28;
   a32 <<= 4;
   l = p >> 28;
-  p = (d44->shift[ind] ^ d44->reduce[l] ^ (p << 4));
+  p = (shift[ind] ^ d44->reduce[l] ^ (p << 4));
   ind = a32 >> 28;
   a32 <<= 4;
   l = p >> 28;
-  p = (d44->shift[ind] ^ d44->reduce[l] ^ (p << 4));
+  p = (shift[ind] ^ d44->reduce[l] ^ (p << 4));
   ind = a32 >> 28;
   a32 <<= 4;
   l = p >> 28;
-  p = (d44->shift[ind] ^ d44->reduce[l] ^ (p << 4));
+  p = (shift[ind] ^ d44->reduce[l] ^ (p << 4));
   ind = a32 >> 28;
   a32 <<= 4;
   l = p >> 28;
-  p = (d44->shift[ind] ^ d44->reduce[l] ^ (p << 4));
+  p = (shift[ind] ^ d44->reduce[l] ^ (p << 4));
   ind = a32 >> 28;
   a32 <<= 4;
   l = p >> 28;
-  p = (d44->shift[ind] ^ d44->reduce[l] ^ (p << 4));
+  p = (shift[ind] ^ d44->reduce[l] ^ (p << 4));
   ind = a32 >> 28;
   l = p >> 28;
-  p = (d44->shift[ind] ^ d44->reduce[l] ^ (p << 4));
+  p = (shift[ind] ^ d44->reduce[l] ^ (p << 4));
   return p;
 }
 
@@ -898,7 +916,7 @@ gf_w32_group_multiply(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
   int i;
   int leftover;
   uint64_t p, l, r;
-  uint32_t a32, ind;
+  uint32_t a32, ind, *shift;
   int g_s, g_r;
   struct gf_w32_group_data *gd;
 
@@ -906,28 +924,28 @@ gf_w32_group_multiply(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
   g_s = h->arg1;
   g_r = h->arg2;
   gd = (struct gf_w32_group_data *) h->private;
-  gf_w32_group_set_shift_tables(gd->shift, b, h);
+  shift = gf_w32_group_shift_table(gf, GF_CONTEXT_MULTIPLY, b);
 
   leftover = GF_FIELD_WIDTH % g_s;
   if (leftover == 0) leftover = g_s;
 
   a32 = a;
   ind = a32 >> (GF_FIELD_WIDTH - leftover);
-  p = gd->shift[ind];
+  p = shift[ind];
   p <<= g_s;
   a32 <<= leftover;
 
   i = (GF_FIELD_WIDTH - leftover);
   while (i > g_s) {
     ind = a32 >> (GF_FIELD_WIDTH-g_s);
-    p ^= gd->shift[ind];
+    p ^= shift[ind];
     a32 <<= g_s;
     p <<= g_s;
     i -= g_s;
   }
 
   ind = a32 >> (GF_FIELD_WIDTH-g_s);
-  p ^= gd->shift[ind];
+  p ^= shift[ind];
 
   for (i = gd->tshift ; i >= 0; i -= g_r) {
     l = p & (gd->rmask << i);
@@ -1442,28 +1460,22 @@ gf_w32_split_8_32_lazy_multiply_region(gf_t *gf, void *src, void *dest, uint32_t
   gf_internal_t *h;
   uint32_t *s32, *d32, *top, p, a, v;
   struct gf_split_8_32_lazy_data *d8;
-  struct gf_w32_split_8_8_data *d88;
   uint32_t *t[4];
-  int i, j, k, change;
-  uint32_t pp;
+  int i, change, fresh;
   gf_region_data rd;
+  uint32_t basis[GF_FIELD_WIDTH];
   
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
   if (val == 1) { gf_multby_one(src, dest, bytes, xor); return; }
 
+  /* The tables for the last val are kept in this thread's region context,
+     for SPLIT 8 32 as well as for SPLIT 8 8. */
+
   h = (gf_internal_t *) gf->scratch;
-  if (h->arg1 == 32 || h->arg2 == 32 || h->mult_type == GF_MULT_DEFAULT) {
-    d8 = (struct gf_split_8_32_lazy_data *) h->private;
-    for (i = 0; i < 4; i++) t[i] = d8->tables[i];
-    change = (val != d8->last_value);
-    if (change) d8->last_value = val;
-  } else {
-    d88 = (struct gf_w32_split_8_8_data *) h->private;
-    for (i = 0; i < 4; i++) t[i] = d88->region_tables[i];
-    change = (val != d88->last_value);
-    if (change) d88->last_value = val;
-  }
-  pp = h->prim_poly;
+  d8 = (struct gf_split_8_32_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_8_32_lazy_data), &fresh);
+  for (i = 0; i < 4; i++) t[i] = d8->tables[i];
+  change = (fresh || val != d8->last_value);
+  if (change) d8->last_value = val;
 
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 4);
   gf_do_initial_region_alignment(&rd);
@@ -1473,16 +1485,8 @@ gf_w32_split_8_32_lazy_multiply_region(gf_t *gf, void *src, void *dest, uint32_t
   top = (uint32_t *) rd.d_top;
   
   if (change) {
-    v = val;
-    for (i = 0; i < 4; i++) {
-      t[i][0] = 0;
-      for (j = 1; j < 256; j <<= 1) {
-        for (k = 0; k < j; k++) {
-          t[i][k^j] = (v ^ t[i][k]);
-        }
-        v = (v & GF_FIRST_BIT) ? ((v << 1) ^ pp) : (v << 1);
-      }
-    }
+    gf_w32_basis(h, val, basis, GF_FIELD_WIDTH);
+    for (i = 0; i < 4; i++) gf_linear_table_32(t[i], basis + 8*i, 8);
   } 
 
   while (d32 < top) {
@@ -1511,20 +1515,19 @@ gf_w32_split_16_32_lazy_multiply_region(gf_t *gf, void *src, void *dest, uint32_
   uint32_t *s32, *d32, *top, p, a, v;
   struct gf_split_16_32_lazy_data *d16;
   uint32_t *t[2];
-  int i, j, k, change;
-  uint32_t pp;
+  int i, change, fresh;
   gf_region_data rd;
+  uint32_t basis[GF_FIELD_WIDTH];
   
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
   if (val == 1) { gf_multby_one(src, dest, bytes, xor); return; }
 
   h = (gf_internal_t *) gf->scratch;
-  d16 = (struct gf_split_16_32_lazy_data *) h->private;
+  d16 = (struct gf_split_16_32_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_16_32_lazy_data), &fresh);
   for (i = 0; i < 2; i++) t[i] = d16->tables[i];
-  change = (val != d16->last_value);
+  change = (fresh || val != d16->last_value);
   if (change) d16->last_value = val;
 
-  pp = h->prim_poly;
 
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 4);
   gf_do_initial_region_alignment(&rd);
@@ -1534,16 +1537,8 @@ gf_w32_split_16_32_lazy_multiply_region(gf_t *gf, void *src, void *dest, uint32_
   top = (uint32_t *) rd.d_top;
   
   if (change) {
-    v = val;
-    for (i = 0; i < 2; i++) {
-      t[i][0] = 0;
-      for (j = 1; j < (1 << 16); j <<= 1) {
-        for (k = 0; k < j; k++) {
-          t[i][k^j] = (v ^ t[i][k]);
-        }
-        v = (v & GF_FIRST_BIT) ? ((v << 1) ^ pp) : (v << 1);
-      }
-    }
+    gf_w32_basis(h, val, basis, GF_FIELD_WIDTH);
+    for (i = 0; i < 2; i++) gf_linear_table_32(t[i], basis + 16*i, 16);
   } 
 
   while (d32 < top) {
@@ -1569,7 +1564,7 @@ gf_w32_split_2_32_lazy_multiply_region(gf_t *gf, void *src, void *dest, uint32_t
 {
   gf_internal_t *h;
   struct gf_split_2_32_lazy_data *ld;
-  int i;
+  int i, fresh;
   uint32_t pp, v, v2, s, *s32, *d32, *top;
   gf_region_data rd;
  
@@ -1582,9 +1577,9 @@ gf_w32_split_2_32_lazy_multiply_region(gf_t *gf, void *src, void *dest, uint32_t
   h = (gf_internal_t *) gf->scratch;
   pp = h->prim_poly;
 
-  ld = (struct gf_split_2_32_lazy_data *) h->private;
+  ld = (struct gf_split_2_32_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_2_32_lazy_data), &fresh);
   
-  if (ld->last_value != val) {
+  if (fresh || ld->last_value != val) {
     v = val;
     for (i = 0; i < 16; i++) {
       v2 = (v << 1);
@@ -1706,32 +1701,24 @@ gf_w32_split_4_32_lazy_multiply_region(gf_t *gf, void *src, void *dest, uint32_t
 {
   gf_internal_t *h;
   struct gf_split_4_32_lazy_data *ld;
-  int i, j, k;
-  uint32_t pp, v, s, *s32, *d32, *top;
+  int i, fresh;
+  uint32_t v, s, *s32, *d32, *top;
   gf_region_data rd;
+  uint32_t basis[GF_FIELD_WIDTH];
  
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
   if (val == 1) { gf_multby_one(src, dest, bytes, xor); return; }
 
   h = (gf_internal_t *) gf->scratch;
-  pp = h->prim_poly;
 
-  ld = (struct gf_split_4_32_lazy_data *) h->private;
+  ld = (struct gf_split_4_32_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_4_32_lazy_data), &fresh);
 
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 4);
   gf_do_initial_region_alignment(&rd);
   
-  if (ld->last_value != val) {
-    v = val;
-    for (i = 0; i < 8; i++) {
-      ld->tables[i][0] = 0;
-      for (j = 1; j < 16; j <<= 1) {
-        for (k = 0; k < j; k++) {
-          ld->tables[i][k^j] = (v ^ ld->tables[i][k]);
-        }
-        v = (v & GF_FIRST_BIT) ? ((v << 1) ^ pp) : (v << 1);
-      }
-    }
+  if (fresh || ld->last_value != val) {
+    gf_w32_basis(h, val, basis, GF_FIELD_WIDTH);
+    for (i = 0; i < 8; i++) gf_linear_table_32(ld->tables[i], basis + 4*i, 4);
   }
   ld->last_value = val;
 
@@ -1762,17 +1749,17 @@ gf_w32_split_4_32_lazy_sse_altmap_multiply_region(gf_t *gf, void *src, void *des
 #ifdef INTEL_SSSE3
   gf_internal_t *h;
   int i, j, k;
-  uint32_t pp, v, *s32, *d32, *top;
+  uint32_t *s32, *d32, *top;
   __m128i si, tables[8][4], p0, p1, p2, p3, mask1, v0, v1, v2, v3;
   struct gf_split_4_32_lazy_data *ld;
   uint8_t btable[16];
   gf_region_data rd;
+  uint32_t basis[GF_FIELD_WIDTH];
  
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
   if (val == 1) { gf_multby_one(src, dest, bytes, xor); return; }
 
   h = (gf_internal_t *) gf->scratch;
-  pp = h->prim_poly;
   
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 64);
   gf_do_initial_region_alignment(&rd);
@@ -1781,17 +1768,11 @@ gf_w32_split_4_32_lazy_sse_altmap_multiply_region(gf_t *gf, void *src, void *des
   d32 = (uint32_t *) rd.d_start;
   top = (uint32_t *) rd.d_top;
   
-  ld = (struct gf_split_4_32_lazy_data *) h->private;
+  ld = (struct gf_split_4_32_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_4_32_lazy_data), NULL);
  
-  v = val;
+  gf_w32_basis(h, val, basis, GF_FIELD_WIDTH);
   for (i = 0; i < 8; i++) {
-    ld->tables[i][0] = 0;
-    for (j = 1; j < 16; j <<= 1) {
-      for (k = 0; k < j; k++) {
-        ld->tables[i][k^j] = (v ^ ld->tables[i][k]);
-      }
-      v = (v & GF_FIRST_BIT) ? ((v << 1) ^ pp) : (v << 1);
-    }
+    gf_linear_table_32(ld->tables[i], basis + 4*i, 4);
     for (j = 0; j < 4; j++) {
       for (k = 0; k < 16; k++) {
         btable[k] = (uint8_t) ld->tables[i][k];
@@ -1954,17 +1935,17 @@ gf_w32_split_4_32_lazy_sse_multiply_region(gf_t *gf, void *src, void *dest, uint
 #ifdef INTEL_SSSE3
   gf_internal_t *h;
   int i, j, k;
-  uint32_t pp, v, *s32, *d32, *top, tmp_table[16];
+  uint32_t *s32, *d32, *top, tmp_table[16];
   __m128i si, tables[8][4], p0, p1, p2, p3, mask1, v0, v1, v2, v3, mask8;
   __m128i tv1, tv2, tv3, tv0;
   uint8_t btable[16];
   gf_region_data rd;
+  uint32_t basis[GF_FIELD_WIDTH];
 
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
   if (val == 1) { gf_multby_one(src, dest, bytes, xor); return; }
 
   h = (gf_internal_t *) gf->scratch;
-  pp = h->prim_poly;
   
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 64);
   gf_do_initial_region_alignment(&rd);
@@ -1973,15 +1954,9 @@ gf_w32_split_4_32_lazy_sse_multiply_region(gf_t *gf, void *src, void *dest, uint
   d32 = (uint32_t *) rd.d_start;
   top = (uint32_t *) rd.d_top;
 
-  v = val;
+  gf_w32_basis(h, val, basis, GF_FIELD_WIDTH);
   for (i = 0; i < 8; i++) {
-    tmp_table[0] = 0;
-    for (j = 1; j < 16; j <<= 1) {
-      for (k = 0; k < j; k++) {
-        tmp_table[k^j] = (v ^ tmp_table[k]);
-      }
-      v = (v & GF_FIRST_BIT) ? ((v << 1) ^ pp) : (v << 1);
-    }
+    gf_linear_table_32(tmp_table, basis + 4*i, 4);
     for (j = 0; j < 4; j++) {
       for (k = 0; k < 16; k++) {
         btable[k] = (uint8_t) tmp_table[k];
@@ -2224,13 +2199,9 @@ static
 int gf_w32_split_init(gf_t *gf)
 {
   gf_internal_t *h;
-  struct gf_split_2_32_lazy_data *ld2;
-  struct gf_split_4_32_lazy_data *ld4;
   struct gf_w32_split_8_8_data *d8;
-  struct gf_split_8_32_lazy_data *d32;
-  struct gf_split_16_32_lazy_data *d16;
-  uint32_t p, basep;
-  int i, j, exp, ispclmul, issse3;
+  uint32_t basis[9], row_basis[8], first[256];
+  int i, exp, ispclmul, issse3;
   int isneon = 0;
 
 #if defined(INTEL_SSE4_PCLMUL)
@@ -2277,15 +2248,11 @@ int gf_w32_split_init(gf_t *gf)
   /* Easy cases: 16/32 and 2/32 */
 
   if ((h->arg1 == 16 && h->arg2 == 32) || (h->arg1 == 32 && h->arg2 == 16)) {
-    d16 = (struct gf_split_16_32_lazy_data *) h->private;
-    d16->last_value = 0;
     gf->multiply_region.w32 = gf_w32_split_16_32_lazy_multiply_region;
     return 1;
   }
 
   if ((h->arg1 == 2 && h->arg2 == 32) || (h->arg1 == 32 && h->arg2 == 2)) {
-    ld2 = (struct gf_split_2_32_lazy_data *) h->private;
-    ld2->last_value = 0;
     #ifdef INTEL_SSSE3
       if (!(h->region_type & GF_REGION_NOSIMD))
         gf->multiply_region.w32 = gf_w32_split_2_32_lazy_sse_multiply_region;
@@ -2302,8 +2269,6 @@ int gf_w32_split_init(gf_t *gf)
 
   if ((h->arg1 == 4 && h->arg2 == 32) || (h->arg1 == 32 && h->arg2 == 4) ||
       ((issse3 || isneon) && h->mult_type == GF_REGION_DEFAULT)) {
-    ld4 = (struct gf_split_4_32_lazy_data *) h->private;
-    ld4->last_value = 0;
     if ((h->region_type & GF_REGION_NOSIMD) || !(issse3 || isneon)) {
       gf->multiply_region.w32 = gf_w32_split_4_32_lazy_multiply_region;
     } else if (isneon) {
@@ -2322,8 +2287,6 @@ int gf_w32_split_init(gf_t *gf)
 
   if ((h->arg1 == 8 && h->arg2 == 32) || (h->arg1 == 32 && h->arg2 == 8) || 
        h->mult_type == GF_MULT_DEFAULT) {
-    d32 = (struct gf_split_8_32_lazy_data *) h->private;
-    d32->last_value = 0;
     gf->multiply_region.w32 = gf_w32_split_8_32_lazy_multiply_region;
     return 1;
   }
@@ -2332,34 +2295,21 @@ int gf_w32_split_init(gf_t *gf)
 
   if (h->arg1 == 8 && h->arg2 == 8) {
     d8 = (struct gf_w32_split_8_8_data *) h->private;
-    d8->last_value = 0;
     gf->multiply.w32 = gf_w32_split_8_8_multiply;
     gf->multiply_region.w32 = gf_w32_split_8_32_lazy_multiply_region;
-    basep = 1;
+
+    /* tables[exp][i][j] = i * x^(8*exp) * j.  Column 1 is spanned by the
+       first eight of the basis of x^(8*exp), and row i by the first eight
+       of the basis of its entry in column 1. */
+
+    gf_w32_basis(h, 1, basis, 9);
     for (exp = 0; exp < 7; exp++) {
-      for (j = 0; j < 256; j++) d8->tables[exp][0][j] = 0;
-      for (i = 0; i < 256; i++) d8->tables[exp][i][0] = 0;
-      d8->tables[exp][1][1] = basep;
-      for (i = 2; i < 256; i++) {
-        if (i&1) {
-          p = d8->tables[exp][i^1][1];
-          d8->tables[exp][i][1] = p ^ basep;
-        } else {
-          p = d8->tables[exp][i>>1][1];
-          d8->tables[exp][i][1] = GF_MULTBY_TWO(p);
-        }
+      gf_linear_table_32(first, basis, 8);
+      for (i = 0; i < 256; i++) {
+        gf_w32_basis(h, first[i], row_basis, 8);
+        gf_linear_table_32(d8->tables[exp][i], row_basis, 8);
       }
-      for (i = 1; i < 256; i++) {
-        p = d8->tables[exp][i][1];
-        for (j = 1; j < 256; j++) {
-          if (j&1) {
-            d8->tables[exp][i][j] = d8->tables[exp][i][j^1] ^ p;
-          } else {
-            d8->tables[exp][i][j] = GF_MULTBY_TWO(d8->tables[exp][i][j>>1]);
-          }
-        }
-      }
-      for (i = 0; i < 8; i++) basep = GF_MULTBY_TWO(basep);
+      gf_w32_basis(h, basis[8], basis, 9);
     }
     return 1;
   }
@@ -2372,7 +2322,7 @@ int gf_w32_split_init(gf_t *gf)
 static
 int gf_w32_group_init(gf_t *gf)
 {
-  uint32_t i, j, p, index;
+  uint32_t i, j, index, basis[GF_FIELD_WIDTH];
   struct gf_w32_group_data *gd;
   gf_internal_t *h = (gf_internal_t *) gf->scratch;
   uint32_t g_r, g_s;
@@ -2381,8 +2331,6 @@ int gf_w32_group_init(gf_t *gf)
   g_r = h->arg2;
 
   gd = (struct gf_w32_group_data *) h->private;
-  gd->shift = (uint32_t *) (&(gd->memory));
-  gd->reduce = gd->shift + (1 << g_s);
 
   gd->rmask = (1 << g_r) - 1;
   gd->rmask <<= 32;
@@ -2392,18 +2340,27 @@ int gf_w32_group_init(gf_t *gf)
   gd->tshift = (32 - gd->tshift);
   gd->tshift = ((gd->tshift-1)/g_r) * g_r;
 
-  gd->reduce[0] = 0;
-  for (i = 0; i < ((uint32_t)1 << g_r); i++) {
-    p = 0;
-    index = 0;
+  /* The reduction table for the default polynomial and g_r = 8 is compiled
+     into the library. */
+
+  if (h->prim_poly == 0x400007 && g_r == 8) {
+    gd->reduce = (uint32_t *) gf_w32_default_group_reduce;
+  } else {
+
+    /* The reduction table is linear in its index.  Clearing bit j above the
+       word takes prim_poly << j, which also flips the bits of
+       prim_poly >> (32-j), all below j, so the entry for bit j alone is
+       prim_poly << j plus the entries that clear those again. */
+
+    gd->reduce = (uint32_t *) (&(gd->memory));
     for (j = 0; j < g_r; j++) {
-      if (i & (1 << j)) {
-        p ^= (h->prim_poly << j);
-        index ^= (1 << j);
-        index ^= (h->prim_poly >> (32-j));
+      basis[j] = h->prim_poly << j;
+      index = (j > 0) ? (h->prim_poly >> (32-j)) : 0;
+      for (i = 0; i < j; i++) {
+        if (index & (1 << i)) basis[j] ^= basis[i];
       }
     }
-    gd->reduce[index] = p;
+    gf_linear_table_32(gd->reduce, basis, g_r);
   }
 
   if (g_s == g_r) {
@@ -2686,16 +2643,6 @@ int gf_w32_composite_init(gf_t *gf)
 
 int gf_w32_scratch_size(int mult_type, int region_type, int divide_type, int arg1, int arg2)
 {
-  int issse3 = 0;
-  int isneon = 0;
-
-#ifdef INTEL_SSSE3
-  issse3 = 1;
-#endif
-#ifdef ARM_NEON
-  isneon = 1;
-#endif
-
   switch(mult_type)
   {
     case GF_MULT_BYTWO_p:
@@ -2704,7 +2651,6 @@ int gf_w32_scratch_size(int mult_type, int region_type, int divide_type, int arg
       break;
     case GF_MULT_GROUP: 
       return sizeof(gf_internal_t) + sizeof(struct gf_w32_group_data) +
-               sizeof(uint32_t) * (1 << arg1) +
                sizeof(uint32_t) * (1 << arg2) + 64;
       break;
     case GF_MULT_DEFAULT:
@@ -2713,20 +2659,14 @@ int gf_w32_scratch_size(int mult_type, int region_type, int divide_type, int arg
         if (arg1 == 8 && arg2 == 8){
           return sizeof(gf_internal_t) + sizeof(struct gf_w32_split_8_8_data) + 64;
         }
-        if ((arg1 == 16 && arg2 == 32) || (arg2 == 16 && arg1 == 32)) {
-          return sizeof(gf_internal_t) + sizeof(struct gf_split_16_32_lazy_data) + 64;
-        }
-        if ((arg1 == 2 && arg2 == 32) || (arg2 == 2 && arg1 == 32)) {
-          return sizeof(gf_internal_t) + sizeof(struct gf_split_2_32_lazy_data) + 64;
-        }
-        if ((arg1 == 8 && arg2 == 32) || (arg2 == 8 && arg1 == 32) || 
-             (mult_type == GF_MULT_DEFAULT && !(issse3 || isneon))) {
-          return sizeof(gf_internal_t) + sizeof(struct gf_split_8_32_lazy_data) + 64;
-        }
-        if ((arg1 == 4 && arg2 == 32) || 
-            (arg2 == 4 && arg1 == 32) ||
+        /* The lazy region tables live in the per-thread region context. */
+
+        if ((arg1 == 16 && arg2 == 32) || (arg2 == 16 && arg1 == 32) ||
+            (arg1 == 2 && arg2 == 32) || (arg2 == 2 && arg1 == 32) ||
+            (arg1 == 8 && arg2 == 32) || (arg2 == 8 && arg1 == 32) ||
+            (arg1 == 4 && arg2 == 32) || (arg2 == 4 && arg1 == 32) ||
             mult_type == GF_MULT_DEFAULT) {
-          return sizeof(gf_internal_t) + sizeof(struct gf_split_4_32_lazy_data) + 64;
+          return sizeof(gf_internal_t) + 64;
         }
         return 0;
     case GF_MULT_CARRY_FREE:
@@ -619,7 +619,7 @@ gf_w4_quad_table_multiply_region(gf_t *gf, void *src, void *dest, gf_val_32_t va
   h = (gf_internal_t *) (gf->scratch);
   if (h->region_type & GF_REGION_LAZY) {
     ltd = (struct gf_quad_table_lazy_data *) ((gf_internal_t *) (gf->scratch))->private;
-    base = ltd->mult;
+    base = (uint16_t *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(uint16_t) * (1 << 16), NULL);
     for (a = 0; a < 16; a++) {
       va = (ltd->smult[val][a] << 12);
       for (b = 0; b < 16; b++) {
@@ -507,37 +507,47 @@ gf_w64_clm_multiply_region(gf_t *gf, void *src, void *dest, uint64_t val, int by
 #endif
 }
 
+/* basis[j] = a * x^j, for j < n. */
+
+static
+void gf_w64_basis(gf_internal_t *h, uint64_t a, uint64_t *basis, int n)
+{
+  int j;
+
+  for (j = 0; j < n; j++) {
+    basis[j] = a;
+    if (a & GF_FIRST_BIT) {
+      a <<= 1;
+      a ^= h->prim_poly;
+    } else {
+      a <<= 1;
+    }
+  }
+}
+
 void
 gf_w64_split_4_64_lazy_multiply_region(gf_t *gf, void *src, void *dest, uint64_t val, int bytes, int xor)
 {
   gf_internal_t *h;
   struct gf_split_4_64_lazy_data *ld;
-  int i, j, k;
-  uint64_t pp, v, s, *s64, *d64, *top;
+  int i, fresh;
+  uint64_t v, s, *s64, *d64, *top;
   gf_region_data rd;
+  uint64_t basis[GF_FIELD_WIDTH];
 
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
   if (val == 1) { gf_multby_one(src, dest, bytes, xor); return; }
 
   h = (gf_internal_t *) gf->scratch;
-  pp = h->prim_poly;
 
-  ld = (struct gf_split_4_64_lazy_data *) h->private;
+  ld = (struct gf_split_4_64_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_4_64_lazy_data), &fresh);
 
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 8);
   gf_do_initial_region_alignment(&rd);
 
-  if (ld->last_value != val) {
-    v = val;
-    for (i = 0; i < 16; i++) {
-      ld->tables[i][0] = 0;
-      for (j = 1; j < 16; j <<= 1) {
-        for (k = 0; k < j; k++) {
-          ld->tables[i][k^j] = (v ^ ld->tables[i][k]);
-        }
-        v = (v & GF_FIRST_BIT) ? ((v << 1) ^ pp) : (v << 1);
-      }
-    }
+  if (fresh || ld->last_value != val) {
+    gf_w64_basis(h, val, basis, GF_FIELD_WIDTH);
+    for (i = 0; i < 16; i++) gf_linear_table_64(ld->tables[i], basis + 4*i, 4);
   }
   ld->last_value = val;
 
@@ -591,32 +601,24 @@ gf_w64_split_8_64_lazy_multiply_region(gf_t *gf, void *src, void *dest, uint64_t
 {
   gf_internal_t *h;
   struct gf_split_8_64_lazy_data *ld;
-  int i, j, k;
-  uint64_t pp, v, s, *s64, *d64, *top;
+  int i, fresh;
+  uint64_t v, s, *s64, *d64, *top;
   gf_region_data rd;
+  uint64_t basis[GF_FIELD_WIDTH];
 
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
   if (val == 1) { gf_multby_one(src, dest, bytes, xor); return; }
 
   h = (gf_internal_t *) gf->scratch;
-  pp = h->prim_poly;
 
-  ld = (struct gf_split_8_64_lazy_data *) h->private;
+  ld = (struct gf_split_8_64_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_8_64_lazy_data), &fresh);
 
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 4);
   gf_do_initial_region_alignment(&rd);
 
-  if (ld->last_value != val) {
-    v = val;
-    for (i = 0; i < 8; i++) {
-      ld->tables[i][0] = 0;
-      for (j = 1; j < 256; j <<= 1) {
-        for (k = 0; k < j; k++) {
-          ld->tables[i][k^j] = (v ^ ld->tables[i][k]);
-        }
-        v = (v & GF_FIRST_BIT) ? ((v << 1) ^ pp) : (v << 1);
-      }
-    }
+  if (fresh || ld->last_value != val) {
+    gf_w64_basis(h, val, basis, GF_FIELD_WIDTH);
+    for (i = 0; i < 8; i++) gf_linear_table_64(ld->tables[i], basis + 8*i, 8);
   }
   ld->last_value = val;
 
@@ -645,32 +647,24 @@ gf_w64_split_16_64_lazy_multiply_region(gf_t *gf, void *src, void *dest, uint64_
 {
   gf_internal_t *h;
   struct gf_split_16_64_lazy_data *ld;
-  int i, j, k;
-  uint64_t pp, v, s, *s64, *d64, *top;
+  int i, fresh;
+  uint64_t v, s, *s64, *d64, *top;
   gf_region_data rd;
+  uint64_t basis[GF_FIELD_WIDTH];
 
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
   if (val == 1) { gf_multby_one(src, dest, bytes, xor); return; }
 
   h = (gf_internal_t *) gf->scratch;
-  pp = h->prim_poly;
 
-  ld = (struct gf_split_16_64_lazy_data *) h->private;
+  ld = (struct gf_split_16_64_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_16_64_lazy_data), &fresh);
 
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 4);
   gf_do_initial_region_alignment(&rd);
 
-  if (ld->last_value != val) {
-    v = val;
-    for (i = 0; i < 4; i++) {
-      ld->tables[i][0] = 0;
-      for (j = 1; j < (1<<16); j <<= 1) {
-        for (k = 0; k < j; k++) {
-          ld->tables[i][k^j] = (v ^ ld->tables[i][k]);
-        }
-        v = (v & GF_FIRST_BIT) ? ((v << 1) ^ pp) : (v << 1);
-      }
-    }
+  if (fresh || ld->last_value != val) {
+    gf_w64_basis(h, val, basis, GF_FIELD_WIDTH);
+    for (i = 0; i < 4; i++) gf_linear_table_64(ld->tables[i], basis + 16*i, 16);
   }
   ld->last_value = val;
 
@@ -733,23 +727,27 @@ static
 void
 gf_w64_group_set_shift_tables(uint64_t *shift, uint64_t val, gf_internal_t *h)
 {
-  uint64_t i;
-  uint64_t j;
-  uint64_t one = 1;
-  int g_s;
+  uint64_t basis[GF_FIELD_WIDTH];
 
-  g_s = h->arg1;
-  shift[0] = 0;
- 
-  for (i = 1; i < ((uint64_t)1 << g_s); i <<= 1) {
-    for (j = 0; j < i; j++) shift[i|j] = shift[j]^val;
-    if (val & (one << 63)) {
-      val <<= 1;
-      val ^= h->prim_poly;
-    } else {
-      val <<= 1;
-    }
-  }
+  gf_w64_basis(h, val, basis, h->arg1);
+  gf_linear_table_64(shift, basis, h->arg1);
+}
+
+/* Returns this thread's shift table for val in context "key", building it
+   unless it already holds val (shift[1] is val itself).  The single multiply
+   and the region multiplies use different keys, so that neither rebuilds
+   the other's table. */
+
+static
+uint64_t *gf_w64_group_shift_table(gf_t *gf, int key, uint64_t val)
+{
+  gf_internal_t *h = (gf_internal_t *) gf->scratch;
+  uint64_t *shift;
+  int fresh;
+
+  shift = (uint64_t *) gf_region_context(gf, key, sizeof(uint64_t) * (1 << h->arg1), &fresh);
+  if (fresh || shift[1] != val) gf_w64_group_set_shift_tables(shift, val, h);
+  return shift;
 }
 
 static
@@ -760,16 +758,17 @@ gf_w64_group_multiply(gf_t *gf, gf_val_64_t a, gf_val_64_t b)
   uint64_t top, bot, mask, tp;
   int g_s, g_r, lshift, rshift;
   struct gf_w64_group_data *gd;
+  uint64_t *shift;
 
   gf_internal_t *h = (gf_internal_t *) gf->scratch;
   g_s = h->arg1;
   g_r = h->arg2;
   gd = (struct gf_w64_group_data *) h->private;
-  gf_w64_group_set_shift_tables(gd->shift, b, h);
+  shift = gf_w64_group_shift_table(gf, GF_CONTEXT_MULTIPLY, b);
 
   mask = (((uint64_t)1 << g_s) - 1);
   top = 0;
-  bot = gd->shift[a&mask];
+  bot = shift[a&mask];
   a >>= g_s; 
 
   if (a == 0) return bot;
@@ -779,7 +778,7 @@ gf_w64_group_multiply(gf_t *gf, gf_val_64_t a, gf_val_64_t b)
   do {              /* Shifting out is straightfoward */
     lshift += g_s;
     rshift -= g_s;
-    tp = gd->shift[a&mask];
+    tp = shift[a&mask];
     top ^= (tp >> rshift);
     bot ^= (tp << lshift);
     a >>= g_s; 
@@ -812,6 +811,7 @@ void gf_w64_group_multiply_region(gf_t *gf, void *src, void *dest, gf_val_64_t v
   gf_region_data rd;
   uint64_t *s64, *d64, *dtop;
   struct gf_w64_group_data *gd;
+  uint64_t *shift;
   gf_internal_t *h = (gf_internal_t *) gf->scratch;
 
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
@@ -820,13 +820,13 @@ void gf_w64_group_multiply_region(gf_t *gf, void *src, void *dest, gf_val_64_t v
   gd = (struct gf_w64_group_data *) h->private;
   g_s = h->arg1;
   g_r = h->arg2;
-  gf_w64_group_set_shift_tables(gd->shift, val, h);
+  shift = gf_w64_group_shift_table(gf, GF_CONTEXT_REGION, val);
 
   for (i = 63; !(val & (1ULL << i)); i--) ;
   i += g_s;
   
   /* i is the bit position of the first zero bit in any element of
-                           gd->shift[] */
+                           shift[] */
   
   if (i > 64) i = 64;   
   
@@ -847,7 +847,7 @@ void gf_w64_group_multiply_region(gf_t *gf, void *src, void *dest, gf_val_64_t v
     a64 = *s64;
     
     top = 0;
-    bot = gd->shift[a64&smask];
+    bot = shift[a64&smask];
     a64 >>= g_s;
     i = fzb;
 
@@ -858,7 +858,7 @@ void gf_w64_group_multiply_region(gf_t *gf, void *src, void *dest, gf_val_64_t v
       do {  
         lshift += g_s;
         rshift -= g_s;
-        tp = gd->shift[a64&smask];
+        tp = shift[a64&smask];
         top ^= (tp >> rshift);
         bot ^= (tp << lshift);
         a64 >>= g_s;
@@ -895,11 +895,12 @@ gf_w64_group_s_equals_r_multiply(gf_t *gf, gf_val_64_t a, gf_val_64_t b)
   int g_s;
 
   struct gf_w64_group_data *gd;
+  uint64_t *shift;
   gf_internal_t *h = (gf_internal_t *) gf->scratch;
   g_s = h->arg1;
 
   gd = (struct gf_w64_group_data *) h->private;
-  gf_w64_group_set_shift_tables(gd->shift, b, h);
+  shift = gf_w64_group_shift_table(gf, GF_CONTEXT_MULTIPLY, b);
 
   leftover = 64 % g_s;
   if (leftover == 0) leftover = g_s;
@@ -908,7 +909,7 @@ gf_w64_group_s_equals_r_multiply(gf_t *gf, gf_val_64_t a, gf_val_64_t b)
   a64 = a;
   ind = a64 >> rs;
   a64 <<= leftover;
-  p = gd->shift[ind];
+  p = shift[ind];
 
   bits_left = rs;
   rs = 64 - g_s;
@@ -918,7 +919,7 @@ gf_w64_group_s_equals_r_multiply(gf_t *gf, gf_val_64_t a, gf_val_64_t b)
     ind = a64 >> rs;
     a64 <<= g_s;
     l = p >> rs;
-    p = (gd->shift[ind] ^ gd->reduce[l] ^ (p << g_s));
+    p = (shift[ind] ^ gd->reduce[l] ^ (p << g_s));
   }
   return p;
 }
@@ -933,6 +934,7 @@ void gf_w64_group_s_equals_r_multiply_region(gf_t *gf, void *src, void *dest, gf
   gf_region_data rd;
   uint64_t *s64, *d64, *top;
   struct gf_w64_group_data *gd;
+  uint64_t *shift;
   gf_internal_t *h = (gf_internal_t *) gf->scratch;
 
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
@@ -940,7 +942,7 @@ void gf_w64_group_s_equals_r_multiply_region(gf_t *gf, void *src, void *dest, gf
 
   gd = (struct gf_w64_group_data *) h->private;
   g_s = h->arg1;
-  gf_w64_group_set_shift_tables(gd->shift, val, h);
+  shift = gf_w64_group_shift_table(gf, GF_CONTEXT_REGION, val);
 
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 4);
   gf_do_initial_region_alignment(&rd);
@@ -957,7 +959,7 @@ void gf_w64_group_s_equals_r_multiply_region(gf_t *gf, void *src, void *dest, gf
     a64 = *s64;
     ind = a64 >> rs;
     a64 <<= leftover;
-    p = gd->shift[ind];
+    p = shift[ind];
 
     bits_left = rs;
     rs = 64 - g_s;
@@ -967,7 +969,7 @@ void gf_w64_group_s_equals_r_multiply_region(gf_t *gf, void *src, void *dest, gf
       ind = a64 >> rs;
       a64 <<= g_s;
       l = p >> rs;
-      p = (gd->shift[ind] ^ gd->reduce[l] ^ (p << g_s));
+      p = (shift[ind] ^ gd->reduce[l] ^ (p << g_s));
     }
     if (xor) p ^= *d64;
     *d64 = p;
@@ -981,7 +983,7 @@ void gf_w64_group_s_equals_r_multiply_region(gf_t *gf, void *src, void *dest, gf
 static
 int gf_w64_group_init(gf_t *gf)
 {
-  uint64_t i, j, p, index;
+  uint64_t i, j, index, basis[GF_FIELD_WIDTH];
   struct gf_w64_group_data *gd;
   gf_internal_t *h = (gf_internal_t *) gf->scratch;
   uint64_t g_r, g_s;
@@ -990,22 +992,21 @@ int gf_w64_group_init(gf_t *gf)
   g_r = h->arg2;
 
   gd = (struct gf_w64_group_data *) h->private;
-  gd->shift = (uint64_t *) (&(gd->memory));
-  gd->reduce = gd->shift + (1 << g_s);
-
-  gd->reduce[0] = 0;
-  for (i = 0; i < ((uint64_t)1 << g_r); i++) {
-    p = 0;
-    index = 0;
-    for (j = 0; j < g_r; j++) {
-      if (i & (1 << j)) {
-        p ^= (h->prim_poly << j);
-        index ^= (1 << j);
-        if (j > 0) index ^= (h->prim_poly >> (64-j)); 
-      }
+  gd->reduce = (uint64_t *) (&(gd->memory));
+
+  /* The reduction table is linear in its index.  Clearing bit j above the
+     word takes prim_poly << j, which also flips the bits of
+     prim_poly >> (64-j), all below j, so the entry for bit j alone is
+     prim_poly << j plus the entries that clear those again. */
+
+  for (j = 0; j < g_r; j++) {
+    basis[j] = h->prim_poly << j;
+    index = (j > 0) ? (h->prim_poly >> (64-j)) : 0;
+    for (i = 0; i < j; i++) {
+      if (index & ((uint64_t) 1 << i)) basis[j] ^= basis[i];
     }
-    gd->reduce[index] = p;
   }
+  gf_linear_table_64(gd->reduce, basis, g_r);
 
   if (g_s == g_r) {
     gf->multiply.w64 = gf_w64_group_s_equals_r_multiply;
@@ -1672,17 +1673,17 @@ gf_w64_split_4_64_lazy_sse_altmap_multiply_region(gf_t *gf, void *src, void *des
 {
   gf_internal_t *h;
   int i, j, k;
-  uint64_t pp, v, *s64, *d64, *top;
+  uint64_t *s64, *d64, *top;
   __m128i si, tables[16][8], p[8], v0, mask1;
   struct gf_split_4_64_lazy_data *ld;
   uint8_t btable[16];
   gf_region_data rd;
+  uint64_t basis[GF_FIELD_WIDTH];
 
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
   if (val == 1) { gf_multby_one(src, dest, bytes, xor); return; }
 
   h = (gf_internal_t *) gf->scratch;
-  pp = h->prim_poly;
 
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 128);
   gf_do_initial_region_alignment(&rd);
@@ -1691,17 +1692,11 @@ gf_w64_split_4_64_lazy_sse_altmap_multiply_region(gf_t *gf, void *src, void *des
   d64 = (uint64_t *) rd.d_start;
   top = (uint64_t *) rd.d_top;
  
-  ld = (struct gf_split_4_64_lazy_data *) h->private;
+  ld = (struct gf_split_4_64_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_4_64_lazy_data), NULL);
 
-  v = val;
+  gf_w64_basis(h, val, basis, GF_FIELD_WIDTH);
   for (i = 0; i < 16; i++) {
-    ld->tables[i][0] = 0;
-    for (j = 1; j < 16; j <<= 1) {
-      for (k = 0; k < j; k++) {
-        ld->tables[i][k^j] = (v ^ ld->tables[i][k]);
-      }
-      v = (v & GF_FIRST_BIT) ? ((v << 1) ^ pp) : (v << 1);
-    }
+    gf_linear_table_64(ld->tables[i], basis + 4*i, 4);
     for (j = 0; j < 8; j++) {
       for (k = 0; k < 16; k++) {
         btable[k] = (uint8_t) ld->tables[i][k];
@@ -1756,17 +1751,17 @@ gf_w64_split_4_64_lazy_sse_multiply_region(gf_t *gf, void *src, void *dest, uint
 {
   gf_internal_t *h;
   int i, j, k;
-  uint64_t pp, v, *s64, *d64, *top;
+  uint64_t *s64, *d64, *top;
   __m128i si, tables[16][8], p[8], st[8], mask1, mask8, mask16, t1;
   struct gf_split_4_64_lazy_data *ld;
   uint8_t btable[16];
   gf_region_data rd;
+  uint64_t basis[GF_FIELD_WIDTH];
 
   if (val == 0) { gf_multby_zero(dest, bytes, xor); return; }
   if (val == 1) { gf_multby_one(src, dest, bytes, xor); return; }
 
   h = (gf_internal_t *) gf->scratch;
-  pp = h->prim_poly;
 
   gf_set_region_data(&rd, gf, src, dest, bytes, val, xor, 128);
   gf_do_initial_region_alignment(&rd);
@@ -1775,17 +1770,11 @@ gf_w64_split_4_64_lazy_sse_multiply_region(gf_t *gf, void *src, void *dest, uint
   d64 = (uint64_t *) rd.d_start;
   top = (uint64_t *) rd.d_top;
  
-  ld = (struct gf_split_4_64_lazy_data *) h->private;
+  ld = (struct gf_split_4_64_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_4_64_lazy_data), NULL);
 
-  v = val;
+  gf_w64_basis(h, val, basis, GF_FIELD_WIDTH);
   for (i = 0; i < 16; i++) {
-    ld->tables[i][0] = 0;
-    for (j = 1; j < 16; j <<= 1) {
-      for (k = 0; k < j; k++) {
-        ld->tables[i][k^j] = (v ^ ld->tables[i][k]);
-      }
-      v = (v & GF_FIRST_BIT) ? ((v << 1) ^ pp) : (v << 1);
-    }
+    gf_linear_table_64(ld->tables[i], basis + 4*i, 4);
     for (j = 0; j < 8; j++) {
       for (k = 0; k < 16; k++) {
         btable[k] = (uint8_t) ld->tables[i][k];
@@ -1953,18 +1942,14 @@ gf_w64_split_4_64_lazy_sse_multiply_region(gf_t *gf, void *src, void *dest, uint
 }
 #endif
 
-#define GF_MULTBY_TWO(p) (((p) & GF_FIRST_BIT) ? (((p) << 1) ^ h->prim_poly) : (p) << 1);
 
 static
 int gf_w64_split_init(gf_t *gf)
 {
   gf_internal_t *h;
-  struct gf_split_4_64_lazy_data *d4;
-  struct gf_split_8_64_lazy_data *d8;
   struct gf_split_8_8_data *d88;
-  struct gf_split_16_64_lazy_data *d16;
-  uint64_t p, basep;
-  int exp, i, j;
+  uint64_t basis[9], row_basis[8], first[256];
+  int exp, i;
 
   h = (gf_internal_t *) gf->scratch;
 
@@ -1998,8 +1983,6 @@ int gf_w64_split_init(gf_t *gf)
 
 #if defined(INTEL_SSE4) || defined(ARCH_AARCH64)
   if (h->mult_type == GF_MULT_DEFAULT) {
-    d4 = (struct gf_split_4_64_lazy_data *) h->private;
-    d4->last_value = 0;
 #if defined(INTEL_SSE4)
     gf->multiply_region.w64 = gf_w64_split_4_64_lazy_sse_multiply_region; 
 #elif defined(ARCH_AARCH64)
@@ -2008,15 +1991,11 @@ int gf_w64_split_init(gf_t *gf)
   }
 #else
   if (h->mult_type == GF_MULT_DEFAULT) {
-    d8 = (struct gf_split_8_64_lazy_data *) h->private;
-    d8->last_value = 0;
     gf->multiply_region.w64 = gf_w64_split_8_64_lazy_multiply_region;
   }
 #endif
 
   if ((h->arg1 == 4 && h->arg2 == 64) || (h->arg1 == 64 && h->arg2 == 4)) {
-    d4 = (struct gf_split_4_64_lazy_data *) h->private;
-    d4->last_value = 0;
 
     if((h->region_type & GF_REGION_ALTMAP) && (h->region_type & GF_REGION_NOSIMD)) return 0;
     if(h->region_type & GF_REGION_ALTMAP)
@@ -2048,13 +2027,9 @@ int gf_w64_split_init(gf_t *gf)
     }
   }
   if ((h->arg1 == 8 && h->arg2 == 64) || (h->arg1 == 64 && h->arg2 == 8)) {
-    d8 = (struct gf_split_8_64_lazy_data *) h->private;
-    d8->last_value = 0;
     gf->multiply_region.w64 = gf_w64_split_8_64_lazy_multiply_region;
   }
   if ((h->arg1 == 16 && h->arg2 == 64) || (h->arg1 == 64 && h->arg2 == 16)) {
-    d16 = (struct gf_split_16_64_lazy_data *) h->private;
-    d16->last_value = 0;
     gf->multiply_region.w64 = gf_w64_split_16_64_lazy_multiply_region;
   }
   if ((h->arg1 == 8 && h->arg2 == 8)) {
@@ -2062,32 +2037,19 @@ int gf_w64_split_init(gf_t *gf)
     gf->multiply.w64 = gf_w64_split_8_8_multiply;
 
     /* The performance of this guy sucks, so don't bother with a region op */
-    
-    basep = 1;
+
+    /* tables[exp][i][j] = i * x^(8*exp) * j.  Column 1 is spanned by the
+       first eight of the basis of x^(8*exp), and row i by the first eight
+       of the basis of its entry in column 1. */
+
+    gf_w64_basis(h, 1, basis, 9);
     for (exp = 0; exp < 15; exp++) {
-      for (j = 0; j < 256; j++) d88->tables[exp][0][j] = 0;
-      for (i = 0; i < 256; i++) d88->tables[exp][i][0] = 0;
-      d88->tables[exp][1][1] = basep;
-      for (i = 2; i < 256; i++) {
-        if (i&1) {
-          p = d88->tables[exp][i^1][1];
-          d88->tables[exp][i][1] = p ^ basep;
-        } else {
-          p = d88->tables[exp][i>>1][1];
-          d88->tables[exp][i][1] = GF_MULTBY_TWO(p);
-        }
+      gf_linear_table_64(first, basis, 8);
+      for (i = 0; i < 256; i++) {
+        gf_w64_basis(h, first[i], row_basis, 8);
+        gf_linear_table_64(d88->tables[exp][i], row_basis, 8);
       }
-      for (i = 1; i < 256; i++) {
-        p = d88->tables[exp][i][1];
-        for (j = 1; j < 256; j++) {
-          if (j&1) {
-            d88->tables[exp][i][j] = d88->tables[exp][i][j^1] ^ p;
-          } else {
-            d88->tables[exp][i][j] = GF_MULTBY_TWO(d88->tables[exp][i][j>>1]);
-          }
-        }
-      }
-      for (i = 0; i < 8; i++) basep = GF_MULTBY_TWO(basep);
+      gf_w64_basis(h, basis[8], basis, 9);
     }
   }
   return 1;
@@ -2125,20 +2087,17 @@ int gf_w64_scratch_size(int mult_type, int region_type, int divide_type, int arg
         if (arg1 == 8 && arg2 == 8) {
           return sizeof(gf_internal_t) + sizeof(struct gf_split_8_8_data) + 64;
         }
-        if ((arg1 == 16 && arg2 == 64) || (arg2 == 16 && arg1 == 64)) {
-          return sizeof(gf_internal_t) + sizeof(struct gf_split_16_64_lazy_data) + 64;
-        }
-        if ((arg1 == 8 && arg2 == 64) || (arg2 == 8 && arg1 == 64)) {
-          return sizeof(gf_internal_t) + sizeof(struct gf_split_8_64_lazy_data) + 64;
-        }
 
-        if ((arg1 == 64 && arg2 == 4) || (arg1 == 4 && arg2 == 64)) {
-          return sizeof(gf_internal_t) + sizeof(struct gf_split_4_64_lazy_data) + 64;
+        /* The lazy region tables live in the per-thread region context. */
+
+        if ((arg1 == 16 && arg2 == 64) || (arg2 == 16 && arg1 == 64) ||
+            (arg1 == 8 && arg2 == 64) || (arg2 == 8 && arg1 == 64) ||
+            (arg1 == 64 && arg2 == 4) || (arg1 == 4 && arg2 == 64)) {
+          return sizeof(gf_internal_t) + 64;
         }
         return 0;
     case GF_MULT_GROUP:
       return sizeof(gf_internal_t) + sizeof(struct gf_w64_group_data) +
-               sizeof(uint64_t) * (1 << arg1) +
                sizeof(uint64_t) * (1 << arg2) + 64;
       break;
     case GF_MULT_COMPOSITE:
@@ -2197,9 +2156,10 @@ int gf_w64_init(gf_t *gf)
     gf->inverse.w64 = gf_w64_inverse_from_divide;
   }
 
-  if (h->region_type == GF_REGION_CAUCHY) return 0;
-
-  if (h->region_type & GF_REGION_ALTMAP) {
+  if (h->region_type == GF_REGION_CAUCHY) {
+    gf->multiply_region.w64 = gf_wgen_cauchy_region_w64;
+    gf->extract_word.w64 = gf_wgen_extract_word_w64;
+  } else if (h->region_type & GF_REGION_ALTMAP) {
     if (h->mult_type == GF_MULT_COMPOSITE) {
       gf->extract_word.w64 = gf_w64_composite_extract_word;
     } else if (h->mult_type == GF_MULT_SPLIT_TABLE) {
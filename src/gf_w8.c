@@ -12,6 +12,7 @@
 #include "gf_w8.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <assert.h>
 
 #define AB2(ip, am1 ,am2, b, t1, t2) {\
@@ -833,6 +834,13 @@ IMPLEMENTATION: FULL_TABLE:
 JSP: Kevin wrote this, and I'm converting it to my structure.
  */
 
+/* The scalar part of the TABLE tables (see gf_w8_table_build()) is built
+   when it is first needed. */
+
+#define GF_W8_SCALAR_PART (0)
+
+static void gf_w8_table_build_scalar(gf_t *gf, void *tables);
+
 static
   gf_val_32_t
 gf_w8_table_multiply(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
@@ -849,6 +857,7 @@ gf_w8_table_divide(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
 {
   struct gf_w8_single_table_data *ftd;
 
+  GF_NEED_PART(gf, GF_W8_SCALAR_PART, gf_w8_table_build_scalar);
   ftd = (struct gf_w8_single_table_data *) ((gf_internal_t *) gf->scratch)->private;
   return (ftd->divtable[a][b]);
 }
@@ -859,6 +868,7 @@ gf_w8_default_multiply(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
 {
   struct gf_w8_default_data *ftd;
 
+  GF_NEED_PART(gf, GF_W8_SCALAR_PART, gf_w8_table_build_scalar);
   ftd = (struct gf_w8_default_data *) ((gf_internal_t *) gf->scratch)->private;
   return (ftd->multtable[a][b]);
 }
@@ -870,6 +880,7 @@ gf_w8_default_divide(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
 {
   struct gf_w8_default_data *ftd;
 
+  GF_NEED_PART(gf, GF_W8_SCALAR_PART, gf_w8_table_build_scalar);
   ftd = (struct gf_w8_default_data *) ((gf_internal_t *) gf->scratch)->private;
   return (ftd->divtable[a][b]);
 }
@@ -891,6 +902,7 @@ gf_w8_double_table_divide(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
 {
   struct gf_w8_double_table_data *ftd;
 
+  GF_NEED_PART(gf, GF_W8_SCALAR_PART, gf_w8_table_build_scalar);
   ftd = (struct gf_w8_double_table_data *) ((gf_internal_t *) gf->scratch)->private;
   return (ftd->div[a][b]);
 }
@@ -912,7 +924,7 @@ gf_w8_double_table_multiply_region(gf_t *gf, void *src, void *dest, gf_val_32_t
   h = (gf_internal_t *) (gf->scratch);
   if (h->region_type & GF_REGION_LAZY) {
     ltd = (struct gf_w8_double_table_lazy_data *) h->private;
-    base = ltd->mult;
+    base = (uint16_t *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(uint16_t) * GF_FIELD_SIZE * GF_FIELD_SIZE, NULL);
     for (b = 0; b < GF_FIELD_SIZE; b++) {
       vb = (ltd->smult[val][b] << 8);
       for (c = 0; c < GF_FIELD_SIZE; c++) {
@@ -948,6 +960,7 @@ gf_w8_double_table_lazy_divide(gf_t *gf, gf_val_32_t a, gf_val_32_t b)
 {
   struct gf_w8_double_table_lazy_data *ftd;
 
+  GF_NEED_PART(gf, GF_W8_SCALAR_PART, gf_w8_table_build_scalar);
   ftd = (struct gf_w8_double_table_lazy_data *) ((gf_internal_t *) gf->scratch)->private;
   return (ftd->div[a][b]);
 }
@@ -1081,25 +1094,37 @@ gf_w8_split_multiply_region(gf_t *gf, void *src, void *dest, gf_val_32_t val, in
   }
 }
 
+/* basis[j] = a * x^j, the basis of the row of a in a multiplication table. */
+
+static
+void gf_w8_basis(gf_t *gf, uint32_t a, uint8_t *basis)
+{
+  gf_internal_t *h;
+  int j;
+
+  h = (gf_internal_t *) gf->scratch;
+  for (j = 0; j < GF_FIELD_WIDTH; j++) {
+    basis[j] = a;
+    a <<= 1;
+    if (a & GF_FIELD_SIZE) a ^= h->prim_poly;
+  }
+}
 
   static
 int gf_w8_split_init(gf_t *gf)
 {
   gf_internal_t *h;
   struct gf_w8_half_table_data *htd;
-  int a, b;
+  uint8_t basis[GF_FIELD_WIDTH];
+  int a;
 
   h = (gf_internal_t *) gf->scratch;
   htd = (struct gf_w8_half_table_data *)h->private;
 
-  bzero(htd->high, sizeof(uint8_t)*GF_FIELD_SIZE*GF_HALF_SIZE);
-  bzero(htd->low, sizeof(uint8_t)*GF_FIELD_SIZE*GF_HALF_SIZE);
-
-  for (a = 1; a < GF_FIELD_SIZE; a++) {
-    for (b = 1; b < GF_HALF_SIZE; b++) {
-      htd->low[a][b] = gf_w8_shift_multiply(gf,a,b);
-      htd->high[a][b] = gf_w8_shift_multiply(gf,a,b<<4);
-    }
+  for (a = 0; a < GF_FIELD_SIZE; a++) {
+    gf_w8_basis(gf, a, basis);
+    gf_linear_table_8(htd->low[a], basis, 4);
+    gf_linear_table_8(htd->high[a], basis+4, 4);
   }
 
   gf->multiply.w32 = gf_w8_split_multiply;
@@ -1122,84 +1147,170 @@ int gf_w8_split_init(gf_t *gf)
   return 1;
 }
 
-/* JSP: This is disgusting, but it is what it is.  If there is no SSE,
-   then the default is equivalent to single table.  If there is SSE, then
-   we use the "gf_w8_default_data" which is a hybrid of SPLIT & TABLE. */
-   
+/* Which of the four cases of gf_w8_table_init() h is.  JSP: This is
+   disgusting, but it is what it is.  If there is no SSE, then the default is
+   equivalent to single table.  If there is SSE, then we use the
+   "gf_w8_default_data" which is a hybrid of SPLIT & TABLE. */
+
 static
-int gf_w8_table_init(gf_t *gf)
+int gf_w8_table_case(gf_internal_t *h)
+{
+#if defined(INTEL_SSSE3) || defined(ARM_NEON)
+  if (h->mult_type == GF_MULT_DEFAULT) return 3;
+#endif
+  if (h->mult_type == GF_MULT_DEFAULT || 
+      h->region_type == 0 || (h->region_type & GF_REGION_CAUCHY)) return 0;
+  if (h->region_type == GF_REGION_DOUBLE_TABLE) return 1;
+  if (h->region_type == (GF_REGION_DOUBLE_TABLE | GF_REGION_LAZY)) return 2;
+  return -1;
+}
+
+/* Fills the tables for one of the four cases of gf_w8_table_init().  They
+   depend only on the polynomial, so they are shared by every gf_t that uses
+   the same case and polynomial.  This only fills what the region multiplies
+   use.  The division table, and the full multiplication table of the
+   default case, are the scalar part, built by gf_w8_table_build_scalar() the
+   first time multiply(), divide() or inverse() needs them. */
+
+static
+int gf_w8_table_build(gf_t *gf, void *tables, int scase)
 {
-  gf_internal_t *h;
   struct gf_w8_single_table_data *ftd = NULL;
   struct gf_w8_double_table_data *dtd = NULL;
   struct gf_w8_double_table_lazy_data *ltd = NULL;
   struct gf_w8_default_data *dd = NULL;
-  int a, b, c, prod, scase, use_simd;
-
-  h = (gf_internal_t *) gf->scratch;
+  uint8_t basis[GF_FIELD_WIDTH], row[GF_FIELD_SIZE];
+  int a, b, c;
 
-#if defined(INTEL_SSSE3) || defined(ARM_NEON)
-  use_simd = 1;
-#else
-  use_simd = 0;
-#endif
+  switch (scase) {
+    case 0: ftd = (struct gf_w8_single_table_data *) tables; break;
+    case 1: dtd = (struct gf_w8_double_table_data *) tables; break;
+    case 2: ltd = (struct gf_w8_double_table_lazy_data *) tables; break;
+    case 3: dd = (struct gf_w8_default_data *) tables; break;
+  }
 
-  if (h->mult_type == GF_MULT_DEFAULT && use_simd) {
-    dd = (struct gf_w8_default_data *)h->private;
-    scase = 3;
-    bzero(dd->high, sizeof(uint8_t) * GF_FIELD_SIZE * GF_HALF_SIZE);
-    bzero(dd->low, sizeof(uint8_t) * GF_FIELD_SIZE * GF_HALF_SIZE);
-    bzero(dd->divtable, sizeof(uint8_t) * GF_FIELD_SIZE * GF_FIELD_SIZE);
-    bzero(dd->multtable, sizeof(uint8_t) * GF_FIELD_SIZE * GF_FIELD_SIZE);
-  } else if (h->mult_type == GF_MULT_DEFAULT || 
-             h->region_type == 0 || (h->region_type & GF_REGION_CAUCHY)) {
-    ftd = (struct gf_w8_single_table_data *)h->private;
-    bzero(ftd->divtable, sizeof(uint8_t) * GF_FIELD_SIZE * GF_FIELD_SIZE);
-    bzero(ftd->multtable, sizeof(uint8_t) * GF_FIELD_SIZE * GF_FIELD_SIZE);
-    scase = 0;
-  } else if (h->region_type == GF_REGION_DOUBLE_TABLE) {
-    dtd = (struct gf_w8_double_table_data *)h->private;
-    bzero(dtd->div, sizeof(uint8_t) * GF_FIELD_SIZE * GF_FIELD_SIZE);
-    bzero(dtd->mult, sizeof(uint16_t) * GF_FIELD_SIZE * GF_FIELD_SIZE * GF_FIELD_SIZE);
-    scase = 1;
-  } else if (h->region_type == (GF_REGION_DOUBLE_TABLE | GF_REGION_LAZY)) {
-    ltd = (struct gf_w8_double_table_lazy_data *)h->private;
-    bzero(ltd->div, sizeof(uint8_t) * GF_FIELD_SIZE * GF_FIELD_SIZE);
-    bzero(ltd->smult, sizeof(uint8_t) * GF_FIELD_SIZE * GF_FIELD_SIZE);
-    scase = 2;
-  } else {
-    fprintf(stderr, "Internal error in gf_w8_table_init\n");
-    assert(0);
-  }
-
-  for (a = 1; a < GF_FIELD_SIZE; a++) {
-    for (b = 1; b < GF_FIELD_SIZE; b++) {
-      prod = gf_w8_shift_multiply(gf,a,b);
-      switch (scase) {
-        case 0: 
-          ftd->multtable[a][b] = prod;
-          ftd->divtable[prod][b] = a;
-          break;
-        case 1:
-          dtd->div[prod][b] = a;
+  for (a = 0; a < GF_FIELD_SIZE; a++) {
+    gf_w8_basis(gf, a, basis);
+    gf_linear_table_8(row, basis, GF_FIELD_WIDTH);
+    switch (scase) {
+      case 0: 
+        memcpy(ftd->multtable[a], row, GF_FIELD_SIZE);
+        break;
+      case 1:
+        for (b = 0; b < GF_FIELD_SIZE; b++) {
           for (c = 0; c < GF_FIELD_SIZE; c++) {
-            dtd->mult[a][(c<<8)|b] |= prod;
-            dtd->mult[a][(b<<8)|c] |= (prod<<8);
+            dtd->mult[a][(b<<8)|c] = (row[b] << 8) | row[c];
           }
-          break;
-        case 2:
-          ltd->div[prod][b] = a;
-          ltd->smult[a][b] = prod;
-          break;
-        case 3:
-          dd->multtable[a][b] = prod;
-          dd->divtable[prod][b] = a;
-          if ((b & 0xf) == b) { dd->low[a][b] = prod; }
-          if ((b & 0xf0) == b) { dd->high[a][b>>4] = prod; }
-          break;
-      }
+        }
+        break;
+      case 2:
+        memcpy(ltd->smult[a], row, GF_FIELD_SIZE);
+        break;
+      case 3:
+        for (b = 0; b < GF_HALF_SIZE; b++) {
+          dd->low[a][b] = row[b];
+          dd->high[a][b] = row[b<<4];
+        }
+        break;
     }
   }
+  return 1;
+}
+
+static int gf_w8_single_table_build(gf_t *gf, void *t) { return gf_w8_table_build(gf, t, 0); }
+static int gf_w8_double_table_build(gf_t *gf, void *t) { return gf_w8_table_build(gf, t, 1); }
+static int gf_w8_double_table_lazy_build(gf_t *gf, void *t) { return gf_w8_table_build(gf, t, 2); }
+static int gf_w8_default_build(gf_t *gf, void *t) { return gf_w8_table_build(gf, t, 3); }
+
+static
+void gf_w8_table_build_scalar(gf_t *gf, void *tables)
+{
+  uint8_t (*div)[GF_FIELD_SIZE];
+  uint8_t (*mult)[GF_FIELD_SIZE];
+  uint8_t basis[GF_FIELD_WIDTH], row[GF_FIELD_SIZE];
+  int a, b;
+
+  mult = NULL;
+  switch (gf_w8_table_case((gf_internal_t *) gf->scratch)) {
+    case 0: div = ((struct gf_w8_single_table_data *) tables)->divtable; break;
+    case 1: div = ((struct gf_w8_double_table_data *) tables)->div; break;
+    case 2: div = ((struct gf_w8_double_table_lazy_data *) tables)->div; break;
+    default:
+      div = ((struct gf_w8_default_data *) tables)->divtable;
+      mult = ((struct gf_w8_default_data *) tables)->multtable;
+      break;
+  }
+
+  bzero(div, sizeof(uint8_t) * GF_FIELD_SIZE * GF_FIELD_SIZE);
+  for (a = 0; a < GF_FIELD_SIZE; a++) {
+    gf_w8_basis(gf, a, basis);
+    gf_linear_table_8(row, basis, GF_FIELD_WIDTH);
+    if (mult != NULL) memcpy(mult[a], row, GF_FIELD_SIZE);
+    if (a == 0) continue;
+    for (b = 1; b < GF_FIELD_SIZE; b++) div[row[b]][b] = a;
+  }
+}
+
+/* With GF_REGION_ONLY, only the front of the shared tables is allocated:
+   the division table, and the full multiplication table of the default
+   case, are left out.  Division then uses Euclid's algorithm, and the
+   default case multiplies with its SPLIT 8,4 tables.  The tables compiled
+   into the library cost nothing, so they are used in full. */
+
+static
+int gf_w8_table_init(gf_t *gf)
+{
+  gf_internal_t *h;
+  int scase, ok, drop;
+
+  h = (gf_internal_t *) gf->scratch;
+  scase = gf_w8_table_case(h);
+
+  /* With the default polynomial, the default and single tables are the
+     ones compiled into the library. */
+
+  switch (scase) {
+    case 0:
+      if (h->prim_poly == 0x11d) {
+        h->private = (void *) gf_w8_default_tables.multtable;
+        ok = 1;
+      } else {
+        ok = gf_share_tables(gf, (h->region_only) ?
+                               offsetof(struct gf_w8_single_table_data, divtable) :
+                               sizeof(struct gf_w8_single_table_data),
+                             gf_w8_single_table_build);
+      }
+      break;
+    case 1:
+      ok = gf_share_tables(gf, (h->region_only) ?
+                             offsetof(struct gf_w8_double_table_data, div) :
+                             sizeof(struct gf_w8_double_table_data),
+                           gf_w8_double_table_build);
+      break;
+    case 2:
+      ok = gf_share_tables(gf, (h->region_only) ?
+                             offsetof(struct gf_w8_double_table_lazy_data, div) :
+                             sizeof(struct gf_w8_double_table_lazy_data),
+                           gf_w8_double_table_lazy_build);
+      break;
+    case 3:
+      if (h->prim_poly == 0x11d) {
+        h->private = (void *) &gf_w8_default_tables;
+        ok = 1;
+      } else {
+        ok = gf_share_tables(gf, (h->region_only) ?
+                               sizeof(struct gf_w8_half_table_data) :
+                               sizeof(struct gf_w8_default_data),
+                             gf_w8_default_build);
+      }
+      break;
+    default:
+      fprintf(stderr, "Internal error in gf_w8_table_init\n");
+      assert(0);
+      return 0;
+  }
+  if (!ok) return 0;
+  drop = (h->region_only && h->shared != NULL);
 
   gf->inverse.w32 = NULL; /* Will set from divide */
   switch (scase) {
@@ -1220,8 +1331,12 @@ int gf_w8_table_init(gf_t *gf)
       break;
     case 3:
 #if defined(INTEL_SSSE3) || defined(ARM_NEON)
-      gf->divide.w32 = gf_w8_default_divide;
-      gf->multiply.w32 = gf_w8_default_multiply;
+      if (drop) {
+        gf->multiply.w32 = gf_w8_split_multiply;
+      } else {
+        gf->divide.w32 = gf_w8_default_divide;
+        gf->multiply.w32 = gf_w8_default_multiply;
+      }
 #if defined(INTEL_SSSE3)
       gf->multiply_region.w32 = gf_w8_split_multiply_region_sse;
 #elif defined(ARM_NEON)
@@ -1230,6 +1345,7 @@ int gf_w8_table_init(gf_t *gf)
 #endif
       break;
   }
+  if (drop) gf->divide.w32 = NULL;  /* gf_w8_init() uses Euclid */
   return 1;
 }
 
@@ -2226,29 +2342,18 @@ int gf_w8_bytwo_init(gf_t *gf)
 
 int gf_w8_scratch_size(int mult_type, int region_type, int divide_type, int arg1, int arg2)
 {
+  /* The TABLE tables are shared (see gf_w8_table_init()), so they aren't
+     counted here.  gf_w8_shared_size() counts them. */
+
   switch(mult_type)
   {
     case GF_MULT_DEFAULT:
-#if defined(INTEL_SSSE3) || defined(ARM_NEON)
-      return sizeof(gf_internal_t) + sizeof(struct gf_w8_default_data) + 64;
-#endif
-      return sizeof(gf_internal_t) + sizeof(struct gf_w8_single_table_data) + 64;
+      return sizeof(gf_internal_t);
     case GF_MULT_TABLE:
-      if (region_type == GF_REGION_CAUCHY) {
-        return sizeof(gf_internal_t) + sizeof(struct gf_w8_single_table_data) + 64;
-      }
-
-      if (region_type == GF_REGION_DEFAULT) {
-        return sizeof(gf_internal_t) + sizeof(struct gf_w8_single_table_data) + 64;
-      } 
-      if (region_type & GF_REGION_DOUBLE_TABLE) {
-        if (region_type == GF_REGION_DOUBLE_TABLE) {
-          return sizeof(gf_internal_t) + sizeof(struct gf_w8_double_table_data) + 64;
-        } else if (region_type == (GF_REGION_DOUBLE_TABLE | GF_REGION_LAZY)) {
-          return sizeof(gf_internal_t) + sizeof(struct gf_w8_double_table_lazy_data) + 64;
-        } else {
-          return 0;
-        }
+      if (region_type == GF_REGION_CAUCHY || region_type == GF_REGION_DEFAULT ||
+          region_type == GF_REGION_DOUBLE_TABLE ||
+          region_type == (GF_REGION_DOUBLE_TABLE | GF_REGION_LAZY)) {
+        return sizeof(gf_internal_t);
       }
       return 0;
       break;
@@ -2284,6 +2389,32 @@ int gf_w8_scratch_size(int mult_type, int region_type, int divide_type, int arg1
   return 0;
 }
 
+/* The size of the tables that gf_w8_table_init() shares, which have to fit
+   in scratch memory that the caller supplies. */
+
+int gf_w8_shared_size(int mult_type, int region_type, int arg1, int arg2)
+{
+  switch(mult_type)
+  {
+    case GF_MULT_DEFAULT:
+#if defined(INTEL_SSSE3) || defined(ARM_NEON)
+      return sizeof(struct gf_w8_default_data) + 64;
+#endif
+      return sizeof(struct gf_w8_single_table_data) + 64;
+    case GF_MULT_TABLE:
+      if (region_type == GF_REGION_CAUCHY || region_type == GF_REGION_DEFAULT) {
+        return sizeof(struct gf_w8_single_table_data) + 64;
+      } else if (region_type == GF_REGION_DOUBLE_TABLE) {
+        return sizeof(struct gf_w8_double_table_data) + 64;
+      } else if (region_type == (GF_REGION_DOUBLE_TABLE | GF_REGION_LAZY)) {
+        return sizeof(struct gf_w8_double_table_lazy_data) + 64;
+      }
+      return 0;
+    default:
+      return 0;
+  }
+}
+
 int gf_w8_init(gf_t *gf)
 {
   gf_internal_t *h;
@@ -2367,6 +2498,7 @@ uint8_t *gf_w8_get_mult_table(gf_t *gf)
 
   h = (gf_internal_t *) gf->scratch;
   if (gf->multiply.w32 == gf_w8_default_multiply) {
+    GF_NEED_PART(gf, GF_W8_SCALAR_PART, gf_w8_table_build_scalar);
     ftd = (struct gf_w8_default_data *) h->private;
     return (uint8_t *) ftd->multtable;
   } else if (gf->multiply.w32 == gf_w8_table_multiply) {
@@ -2378,14 +2510,19 @@ uint8_t *gf_w8_get_mult_table(gf_t *gf)
 
 uint8_t *gf_w8_get_div_table(gf_t *gf)
 {
+  gf_internal_t *h;
   struct gf_w8_default_data *ftd;
   struct gf_w8_single_table_data *std;
 
+  h = (gf_internal_t *) gf->scratch;
   if (gf->multiply.w32 == gf_w8_default_multiply) {
-    ftd = (struct gf_w8_default_data *) ((gf_internal_t *) gf->scratch)->private;
+    GF_NEED_PART(gf, GF_W8_SCALAR_PART, gf_w8_table_build_scalar);
+    ftd = (struct gf_w8_default_data *) h->private;
     return (uint8_t *) ftd->divtable;
   } else if (gf->multiply.w32 == gf_w8_table_multiply) {
-    std = (struct gf_w8_single_table_data *) ((gf_internal_t *) gf->scratch)->private;
+    if (h->region_only && h->shared != NULL) return NULL;
+    GF_NEED_PART(gf, GF_W8_SCALAR_PART, gf_w8_table_build_scalar);
+    std = (struct gf_w8_single_table_data *) h->private;
     return (uint8_t *) std->divtable;
   }
   return NULL;
@@ -68,7 +68,7 @@ neon_w64_split_4_lazy_altmap_multiply_region(gf_t *gf, uint64_t *src,
   uint8x16_t p[8], mask1, si;
 
   gf_internal_t *h = (gf_internal_t *) gf->scratch;
-  struct gf_split_4_64_lazy_data *ld = (struct gf_split_4_64_lazy_data *) h->private;
+  struct gf_split_4_64_lazy_data *ld = (struct gf_split_4_64_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_4_64_lazy_data), NULL);
 
   for (i = 0; i < 16; i++) {
     for (j = 0; j < 8; j++) {
@@ -141,7 +141,7 @@ neon_w64_split_4_lazy_multiply_region(gf_t *gf, uint64_t *src, uint64_t *dst,
   uint8x16x2_t s8[4];
 
   gf_internal_t *h = (gf_internal_t *) gf->scratch;
-  struct gf_split_4_64_lazy_data *ld = (struct gf_split_4_64_lazy_data *) h->private;
+  struct gf_split_4_64_lazy_data *ld = (struct gf_split_4_64_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_4_64_lazy_data), NULL);
 
   for (i = 0; i < 16; i++) {
     for (j = 0; j < 8; j++) {
@@ -276,7 +276,7 @@ gf_w64_neon_split_4_lazy_multiply_region(gf_t *gf, void *src, void *dest,
 
   h = (gf_internal_t *) gf->scratch;
   pp = h->prim_poly;
-  ld = (struct gf_split_4_64_lazy_data *) h->private;
+  ld = (struct gf_split_4_64_lazy_data *) gf_region_context(gf, GF_CONTEXT_REGION, sizeof(struct gf_split_4_64_lazy_data), NULL);
 
   v = val;
   for (i = 0; i < 16; i++) {
@@ -0,0 +1,1735 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_code_unit.c
+ *
+ * Performs unit testing for the coding routines that are built on top of gf_t
+ */
+
+#include "config.h"
+
+#ifdef HAVE_POSIX_MEMALIGN
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 600
+#endif
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "gf_complete.h"
+#include "gf_int.h"
+#include "gf_method.h"
+#include "gf_rand.h"
+#include "gf_matrix.h"
+#include "gf_rs.h"
+#include "gf_lrc.h"
+#include "gf_rlnc.h"
+#include "gf_fft.h"
+#include "gf_shamir.h"
+#include "gf_dense.h"
+#include "gf_gemm.h"
+#include "gf_poly.h"
+#include "gf_stream.h"
+#include "gf_parallel.h"
+#include "gf_async.h"
+
+char *BM = "Bad Method: ";
+int verbose;
+
+void problem(char *s)
+{
+  fprintf(stderr, "Unit test failed.\n");
+  fprintf(stderr, "%s\n", s);
+  exit(1);
+}
+
+void usage(char *s)
+{
+  fprintf(stderr, "usage: gf_code_unit w tests seed [method] - tests the coding routines in GF(2^w)\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Legal w are: 1 - 32, plus 64 and 128 for the T test alone\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Tests may be any combination of:\n");
+  fprintf(stderr, "       A: All\n");
+  fprintf(stderr, "       M: Matrix inversion and the decode cache\n");
+  fprintf(stderr, "       R: Reed-Solomon error correction (w = 8 and 16)\n");
+  fprintf(stderr, "       L: Local Reconstruction Codes\n");
+  fprintf(stderr, "       N: Random linear network coding\n");
+  fprintf(stderr, "       F: Additive FFT Reed-Solomon codes (w <= 16)\n");
+  fprintf(stderr, "       S: Shamir secret sharing\n");
+  fprintf(stderr, "       D: Dense matrices (w = 4, 8, 16 and 32)\n");
+  fprintf(stderr, "       G: Matrix-matrix multiplication (gf_gemm)\n");
+  fprintf(stderr, "       P: Polynomial arithmetic\n");
+  fprintf(stderr, "       I: Streaming file encoder\n");
+  fprintf(stderr, "       T: Region and single multiplies from threads sharing the gf_t\n");
+  fprintf(stderr, "       H: Parallel region multiplies and stripe batches on the thread pool\n");
+  fprintf(stderr, "       Q: Asynchronous region job queue\n");
+  fprintf(stderr, "       C: Tables shared between gf_t's with the same configuration\n");
+  fprintf(stderr, "       V: Verbose Output\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Use -1 for time(0) as a seed.\n");
+  fprintf(stderr, "\n");
+  if (s == BM) {
+    fprintf(stderr, "%s", BM);
+    gf_error();
+  } else if (s != NULL) {
+    fprintf(stderr, "%s\n", s);
+  }
+  exit(1);
+}
+
+void SigHandler(int v)
+{
+  (void) v;
+  fprintf(stderr, "Problem: SegFault!\n");
+  fflush(stdout);
+  exit(2);
+}
+
+/* Allocates a region aligned on a 16-byte boundary, so that any two regions
+   are aligned with respect to each other. */
+
+void *alloc_region(int bytes)
+{
+  void *r;
+
+#ifdef HAVE_POSIX_MEMALIGN
+  if (posix_memalign(&r, 16, bytes)) r = NULL;
+#else
+  r = malloc(bytes);
+#endif
+  if (r == NULL) problem("Out of memory");
+  return r;
+}
+
+/* Returns 1 if a * b is the identity, where both are rows x rows. */
+
+int is_identity_product(gf_t *gf, uint32_t *a, uint32_t *b, int rows)
+{
+  int i, j, l;
+  uint32_t sum;
+
+  for (i = 0; i < rows; i++) {
+    for (j = 0; j < rows; j++) {
+      sum = 0;
+      for (l = 0; l < rows; l++) sum ^= gf->multiply.w32(gf, a[i*rows+l], b[l*rows+j]);
+      if (sum != (i == j)) return 0;
+    }
+  }
+  return 1;
+}
+
+/* Creates an m x k Cauchy coding matrix, so that any k rows of the
+   distribution matrix are invertible.  Requires k+m <= 2^w. */
+
+uint32_t *cauchy_coding_matrix(gf_t *gf, int k, int m)
+{
+  uint32_t *matrix;
+  int i, j;
+
+  matrix = (uint32_t *) malloc(sizeof(uint32_t)*k*m);
+  for (i = 0; i < m; i++) {
+    for (j = 0; j < k; j++) {
+      matrix[i*k+j] = gf->inverse.w32(gf, i ^ (m+j));
+    }
+  }
+  return matrix;
+}
+
+/* Returns the first word of a region, for w = 8, 16 and 32. */
+
+uint32_t first_word(uint8_t *r, int w)
+{
+  if (w == 8) return r[0];
+  if (w == 16) return *(uint16_t *) r;
+  return *(uint32_t *) r;
+}
+
+/* Picks k random distinct survivors out of n. */
+
+void random_survivors(int k, int n, int *survivors)
+{
+  int i, j, t, *perm;
+
+  perm = (int *) malloc(sizeof(int)*n);
+  for (i = 0; i < n; i++) perm[i] = i;
+  for (i = 0; i < k; i++) {
+    j = i + MOA_Random_W(30, 1) % (n-i);
+    t = perm[i]; perm[i] = perm[j]; perm[j] = t;
+    survivors[i] = perm[i];
+  }
+  free(perm);
+}
+
+void test_matrix(gf_t *gf, int w)
+{
+  uint32_t *mat, *copy, *inv, *coding, *dist;
+  int rows, i, j, it, k, m, ok, patterns[6][32], *ids, want[32], nw, bytes, off, len, pcs;
+  uint8_t **frags, **out, *ilv, *bases[32], *src[32];
+  uint32_t e;
+  gf_decode_cache_t *cache;
+  uint64_t hits, misses;
+  char s[100];
+
+  if (verbose) { printf("Testing matrix inversion.\n"); fflush(stdout); }
+
+  rows = 12;
+  mat = (uint32_t *) malloc(sizeof(uint32_t)*rows*rows);
+  copy = (uint32_t *) malloc(sizeof(uint32_t)*rows*rows);
+  inv = (uint32_t *) malloc(sizeof(uint32_t)*rows*rows);
+
+  for (it = 0; it < 100; it++) {
+    for (i = 0; i < rows*rows; i++) mat[i] = MOA_Random_W(w, 1);
+    memcpy(copy, mat, sizeof(uint32_t)*rows*rows);
+    if (gf_matrix_invert(gf, mat, inv, rows)) {
+      if (!is_identity_product(gf, copy, inv, rows)) problem("gf_matrix_invert returned a bad inverse");
+    }
+
+    /* A matrix with two equal rows must be reported as singular. */
+
+    memcpy(mat, copy, sizeof(uint32_t)*rows*rows);
+    memcpy(mat+rows, mat, sizeof(uint32_t)*rows);
+    if (gf_matrix_invert(gf, mat, inv, rows)) problem("gf_matrix_invert inverted a singular matrix");
+  }
+
+  if (w < 4) return;
+  if (verbose) { printf("Testing the decode cache.\n"); fflush(stdout); }
+
+  k = (w == 4) ? 8 : 10;
+  m = 4;
+  coding = cauchy_coding_matrix(gf, k, m);
+  cache = gf_decode_cache_create(gf, k, m, coding, 4);
+  if (cache == NULL) problem("gf_decode_cache_create failed");
+
+  for (i = 0; i < 6; i++) random_survivors(k, k+m, patterns[i]);
+
+  dist = (uint32_t *) malloc(sizeof(uint32_t)*k*k);
+  ids = (int *) malloc(sizeof(int)*k);
+  for (it = 0; it < 300; it++) {
+    memcpy(ids, patterns[(it/3) % 6], sizeof(int)*k);
+    if (!gf_decode_cache_lookup(cache, ids, inv)) problem("gf_decode_cache_lookup failed");
+
+    /* Rebuild the survivors' rows of the distribution matrix in sorted order
+       and check that the cached matrix inverts them. */
+
+    for (i = 0; i < k; i++) {
+      for (j = i+1; j < k; j++) {
+        if (ids[j] < ids[i]) { ok = ids[i]; ids[i] = ids[j]; ids[j] = ok; }
+      }
+      for (j = 0; j < k; j++) {
+        dist[i*k+j] = (ids[i] < k) ? (j == ids[i]) : coding[(ids[i]-k)*k+j];
+      }
+    }
+    if (!is_identity_product(gf, inv, dist, k)) problem("The decode cache returned a bad matrix");
+  }
+
+  gf_decode_cache_stats(cache, &hits, &misses);
+  if (hits + misses != 300 || hits < 200) {
+    sprintf(s, "Decode cache stats are wrong: %llu hits, %llu misses",
+            (unsigned long long) hits, (unsigned long long) misses);
+    problem(s);
+  }
+
+  /* Partial decodes:  random ranges of some of the lost fragments, plus a
+     survivor now and then. */
+
+  if ((w == 4 || w == 8 || w == 16 || w == 32)) {
+    bytes = 4096;
+    frags = (uint8_t **) malloc(sizeof(uint8_t *) * (k+m) * 2);
+    out = frags + k+m;
+    for (i = 0; i < k+m; i++) {
+      frags[i] = alloc_region(bytes);
+      out[i] = alloc_region(bytes);
+    }
+    for (i = 0; i < k; i++) MOA_Fill_Random_Region(frags[i], bytes);
+    gf_matrix_region_multiply(gf, coding, m, k, (void **) frags, (void **) frags+k, bytes, 0);
+    want[0] = 0;
+    random_survivors(k, k+m, ids);
+    if (((gf_internal_t *) gf->scratch)->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY)) {
+      if (gf_decode_cache_range(cache, ids, (void **) frags, 1, want, (void **) out, 0, 64)) {
+        problem("gf_decode_cache_range accepted an ALTMAP or CAUCHY gf_t");
+      }
+    } else {
+      for (it = 0; it < 50; it++) {
+        random_survivors(k, k+m, ids);
+        nw = 0;
+        for (i = 0; i < k+m; i++) {
+          for (j = 0; j < k && ids[j] != i; j++) ;
+          if (j == k && MOA_Random_W(1, 1)) want[nw++] = i;
+        }
+        if (nw == 0 || it % 5 == 0) want[nw++] = ids[it % k];
+        off = 16 * (MOA_Random_W(30, 1) % (bytes / 32));
+        len = 16 * (1 + MOA_Random_W(30, 1) % (bytes / 32));
+        if (!gf_decode_cache_range(cache, ids, (void **) frags, nw, want, (void **) out, off, len)) {
+          problem("gf_decode_cache_range failed");
+        }
+        for (i = 0; i < nw; i++) {
+          if (memcmp(out[i], frags[want[i]] + off, len) != 0) problem("gf_decode_cache_range decoded the wrong bytes");
+        }
+      }
+      want[0] = k+m;
+      if (gf_decode_cache_range(cache, ids, (void **) frags, 1, want, (void **) out, 0, 64)) {
+        problem("gf_decode_cache_range accepted a bad fragment id");
+      }
+    }
+
+    /* Strided regions:  k data fragments interleaved in one buffer, encoded
+       into m interleaved coding fragments, must match encoding the
+       de-interleaved fragments.  With ALTMAP and CAUCHY, every piece is its
+       own region, so the reference encodes piece by piece. */
+
+    if (verbose) { printf("Testing strided regions.\n"); fflush(stdout); }
+    ilv = (uint8_t *) alloc_region((k+m) * bytes);
+    pcs = bytes / 256;
+    for (i = 0; i < k; i++) {
+      for (j = 0; j < pcs; j++) memcpy(ilv + (j*k+i)*256, frags[i] + j*256, 256);
+    }
+    for (i = 0; i < k+m; i++) bases[i] = (i < k) ? ilv + i*256 : ilv + k*bytes + (i-k)*256;
+    if (!gf_matrix_region_multiply_strided(gf, coding, m, k, (void **) bases, k*256,
+                                           (void **) bases+k, m*256, 256, pcs, 0)) {
+      problem("gf_matrix_region_multiply_strided failed");
+    }
+    for (j = 0; j < pcs; j++) {
+      for (i = 0; i < k+m; i++) {
+        src[i] = frags[i] + j*256;
+      }
+      gf_matrix_region_multiply(gf, coding, m, k, (void **) src, (void **) src+k, 256, 0);
+    }
+    for (i = 0; i < m; i++) {
+      for (j = 0; j < pcs; j++) {
+        if (memcmp(ilv + k*bytes + (j*m+i)*256, frags[k+i] + j*256, 256) != 0) {
+          problem("gf_matrix_region_multiply_strided encoded the wrong bytes");
+        }
+      }
+    }
+
+    /* Pieces that start off a 16-byte boundary, so every one of them has an
+       unaligned start and end, and strides that break the alignment rules. */
+
+    if (!(((gf_internal_t *) gf->scratch)->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY))) {
+      e = MOA_Random_W(w, 1);
+      MOA_Fill_Random_Region(ilv, (k+m) * bytes);
+      for (j = 0; j < 8; j++) {
+        memcpy(out[j], ilv + 4 + j*260, 256);
+        memcpy(out[j] + 256, ilv + 4 + (8+j)*260, 256);
+        gf->multiply_region.w32(gf, out[j], out[j] + 256, e, 256, 1);
+      }
+      if (!gf_region_multiply_strided(gf, ilv + 4, 260, ilv + 4 + 8*260, 260, e, 256, 8, 1)) {
+        problem("gf_region_multiply_strided failed");
+      }
+      for (j = 0; j < 8; j++) {
+        if (memcmp(out[j] + 256, ilv + 4 + (8+j)*260, 256) != 0) {
+          problem("gf_region_multiply_strided computed the wrong bytes");
+        }
+      }
+      if (gf_region_multiply_strided(gf, ilv, 256, ilv + bytes, 260, e, 256, 2, 0)) {
+        problem("gf_region_multiply_strided accepted misaligned strides");
+      }
+    }
+    free(ilv);
+
+    for (i = 0; i < k+m; i++) {
+      free(frags[i]);
+      free(out[i]);
+    }
+    free(frags);
+  }
+
+  ids[0] = ids[1];
+  if (gf_decode_cache_lookup(cache, ids, inv)) problem("The decode cache accepted duplicate survivors");
+
+  gf_decode_cache_free(cache);
+  free(coding);
+  free(dist);
+  free(ids);
+  free(mat);
+  free(copy);
+  free(inv);
+}
+
+void test_rs(gf_t *gf, int w)
+{
+  gf_rs_t *rs;
+  int k, nroots, bytes, words, i, p, e, j, pos, injected, rv;
+  uint8_t **data, **parity, **orig, *r;
+  uint32_t v;
+  char s[100];
+
+  /* The error decoder needs the standard region layout. */
+
+  if (w != 8 && w != 16) return;
+  if (((gf_internal_t *) gf->scratch)->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY)) {
+    if (gf_rs_create(gf, 20, 8) != NULL) problem("gf_rs_create accepted an ALTMAP/CAUCHY gf_t");
+    return;
+  }
+  if (verbose) { printf("Testing Reed-Solomon error correction.\n"); fflush(stdout); }
+
+  k = 20;
+  nroots = 8;
+  bytes = 4096 + 64*(w/8);
+  words = bytes / (w/8);
+
+  rs = gf_rs_create(gf, k, nroots);
+  if (rs == NULL) problem("gf_rs_create failed");
+
+  data = (uint8_t **) malloc(sizeof(uint8_t *) * (k+nroots) * 2);
+  parity = data + k;
+  orig = parity + nroots;
+  for (i = 0; i < k+nroots; i++) {
+    data[i] = alloc_region(bytes);
+    orig[i] = alloc_region(bytes);
+  }
+  for (i = 0; i < k; i++) MOA_Fill_Random_Region(data[i], bytes);
+  gf_rs_encode(rs, (void **) data, (void **) parity, bytes);
+  for (i = 0; i < k+nroots; i++) memcpy(orig[i], data[i], bytes);
+
+  /* The syndromes of valid codewords are all zero. */
+
+  if (!gf_rs_syndromes(rs, (void **) data, (void **) parity, (void **) orig+k, bytes)) problem("gf_rs_syndromes failed");
+  for (i = 0; i < nroots; i++) {
+    for (p = 0; p < bytes; p++) {
+      if (orig[k+i][p] != 0) problem("Non-zero syndrome in a freshly encoded codeword");
+    }
+  }
+  for (i = 0; i < nroots; i++) memcpy(orig[k+i], parity[i], bytes);
+
+  /* Corrupt up to nroots/2 symbols in every third codeword, and decode. */
+
+  injected = 0;
+  for (p = 0; p < words; p += 3) {
+    e = MOA_Random_W(8, 1) % (nroots/2 + 1);
+    for (j = 0; j < e; j++) {
+      pos = MOA_Random_W(16, 1) % (k+nroots);
+      r = data[pos];
+      v = MOA_Random_W(w, 0);
+      if (w == 8) {
+        if (r[p] != orig[pos][p]) continue;
+        r[p] ^= v;
+      } else {
+        if (((uint16_t *) r)[p] != ((uint16_t *) orig[pos])[p]) continue;
+        ((uint16_t *) r)[p] ^= v;
+      }
+      injected++;
+    }
+  }
+
+  rv = gf_rs_decode(rs, (void **) data, (void **) parity, bytes);
+  if (rv != injected) {
+    sprintf(s, "gf_rs_decode corrected %d symbols, but %d were corrupted", rv, injected);
+    problem(s);
+  }
+  for (i = 0; i < k+nroots; i++) {
+    if (memcmp(data[i], orig[i], bytes) != 0) problem("gf_rs_decode did not restore the codewords");
+  }
+
+  for (i = 0; i < k+nroots; i++) {
+    free(data[i]);
+    free(orig[i]);
+  }
+  free(data);
+  gf_rs_free(rs);
+}
+
+void test_lrc(gf_t *gf, int w)
+{
+  gf_lrc_t *lrc;
+  int k, l, r, n, bytes, i, j, g, it, e, ok, erasures[8];
+  uint8_t **frags, **orig, **sparse;
+  char s[100];
+
+  if (w < 4) return;
+  if (verbose) { printf("Testing Local Reconstruction Codes.\n"); fflush(stdout); }
+
+  k = 12;
+  l = 3;
+  r = 3;
+  n = k + l + r;
+  bytes = w * 1024;
+
+  lrc = gf_lrc_create(gf, k, l, r);
+  if (lrc == NULL) problem("gf_lrc_create failed");
+
+  frags = (uint8_t **) malloc(sizeof(uint8_t *) * n * 3);
+  orig = frags + n;
+  sparse = orig + n;
+  for (i = 0; i < n; i++) {
+    frags[i] = alloc_region(bytes);
+    orig[i] = alloc_region(bytes);
+  }
+  for (i = 0; i < k; i++) MOA_Fill_Random_Region(frags[i], bytes);
+  gf_lrc_encode(lrc, (void **) frags, (void **) frags+k, bytes);
+  for (i = 0; i < n; i++) memcpy(orig[i], frags[i], bytes);
+
+  /* Each local parity is the XOR of its group. */
+
+  for (g = 0; g < l; g++) {
+    memset(frags[0], 0, bytes);
+    for (i = 0; i < k; i++) {
+      if (gf_lrc_group(lrc, i) == g) gf_multby_one(orig[i], frags[0], bytes, 1);
+    }
+    if (memcmp(frags[0], orig[k+g], bytes) != 0) problem("An LRC local parity is not the XOR of its group");
+  }
+  memcpy(frags[0], orig[0], bytes);
+
+  /* Repair every fragment on its own.  Data and local parities must only touch
+     their own group, so every other pointer is NULL. */
+
+  for (i = 0; i < n; i++) {
+    g = gf_lrc_group(lrc, i);
+    for (j = 0; j < n; j++) {
+      sparse[j] = (g == -1 || gf_lrc_group(lrc, j) == g) ? frags[j] : NULL;
+    }
+    memset(frags[i], 0x5a, bytes);
+    if (!gf_lrc_repair(lrc, i, (void **) sparse, (void **) sparse+k, bytes)) problem("gf_lrc_repair failed");
+    if (memcmp(frags[i], orig[i], bytes) != 0) {
+      sprintf(s, "gf_lrc_repair rebuilt fragment %d incorrectly", i);
+      problem(s);
+    }
+  }
+
+  /* Any r erasures can be decoded.  With r+1, decoding may fail, but if it
+     succeeds, the fragments must be right. */
+
+  for (it = 0; it < 200; it++) {
+    e = (it % 2) ? r : r+1;
+    random_survivors(e, n, erasures);
+    erasures[e] = -1;
+    for (i = 0; i < e; i++) memset(frags[erasures[i]], 0x5a, bytes);
+    ok = gf_lrc_decode(lrc, erasures, (void **) frags, (void **) frags+k, bytes);
+    if (!ok && e <= r) problem("gf_lrc_decode failed on a decodable pattern");
+    if (ok) {
+      for (i = 0; i < n; i++) {
+        if (memcmp(frags[i], orig[i], bytes) != 0) problem("gf_lrc_decode rebuilt a fragment incorrectly");
+      }
+    } else {
+      for (i = 0; i < e; i++) memcpy(frags[erasures[i]], orig[erasures[i]], bytes);
+    }
+  }
+
+  for (i = 0; i < n; i++) {
+    free(frags[i]);
+    free(orig[i]);
+  }
+  free(frags);
+  gf_lrc_free(lrc);
+}
+
+void test_rlnc(gf_t *gf, int w)
+{
+  gf_rlnc_decoder_t *dec;
+  int k, bytes, i, j, sent, innovative;
+  uint8_t **src, *packet, *p;
+  uint32_t *coefs, *first;
+  char s[100];
+
+  if (verbose) { printf("Testing random linear network coding.\n"); fflush(stdout); }
+
+  k = 16;
+  bytes = w * 256;
+
+  src = (uint8_t **) malloc(sizeof(uint8_t *) * k);
+  for (i = 0; i < k; i++) {
+    src[i] = alloc_region(bytes);
+    MOA_Fill_Random_Region(src[i], bytes);
+  }
+  packet = alloc_region(bytes);
+  coefs = (uint32_t *) malloc(sizeof(uint32_t) * k * 2);
+  first = coefs + k;
+
+  dec = gf_rlnc_decoder_create(gf, k, bytes);
+  if (dec == NULL) problem("gf_rlnc_decoder_create failed");
+
+  /* A systematic packet is decoded as soon as it arrives, and it stays
+     decoded as coded packets are mixed in. */
+
+  memset(coefs, 0, sizeof(uint32_t) * k);
+  coefs[3] = 1;
+  gf_rlnc_encode(gf, k, (void **) src, coefs, packet, bytes);
+  if (gf_rlnc_decoder_add(dec, coefs, packet) != 1) problem("gf_rlnc_decoder_add rejected a systematic packet");
+  p = (uint8_t *) gf_rlnc_decoder_packet(dec, 3);
+  if (p == NULL || memcmp(p, src[3], bytes) != 0) problem("A systematic packet wasn't decoded right away");
+  if (gf_rlnc_decoder_packet(dec, 0) != NULL) problem("gf_rlnc_decoder_packet returned an undecoded packet");
+
+  /* Then coded packets, until the rank is k.  Every packet that doesn't raise
+     the rank must be rejected, and resending a packet never raises it. */
+
+  sent = 0;
+  for (i = 0; gf_rlnc_decoder_rank(dec) < k; i++) {
+    if (i == 100 * k) problem("gf_rlnc_decoder never reached full rank");
+    gf_rlnc_random_coefficients(gf, k, coefs);
+    gf_rlnc_encode(gf, k, (void **) src, coefs, packet, bytes);
+    j = gf_rlnc_decoder_rank(dec);
+    innovative = gf_rlnc_decoder_add(dec, coefs, packet);
+    if (gf_rlnc_decoder_rank(dec) != j + innovative) problem("gf_rlnc_decoder_add returned the wrong value");
+    if (innovative && sent == 0) {
+      memcpy(first, coefs, sizeof(uint32_t) * k);
+      sent = 1;
+      if (gf_rlnc_decoder_rank(dec) < k && gf_rlnc_decoder_add(dec, first, packet) != 0) {
+        problem("gf_rlnc_decoder_add accepted a duplicate packet");
+      }
+    }
+    p = (uint8_t *) gf_rlnc_decoder_packet(dec, 3);
+    if (p == NULL || memcmp(p, src[3], bytes) != 0) problem("A decoded packet changed");
+  }
+  if (gf_rlnc_decoder_add(dec, coefs, packet) != 0) problem("gf_rlnc_decoder_add accepted a packet past full rank");
+
+  for (i = 0; i < k; i++) {
+    p = (uint8_t *) gf_rlnc_decoder_packet(dec, i);
+    if (p == NULL || memcmp(p, src[i], bytes) != 0) {
+      sprintf(s, "gf_rlnc_decoder decoded packet %d incorrectly", i);
+      problem(s);
+    }
+  }
+
+  gf_rlnc_decoder_free(dec);
+  for (i = 0; i < k; i++) free(src[i]);
+  free(src);
+  free(packet);
+  free(coefs);
+}
+
+void test_fft(gf_t *gf, int w)
+{
+  gf_fft_t *fft;
+  int k, m, n, kp, bytes, i, l, it, e, *erasures;
+  uint8_t **frags, **orig;
+  uint32_t *matrix, x, v, p;
+
+  if (w < 4 || w > 16) return;
+  if (verbose) { printf("Testing additive FFT codes.\n"); fflush(stdout); }
+
+  /* For w = 16, m > K, so that coding spans more than one coset, and the
+     erasures can include all of the data. */
+
+  if (w == 16) {
+    k = 200;
+    m = 300;
+  } else if (w >= 8) {
+    k = 100;
+    m = 40;
+  } else {
+    k = (1 << (w-2)) + 1;
+    m = 1 << (w-3);
+  }
+  n = k + m;
+  bytes = w * 64;
+
+  fft = gf_fft_create(gf, k, m);
+  if (fft == NULL) problem("gf_fft_create failed");
+  if (gf_fft_create(gf, 1 << (w-1), (1 << (w-1)) + 1) != NULL) problem("gf_fft_create allowed K + m > 2^w");
+
+  frags = (uint8_t **) malloc(sizeof(uint8_t *) * n * 2);
+  orig = frags + n;
+  erasures = (int *) malloc(sizeof(int) * (n+1));
+  for (i = 0; i < n; i++) {
+    frags[i] = alloc_region(bytes);
+    orig[i] = alloc_region(bytes);
+  }
+  for (i = 0; i < k; i++) MOA_Fill_Random_Region(frags[i], bytes);
+  if (!gf_fft_encode(fft, (void **) frags, (void **) frags+k, bytes)) problem("gf_fft_encode failed");
+  for (i = 0; i < n; i++) memcpy(orig[i], frags[i], bytes);
+
+  /* Check the first and last coding fragments against the definition:  the
+     value at K+j of the polynomial of degree < K that is the data at 0 .. k-1
+     and zero at k .. K-1.  By Lagrange, that's a fixed linear combination of
+     the data. */
+
+  for (kp = 1; kp < k; kp <<= 1) ;
+  matrix = (uint32_t *) malloc(sizeof(uint32_t) * k);
+  for (it = 0; it < 2; it++) {
+    x = kp + ((it == 0) ? 0 : m-1);
+    for (i = 0; i < k; i++) {
+      v = 1;
+      for (l = 0; l < kp; l++) {
+        if (l == i) continue;
+        p = gf->divide.w32(gf, x ^ l, i ^ l);
+        v = gf->multiply.w32(gf, v, p);
+      }
+      matrix[i] = v;
+    }
+    memset(frags[k], 0, bytes);
+    for (i = 0; i < k; i++) gf->multiply_region.w32(gf, orig[i], frags[k], matrix[i], bytes, 1);
+    if (memcmp(frags[k], orig[(it == 0) ? k : n-1], bytes) != 0) problem("gf_fft_encode computed a coding fragment incorrectly");
+  }
+  memcpy(frags[k], orig[k], bytes);
+  free(matrix);
+
+  /* Any m erasures can be decoded, and m+1 are rejected. */
+
+  for (it = 0; it < 20; it++) {
+    e = (it == 0) ? m : 1 + (int) (MOA_Random_W(30, 1) % m);
+    if (it == 1 && m >= k) {
+      e = k;
+      for (i = 0; i < k; i++) erasures[i] = i;
+    } else {
+      random_survivors(e, n, erasures);
+    }
+    erasures[e] = -1;
+    for (i = 0; i < e; i++) memset(frags[erasures[i]], 0x5a, bytes);
+    if (!gf_fft_decode(fft, erasures, (void **) frags, (void **) frags+k, bytes)) problem("gf_fft_decode failed");
+    for (i = 0; i < n; i++) {
+      if (memcmp(frags[i], orig[i], bytes) != 0) problem("gf_fft_decode rebuilt a fragment incorrectly");
+    }
+  }
+  random_survivors(m+1, n, erasures);
+  erasures[m+1] = -1;
+  if (gf_fft_decode(fft, erasures, (void **) frags, (void **) frags+k, bytes)) problem("gf_fft_decode accepted m+1 erasures");
+
+  for (i = 0; i < n; i++) {
+    free(frags[i]);
+    free(orig[i]);
+  }
+  free(frags);
+  free(erasures);
+  gf_fft_free(fft);
+}
+
+void test_shamir(gf_t *gf, int w)
+{
+  int t, n, bytes, i, j, it, plain, ids[8];
+  uint8_t *secret, *out, *shares[8], *random[8], *sub[8];
+  uint32_t x, v, y;
+
+  if (w < 4) return;
+  if (verbose) { printf("Testing Shamir secret sharing.\n"); fflush(stdout); }
+
+  n = 7;
+  bytes = w * 1024 + w * 16;
+  plain = (w == 8 || w == 16 || w == 32) &&
+          !(((gf_internal_t *) gf->scratch)->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY));
+  secret = alloc_region(bytes);
+  out = alloc_region(bytes);
+  MOA_Fill_Random_Region(secret, bytes);
+  for (i = 0; i < n; i++) {
+    shares[i] = alloc_region(bytes);
+    random[i] = alloc_region(bytes);
+    MOA_Fill_Random_Region(random[i], bytes);
+  }
+
+  for (t = 1; t <= 4; t++) {
+    if (!gf_shamir_split(gf, t, n, secret, (void **) random, (void **) shares, bytes)) {
+      problem("gf_shamir_split failed");
+    }
+
+    /* The first word of each share is the polynomial's value at i+1.  This
+       only holds for the standard layout of w = 8, 16 and 32. */
+
+    if (plain) {
+      for (i = 0; i < n; i++) {
+        x = i+1;
+        v = 0;
+        for (j = t-1; j >= 0; j--) {
+          y = first_word((j == 0) ? secret : random[j-1], w);
+          v = gf->multiply.w32(gf, v, x) ^ y;
+        }
+        if (first_word(shares[i], w) != v) problem("gf_shamir_split computed a share incorrectly");
+      }
+    }
+
+    /* Every random set of t shares recovers the secret. */
+
+    for (it = 0; it < 20; it++) {
+      random_survivors(t, n, ids);
+      for (i = 0; i < t; i++) sub[i] = shares[ids[i]];
+      memset(out, 0x5a, bytes);
+      if (!gf_shamir_recover(gf, t, ids, (void **) sub, out, bytes)) problem("gf_shamir_recover failed");
+      if (memcmp(out, secret, bytes) != 0) problem("gf_shamir_recover recovered the wrong secret");
+    }
+  }
+
+  ids[0] = 2;
+  ids[1] = 2;
+  if (gf_shamir_recover(gf, 2, ids, (void **) shares, out, bytes)) problem("gf_shamir_recover accepted a repeated share");
+  if (gf_shamir_split(gf, n+1, n, secret, (void **) random, (void **) shares, bytes)) problem("gf_shamir_split accepted t > n");
+
+  for (i = 0; i < n; i++) {
+    free(shares[i]);
+    free(random[i]);
+  }
+  free(secret);
+  free(out);
+}
+
+/* Fills a dense matrix with random elements. */
+
+void random_dense(gf_dense_t *m, int w)
+{
+  int i, j;
+
+  for (i = 0; i < gf_dense_rows(m); i++) {
+    for (j = 0; j < gf_dense_cols(m); j++) gf_dense_set(m, i, j, MOA_Random_W(w, 1));
+  }
+}
+
+void test_dense(gf_t *gf, int w)
+{
+  gf_dense_t *a, *inv, *b, *x, *y;
+  int n, big, c, d, i, j, l, it;
+  uint32_t sum;
+
+  if (w != 4 && w != 8 && w != 16 && w != 32) return;
+  if (((gf_internal_t *) gf->scratch)->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY)) {
+    if (gf_dense_create(gf, 4, 4) != NULL) problem("gf_dense_create accepted an ALTMAP or CAUCHY field");
+    return;
+  }
+  if (verbose) { printf("Testing dense matrices.\n"); fflush(stdout); }
+
+  /* Small inverses, checked element by element. */
+
+  n = 50;
+  a = gf_dense_create(gf, n, n);
+  inv = gf_dense_create(gf, n, n);
+  if (a == NULL || inv == NULL) problem("gf_dense_create failed");
+  for (it = 0; it < 4; it++) {
+    do random_dense(a, w); while (gf_dense_rank(a) != n);
+    if (!gf_dense_invert(a, inv)) problem("gf_dense_invert failed on a full rank matrix");
+    for (i = 0; i < n; i++) {
+      for (j = 0; j < n; j++) {
+        sum = 0;
+        for (l = 0; l < n; l++) sum ^= gf->multiply.w32(gf, gf_dense_get(a, i, l), gf_dense_get(inv, l, j));
+        if (sum != (i == j)) problem("gf_dense_invert computed the wrong inverse");
+      }
+    }
+  }
+
+  /* A singular matrix:  row 7 is the sum of rows 3 and 5. */
+
+  for (j = 0; j < n; j++) gf_dense_set(a, 7, j, gf_dense_get(a, 3, j) ^ gf_dense_get(a, 5, j));
+  if (gf_dense_rank(a) != n-1) problem("gf_dense_rank is wrong for a singular matrix");
+  if (gf_dense_invert(a, inv)) problem("gf_dense_invert inverted a singular matrix");
+  gf_dense_free(a);
+  gf_dense_free(inv);
+
+  /* A matrix that is bigger than the L2 cache, so that elimination is done in
+     panels:  solve a x = b, for a known x. */
+
+  big = (w == 4) ? 800 : (w == 8) ? 600 : (w == 16) ? 400 : 300;
+  c = 3;
+  a = gf_dense_create(gf, big, big);
+  b = gf_dense_create(gf, big, c);
+  x = gf_dense_create(gf, big, c);
+  y = gf_dense_create(gf, big, c);
+  random_dense(a, w);
+  random_dense(x, w);
+  for (i = 0; i < big; i++) {
+    for (j = 0; j < c; j++) {
+      sum = 0;
+      for (l = 0; l < big; l++) sum ^= gf->multiply.w32(gf, gf_dense_get(a, i, l), gf_dense_get(x, l, j));
+      gf_dense_set(b, i, j, sum);
+    }
+  }
+  if (gf_dense_solve(a, b, y)) {
+    for (i = 0; i < big; i++) {
+      for (j = 0; j < c; j++) {
+        if (gf_dense_get(y, i, j) != gf_dense_get(x, i, j)) problem("gf_dense_solve computed the wrong solution");
+      }
+    }
+  } else if (gf_dense_rank(a) == big) {
+    problem("gf_dense_solve failed on a full rank matrix");
+  }
+
+  /* The last d rows are combinations of the others, and the rest have full
+     rank with high probability, since they're random and wide. */
+
+  d = 10;
+  for (i = big-d; i < big; i++) {
+    memset(gf_dense_row(a, i), 0, (big * w + 7) / 8);
+    for (l = 0; l < big-d; l++) {
+      gf->multiply_region.w32(gf, gf_dense_row(a, l), gf_dense_row(a, i), MOA_Random_W(w, 1), (big * w + 7) / 8, 1);
+    }
+  }
+  if (gf_dense_rank(a) != big-d) problem("gf_dense_rank is wrong for a large matrix");
+
+  gf_dense_free(a);
+  gf_dense_free(b);
+  gf_dense_free(x);
+  gf_dense_free(y);
+}
+
+void test_gemm(gf_t *gf, int w)
+{
+  gf_internal_t *h;
+  int m, k, bytes, i, it, xor, threads, shift;
+  uint32_t *a;
+  uint8_t **b, **c, **ref, **bs, **cs;
+
+  if (w != 4 && w != 8 && w != 16 && w != 32) return;
+  if (verbose) { printf("Testing gf_gemm.\n"); fflush(stdout); }
+  h = (gf_internal_t *) gf->scratch;
+
+  /* Six rows is a block of four and a block of two, and the size leaves a
+     partial tile at the end. */
+
+  m = 6;
+  k = 10;
+  bytes = w * 1000 + ((h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY)) ? 0 : 2 * w);
+
+  a = (uint32_t *) malloc(sizeof(uint32_t) * m * k);
+  b = (uint8_t **) malloc(sizeof(uint8_t *) * (k*2 + m*3));
+  bs = b + k;
+  c = bs + k;
+  ref = c + m;
+  cs = ref + m;
+  for (i = 0; i < k; i++) {
+    b[i] = alloc_region(bytes + 16);
+    MOA_Fill_Random_Region(b[i], bytes + 16);
+  }
+  for (i = 0; i < m; i++) {
+    c[i] = alloc_region(bytes + 16);
+    ref[i] = alloc_region(bytes);
+  }
+
+  for (it = 0; it < 8; it++) {
+    xor = it & 1;
+    threads = (it & 2) ? 3 : 1;
+
+    /* The tiled kernels take any alignment, so shift the regions by a word,
+       and by different amounts for B and C. */
+
+    shift = ((it & 4) && (w == 8 || w == 16) &&
+             !(h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY))) ? w/8 : 0;
+    for (i = 0; i < m*k; i++) a[i] = MOA_Random_W(w, 1);
+    if (it == 0) a[1] = 0;
+    for (i = 0; i < k; i++) bs[i] = b[i] + shift;
+    for (i = 0; i < m; i++) {
+      cs[i] = c[i] + 2*shift;
+      MOA_Fill_Random_Region(cs[i], bytes);
+      memcpy(ref[i], cs[i], bytes);
+    }
+    for (i = 0; i < k; i++) memmove(b[i], bs[i], bytes);
+    gf_matrix_region_multiply(gf, a, m, k, (void **) b, (void **) ref, bytes, xor);
+    for (i = 0; i < k; i++) memmove(bs[i], b[i], bytes);
+
+    if (!gf_gemm(gf, m, k, a, (void **) bs, (void **) cs, bytes, xor, threads)) problem("gf_gemm failed");
+    for (i = 0; i < m; i++) {
+      if (memcmp(cs[i], ref[i], bytes) != 0) problem("gf_gemm doesn't match gf_matrix_region_multiply");
+    }
+  }
+
+  for (i = 0; i < k; i++) free(b[i]);
+  for (i = 0; i < m; i++) {
+    free(c[i]);
+    free(ref[i]);
+  }
+  free(b);
+  free(a);
+}
+
+/* A random polynomial with d+1 coefficients and a non-zero leading one. */
+
+void random_poly(uint32_t *p, int d, int w)
+{
+  int i;
+
+  for (i = 0; i < d; i++) p[i] = MOA_Random_W(w, 1);
+  do p[d] = MOA_Random_W(w, 1); while (p[d] == 0);
+}
+
+/* c = a * b, the slow way. */
+
+void naive_poly_multiply(gf_t *gf, uint32_t *a, int da, uint32_t *b, int db, uint32_t *c)
+{
+  int i, j;
+
+  memset(c, 0, sizeof(uint32_t) * (da + db + 1));
+  for (i = 0; i <= da; i++) {
+    for (j = 0; j <= db; j++) c[i+j] ^= gf->multiply.w32(gf, a[i], b[j]);
+  }
+}
+
+void test_poly(gf_t *gf, int w)
+{
+  /* Operand degrees for schoolbook (with and without multiply_region),
+     Karatsuba, unbalanced Karatsuba, long division (with and without
+     multiply_region) and Newton division. */
+
+  int sizes[7][2] = { { 5, 7 }, { 20, 400 }, { 40, 300 }, { 200, 200 }, { 150, 100 }, { 300, 200 },
+                      { 700, 300 } };
+  uint32_t *a, *b, *c, *d, *q, *r, *xs, *ys, *zs;
+  int i, it, da, db, dc, dq, dr, n, mx;
+
+  if (verbose) { printf("Testing polynomial arithmetic.\n"); fflush(stdout); }
+  mx = 1024;
+  a = (uint32_t *) malloc(sizeof(uint32_t) * mx * 9);
+  b = a + mx;
+  c = b + mx;
+  d = c + mx;
+  q = d + mx;
+  r = q + mx;
+  xs = r + mx;
+  ys = xs + mx;
+  zs = ys + mx;
+
+  for (it = 0; it < 7; it++) {
+    da = sizes[it][0];
+    db = sizes[it][1];
+    random_poly(a, da, w);
+    random_poly(b, db, w);
+    if (gf_poly_multiply(gf, a, da, b, db, c) != da + db) problem("gf_poly_multiply returned the wrong degree");
+    naive_poly_multiply(gf, a, da, b, db, d);
+    if (memcmp(c, d, sizeof(uint32_t) * (da + db + 1)) != 0) problem("gf_poly_multiply computed the wrong product");
+
+    /* a = q b + r, which is checked by multiplying back. */
+
+    dr = gf_poly_divide(gf, a, da, b, db, q, r);
+    if (dr >= db) problem("gf_poly_divide returned a remainder that is too big");
+    if (da >= db) {
+      naive_poly_multiply(gf, q, da - db, b, db, d);
+      dc = gf_poly_add(gf, d, da, r, dr, d);
+      if (dc != da || memcmp(d, a, sizeof(uint32_t) * (da + 1)) != 0) problem("gf_poly_divide: q * b + r is not a");
+    } else if (dr != da || memcmp(r, a, sizeof(uint32_t) * (da + 1)) != 0) {
+      problem("gf_poly_divide changed a dividend that is smaller than the divisor");
+    }
+
+    /* The remainder in place, and the remainder of a multiple of b. */
+
+    memcpy(d, a, sizeof(uint32_t) * (da + 1));
+    if (gf_poly_divide(gf, d, da, b, db, NULL, d) != dr || memcmp(d, r, sizeof(uint32_t) * (dr + 1)) != 0) {
+      problem("gf_poly_divide computed a different remainder in place");
+    }
+    if (gf_poly_divide(gf, c, da + db, b, db, q, r) != -1) problem("gf_poly_divide: a * b mod b is not zero");
+    if (memcmp(q, a, sizeof(uint32_t) * (da + 1)) != 0) problem("gf_poly_divide: a * b / b is not a");
+  }
+  if (gf_poly_divide(gf, a, 5, r, -1, q, r) != -2) problem("gf_poly_divide divided by zero");
+
+  /* g divides gcd(g u, g v), which divides both. */
+
+  random_poly(d, 10, w);
+  random_poly(a, 120, w);
+  random_poly(b, 70, w);
+  gf_poly_multiply(gf, d, 10, a, 120, c);
+  gf_poly_multiply(gf, d, 10, b, 70, q);
+  dc = gf_poly_gcd(gf, c, 130, q, 80, a);
+  if (dc < 10 || a[dc] != 1) problem("gf_poly_gcd returned a bad gcd");
+  if (gf_poly_divide(gf, a, dc, d, 10, NULL, r) != -1) problem("gf_poly_gcd: g doesn't divide the gcd");
+  if (gf_poly_divide(gf, c, 130, a, dc, NULL, r) != -1) problem("gf_poly_gcd: the gcd doesn't divide a");
+  if (gf_poly_divide(gf, q, 80, a, dc, NULL, r) != -1) problem("gf_poly_gcd: the gcd doesn't divide b");
+
+  /* Multipoint evaluation at distinct points, which are an affine map of
+     0 .. n-1 mod 2^w, and interpolation back. */
+
+  n = (w < 10) ? (1 << w) : 700;
+  dq = (MOA_Random_W(32, 1) | 1);
+  dr = MOA_Random_W(32, 1);
+  for (i = 0; i < n; i++) {
+    xs[i] = (uint32_t) (i * dq + dr);
+    if (w < 32) xs[i] &= ((1 << w) - 1);
+  }
+  random_poly(a, 300, w);
+  if (!gf_poly_evaluate_multi(gf, a, 300, xs, n, ys)) problem("gf_poly_evaluate_multi failed");
+  for (i = 0; i < n; i++) {
+    if (ys[i] != gf_poly_evaluate(gf, a, 300, xs[i])) problem("gf_poly_evaluate_multi computed a wrong value");
+  }
+
+  for (i = 0; i < n; i++) ys[i] = MOA_Random_W(w, 1);
+  dc = gf_poly_interpolate(gf, xs, ys, n, c);
+  if (dc >= n) problem("gf_poly_interpolate returned a bad degree");
+  if (!gf_poly_evaluate_multi(gf, c, dc, xs, n, zs)) problem("gf_poly_evaluate_multi failed");
+  if (memcmp(ys, zs, sizeof(uint32_t) * n) != 0) problem("gf_poly_interpolate doesn't go through the points");
+  if (n > 1) {
+    xs[n-1] = xs[0];
+    if (gf_poly_interpolate(gf, xs, ys, n, c) != -2) problem("gf_poly_interpolate accepted a repeated point");
+  }
+
+  free(a);
+}
+
+/* Reads a whole temporary file back from the start. */
+
+uint8_t *read_back(FILE *f, long *len)
+{
+  uint8_t *buf;
+
+  fflush(f);
+  *len = lseek(fileno(f), 0, SEEK_END);
+  lseek(fileno(f), 0, SEEK_SET);
+  buf = (uint8_t *) malloc(*len + 1);
+  if (read(fileno(f), buf, *len) != *len) problem("Couldn't read a temporary file back");
+  return buf;
+}
+
+void test_stream(gf_t *gf, int w)
+{
+  int k, m, chunk, size, stripes, it, i, j, *fds;
+  uint32_t *coding;
+  uint8_t *input, *stripe, **out;
+  void **ptrs;
+  FILE *in, **files;
+  gf_stream_t *s;
+  int64_t rv;
+  long len;
+
+  if (w > 32 || (w < 31 && (1 << w) < 6)) return;
+  if (verbose) { printf("Testing the streaming encoder.\n"); fflush(stdout); }
+
+  k = 4;
+  m = 2;
+  chunk = w * 256;
+  coding = cauchy_coding_matrix(gf, k, m);
+  if (gf_stream_create(gf, k, m, coding, chunk + 32, 2) != NULL) problem("gf_stream_create accepted a bad chunk size");
+  if (gf_stream_create(gf, k, m, coding, chunk, 1) != NULL) problem("gf_stream_create accepted a depth of 1");
+  s = gf_stream_create(gf, k, m, coding, chunk, 3);
+  if (s == NULL) problem("gf_stream_create failed");
+
+  files = (FILE **) malloc(sizeof(FILE *) * (k+m));
+  fds = (int *) malloc(sizeof(int) * (k+m));
+  out = (uint8_t **) malloc(sizeof(uint8_t *) * (k+m));
+  ptrs = (void **) malloc(sizeof(void *) * (k+m));
+  stripe = alloc_region((k+m) * chunk);
+
+  /* An empty input, a partial stripe, an exact number of stripes, and more
+     stripes than buffers with a partial one at the end. */
+
+  for (it = 0; it < 4; it++) {
+    size = (it == 0) ? 0 : (it == 1) ? 1000 : (it == 2) ? 5 * k * chunk : 11 * k * chunk + 333;
+    input = (uint8_t *) malloc(size + 1);
+    MOA_Fill_Random_Region(input, size);
+    in = tmpfile();
+    if (in == NULL) problem("tmpfile failed");
+    if (size > 0 && fwrite(input, 1, size, in) != (size_t) size) problem("Couldn't write the input");
+    fflush(in);
+    lseek(fileno(in), 0, SEEK_SET);
+    for (i = 0; i < k+m; i++) {
+      files[i] = tmpfile();
+      if (files[i] == NULL) problem("tmpfile failed");
+      fds[i] = fileno(files[i]);
+    }
+
+    rv = gf_stream_encode(s, fileno(in), fds, fds + k);
+    if (rv != size) problem("gf_stream_encode returned the wrong size");
+
+    stripes = (size + k * chunk - 1) / (k * chunk);
+    for (i = 0; i < k+m; i++) {
+      out[i] = read_back(files[i], &len);
+      if (len != (long) stripes * chunk) problem("gf_stream_encode wrote files of the wrong size");
+    }
+
+    /* Each stripe must be the padded input, and its coding. */
+
+    for (j = 0; j < stripes; j++) {
+      memset(stripe, 0, k * chunk);
+      len = (size - j * k * chunk < k * chunk) ? size - j * k * chunk : k * chunk;
+      memcpy(stripe, input + j * k * chunk, len);
+      for (i = 0; i < k+m; i++) ptrs[i] = stripe + i * chunk;
+      gf_matrix_region_multiply(gf, coding, m, k, ptrs, ptrs + k, chunk, 0);
+      for (i = 0; i < k+m; i++) {
+        if (memcmp(out[i] + j * chunk, ptrs[i], chunk) != 0) problem("gf_stream_encode wrote the wrong data");
+      }
+    }
+
+    for (i = 0; i < k+m; i++) {
+      free(out[i]);
+      fclose(files[i]);
+    }
+    fclose(in);
+    free(input);
+  }
+
+  /* A write error:  a coding file that is read-only. */
+
+  in = tmpfile();
+  input = (uint8_t *) malloc(k * chunk);
+  MOA_Fill_Random_Region(input, k * chunk);
+  if (fwrite(input, 1, k * chunk, in) != (size_t) (k * chunk)) problem("Couldn't write the input");
+  fflush(in);
+  lseek(fileno(in), 0, SEEK_SET);
+  for (i = 0; i < k+m; i++) fds[i] = (i == k) ? open("/dev/null", O_RDONLY) : open("/dev/null", O_WRONLY);
+  if (gf_stream_encode(s, fileno(in), fds, fds + k) != -1) problem("gf_stream_encode didn't report a write error");
+  for (i = 0; i < k+m; i++) close(fds[i]);
+  fclose(in);
+  free(input);
+
+  gf_stream_free(s);
+  free(stripe);
+  free(files);
+  free(fds);
+  free(out);
+  free(ptrs);
+  free(coding);
+}
+
+/* Several threads share one gf_t and multiply the same source region by
+   different values, each checking its products against ones computed
+   beforehand by a single thread.  They do the same with single multiplies.
+   The tables that depend on the value must not be shared between the
+   threads.  This is the one test that also runs with w = 64 and 128, where
+   a value is val[0], or val[0] and val[1]. */
+
+#define THREADS (4)
+#define THREAD_VALS (8)
+
+typedef struct {
+  gf_t *gf;
+  int w;
+  int id;
+  int bytes;
+  uint8_t *src;
+  uint8_t *dest;
+  uint64_t (*vals)[2];
+  uint64_t (*a)[2];
+  uint64_t (*prod)[2];
+  uint8_t **ref;
+  int failed;
+} thread_test_t;
+
+void thread_region_multiply(gf_t *gf, int w, void *src, void *dest, uint64_t *val, int bytes)
+{
+  if (w <= 32) {
+    gf->multiply_region.w32(gf, src, dest, val[0], bytes, 0);
+  } else if (w == 64) {
+    gf->multiply_region.w64(gf, src, dest, val[0], bytes, 0);
+  } else {
+    gf->multiply_region.w128(gf, src, dest, val, bytes, 0);
+  }
+}
+
+void thread_multiply(gf_t *gf, int w, uint64_t *a, uint64_t *b, uint64_t *c)
+{
+  c[1] = 0;
+  if (w <= 32) {
+    c[0] = gf->multiply.w32(gf, a[0], b[0]);
+  } else if (w == 64) {
+    c[0] = gf->multiply.w64(gf, a[0], b[0]);
+  } else {
+    gf->multiply.w128(gf, a, b, c);
+  }
+}
+
+void *thread_test(void *arg)
+{
+  thread_test_t *t;
+  uint64_t c[2];
+  int i, j, v;
+
+  t = (thread_test_t *) arg;
+  for (i = 0; i < 200 && !t->failed; i++) {
+    v = (i * (t->id + 1) + t->id) % THREAD_VALS;
+    thread_region_multiply(t->gf, t->w, t->src, t->dest, t->vals[v], t->bytes);
+    if (memcmp(t->dest, t->ref[v], t->bytes) != 0) t->failed = 1;
+    for (j = 0; j < THREAD_VALS; j++) {
+      v = (v + t->id + 1) % THREAD_VALS;
+      thread_multiply(t->gf, t->w, t->a[v], t->vals[v], c);
+      if (c[0] != t->prod[v][0] || c[1] != t->prod[v][1]) t->failed = 1;
+    }
+  }
+  return NULL;
+}
+
+void test_threads(gf_t *gf, int w)
+{
+  thread_test_t t[THREADS];
+  pthread_t tid[THREADS];
+  uint64_t vals[THREAD_VALS][2], a[THREAD_VALS][2], prod[THREAD_VALS][2];
+  uint8_t *src, *ref[THREAD_VALS];
+  int bytes, i, started[THREADS];
+
+  if (verbose) { printf("Testing region multiplies from %d threads.\n", THREADS); fflush(stdout); }
+
+  bytes = w * 256;
+  src = alloc_region(bytes);
+  MOA_Fill_Random_Region(src, bytes);
+  for (i = 0; i < THREAD_VALS; i++) {
+    vals[i][1] = 0;
+    a[i][1] = 0;
+    if (w <= 32) {
+      do vals[i][0] = MOA_Random_W(w, 1); while (vals[i][0] < 2);
+      a[i][0] = MOA_Random_W(w, 1);
+    } else if (w == 64) {
+      do vals[i][0] = MOA_Random_64(); while (vals[i][0] < 2);
+      a[i][0] = MOA_Random_64();
+    } else {
+      do MOA_Random_128(vals[i]); while (vals[i][0] == 0 && vals[i][1] < 2);
+      MOA_Random_128(a[i]);
+    }
+    ref[i] = alloc_region(bytes);
+    thread_region_multiply(gf, w, src, ref[i], vals[i], bytes);
+    thread_multiply(gf, w, a[i], vals[i], prod[i]);
+  }
+
+  for (i = 0; i < THREADS; i++) {
+    t[i].gf = gf;
+    t[i].w = w;
+    t[i].id = i;
+    t[i].bytes = bytes;
+    t[i].src = src;
+    t[i].dest = alloc_region(bytes);
+    t[i].vals = vals;
+    t[i].a = a;
+    t[i].prod = prod;
+    t[i].ref = ref;
+    t[i].failed = 0;
+    started[i] = (pthread_create(tid + i, NULL, thread_test, t + i) == 0);
+    if (!started[i]) thread_test(t + i);
+  }
+  for (i = 0; i < THREADS; i++) {
+    if (started[i]) pthread_join(tid[i], NULL);
+    if (t[i].failed) problem("A multiply from a thread sharing the gf_t was wrong");
+    free(t[i].dest);
+  }
+  for (i = 0; i < THREAD_VALS; i++) free(ref[i]);
+  free(src);
+}
+
+/* Encodes a batch of stripes of uneven sizes, some of them several blocks
+   long, and checks the coding against gf_matrix_region_multiply().  Then it
+   rebuilds a data and a coding fragment of every stripe from random
+   survivors. */
+
+#define BATCH_STRIPES (10)
+
+void test_batch(gf_t *gf, int w)
+{
+  gf_parallel_stripe_t st[BATCH_STRIPES];
+  gf_decode_cache_t *cache;
+  uint32_t *coding;
+  uint8_t *frags[BATCH_STRIPES][6], *out[BATCH_STRIPES][2], *ref[2];
+  int k, m, i, j, want[2], survivors[BATCH_STRIPES][4], altmap;
+
+  if (w < 3) return;
+  k = 4;
+  m = 2;
+  coding = cauchy_coding_matrix(gf, k, m);
+  want[0] = 1;
+  want[1] = k;
+  altmap = (((gf_internal_t *) gf->scratch)->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY)) != 0;
+
+  /* The last stripe is empty. */
+
+  for (i = 0; i < BATCH_STRIPES; i++) {
+    st[i].bytes = (i == BATCH_STRIPES-1) ? 0 : w * 8192 * (i % 3) + w * 256 * (1 + (i*7) % 5);
+    for (j = 0; j < k+m; j++) frags[i][j] = alloc_region(st[i].bytes + 1);
+    for (j = 0; j < 2; j++) out[i][j] = alloc_region(st[i].bytes + 1);
+    for (j = 0; j < k; j++) MOA_Fill_Random_Region(frags[i][j], st[i].bytes);
+    st[i].src = (void **) frags[i];
+    st[i].dest = (void **) (frags[i] + k);
+  }
+  if (!gf_parallel_encode_stripes(gf, k, m, coding, st, BATCH_STRIPES)) problem("gf_parallel_encode_stripes failed");
+
+  for (i = 0; i < BATCH_STRIPES; i++) {
+    ref[0] = alloc_region(st[i].bytes + 1);
+    ref[1] = alloc_region(st[i].bytes + 1);
+    gf_matrix_region_multiply(gf, coding, m, k, (void **) frags[i], (void **) ref, st[i].bytes, 0);
+    for (j = 0; j < m; j++) {
+      if (memcmp(ref[j], frags[i][k+j], st[i].bytes) != 0) problem("gf_parallel_encode_stripes computed the wrong coding");
+    }
+    free(ref[0]);
+    free(ref[1]);
+  }
+
+  cache = gf_decode_cache_create(gf, k, m, coding, 4);
+  if (cache == NULL) problem("gf_decode_cache_create failed");
+  for (i = 0; i < BATCH_STRIPES; i++) {
+    random_survivors(k, k+m, survivors[i]);
+    st[i].dest = (void **) out[i];
+    st[i].survivors = survivors[i];
+    st[i].nwant = 2;
+    st[i].want = want;
+  }
+  if (gf_parallel_decode_stripes(gf, cache, st, BATCH_STRIPES) == altmap) {
+    problem("gf_parallel_decode_stripes failed, or accepted an ALTMAP/CAUCHY gf_t");
+  }
+  for (i = 0; i < BATCH_STRIPES && !altmap; i++) {
+    for (j = 0; j < 2; j++) {
+      if (memcmp(out[i][j], frags[i][want[j]], st[i].bytes) != 0) problem("gf_parallel_decode_stripes rebuilt the wrong bytes");
+    }
+  }
+
+  gf_decode_cache_free(cache);
+  for (i = 0; i < BATCH_STRIPES; i++) {
+    for (j = 0; j < k+m; j++) free(frags[i][j]);
+    for (j = 0; j < 2; j++) free(out[i][j]);
+  }
+  free(coding);
+}
+
+/* Encodes batches of many small stripes over and over while another thread
+   keeps replacing the pool, growing and shrinking it, and checks the coding
+   of the last batch. */
+
+#define RESIZE_STRIPES (64)
+#define RESIZE_BATCHES (2000)
+
+typedef struct {
+  int done;
+  int failed;
+} resize_test_t;
+
+void *resize_thread(void *arg)
+{
+  resize_test_t *r;
+  int i;
+
+  r = (resize_test_t *) arg;
+  for (i = 0; !__atomic_load_n(&r->done, __ATOMIC_ACQUIRE); i++) {
+    if (!gf_parallel_init((i % 2) ? 2 : 8, 1)) r->failed = 1;
+    usleep(200);   /* Lets some batches find the pool idle */
+  }
+  return NULL;
+}
+
+void test_batch_resize(gf_t *gf, int w)
+{
+  gf_parallel_stripe_t st[RESIZE_STRIPES];
+  uint32_t *coding;
+  uint8_t *frags[6], *ref[2];
+  pthread_t tid;
+  resize_test_t rt;
+  int k, m, i, j, bytes, started;
+
+  if (w < 3) return;
+  k = 4;
+  m = 2;
+  bytes = w * 64;
+  coding = cauchy_coding_matrix(gf, k, m);
+  for (j = 0; j < k+m; j++) frags[j] = alloc_region(bytes * RESIZE_STRIPES);
+  for (j = 0; j < k; j++) MOA_Fill_Random_Region(frags[j], bytes * RESIZE_STRIPES);
+  for (i = 0; i < RESIZE_STRIPES; i++) {
+    st[i].bytes = bytes;
+    st[i].src = (void **) malloc(sizeof(void *) * (k+m));
+    for (j = 0; j < k+m; j++) st[i].src[j] = frags[j] + i * bytes;
+    st[i].dest = st[i].src + k;
+  }
+
+  if (!gf_parallel_init(2, 1)) problem("gf_parallel_init failed");
+  rt.done = 0;
+  rt.failed = 0;
+  started = (pthread_create(&tid, NULL, resize_thread, &rt) == 0);
+  for (i = 0; i < RESIZE_BATCHES; i++) {
+    if (!gf_parallel_encode_stripes(gf, k, m, coding, st, RESIZE_STRIPES)) {
+      problem("gf_parallel_encode_stripes failed while the pool was replaced");
+    }
+  }
+  __atomic_store_n(&rt.done, 1, __ATOMIC_RELEASE);
+  if (started) pthread_join(tid, NULL);
+  if (rt.failed) problem("gf_parallel_init failed while batches were running");
+
+  ref[0] = alloc_region(bytes);
+  ref[1] = alloc_region(bytes);
+  for (i = 0; i < RESIZE_STRIPES; i++) {
+    gf_matrix_region_multiply(gf, coding, m, k, st[i].src, (void **) ref, bytes, 0);
+    for (j = 0; j < m; j++) {
+      if (memcmp(ref[j], st[i].dest[j], bytes) != 0) {
+        problem("gf_parallel_encode_stripes computed the wrong coding while the pool was replaced");
+      }
+    }
+  }
+
+  free(ref[0]);
+  free(ref[1]);
+  for (i = 0; i < RESIZE_STRIPES; i++) free(st[i].src);
+  for (j = 0; j < k+m; j++) free(frags[j]);
+  free(coding);
+}
+
+/* Multiplies a region that starts off a cache line on the thread pool, with
+   a threshold low enough that it is cut into many chunks, and compares it to
+   gf->multiply_region.  Regions that can't be cut go inline, and must match
+   just the same. */
+
+void test_parallel(gf_t *gf, int w)
+{
+  gf_internal_t *h;
+  gf_general_t val;
+  uint8_t *src, *dest, *ref;
+  int bytes, off, i, xor;
+
+  if (verbose) { printf("Testing parallel region multiplies and stripe batches.\n"); fflush(stdout); }
+
+  h = (gf_internal_t *) gf->scratch;
+  off = 8;
+  if ((h->region_type & (GF_REGION_ALTMAP | GF_REGION_CAUCHY)) || (w != 4 && w != 8 && w != 16 && w != 32)) off = 0;
+  bytes = w * 2048 - off;
+  src = alloc_region(bytes + off);
+  dest = alloc_region(bytes + off);
+  ref = alloc_region(bytes + off);
+
+  if (!gf_parallel_init(4, 1)) problem("gf_parallel_init failed");
+  for (i = 0; i < 8; i++) {
+
+    /* Replacing the pool halfway through must not change anything. */
+
+    if (i == 4 && !gf_parallel_init(3, 1)) problem("gf_parallel_init failed the second time");
+    xor = i % 2;
+    do val.w32 = MOA_Random_W(w, 1); while (val.w32 < 2);
+    MOA_Fill_Random_Region(src + off, bytes);
+    MOA_Fill_Random_Region(dest + off, bytes);
+    memcpy(ref + off, dest + off, bytes);
+    gf->multiply_region.w32(gf, src + off, ref + off, val.w32, bytes, xor);
+    gf_parallel_multiply_region(gf, src + off, dest + off, &val, bytes, xor);
+    if (memcmp(dest + off, ref + off, bytes) != 0) problem("gf_parallel_multiply_region doesn't match multiply_region");
+  }
+  test_batch(gf, w);
+
+  test_batch_resize(gf, w);
+  gf_parallel_free();
+
+  /* Without the pool, it is a plain multiply_region. */
+
+  gf_parallel_multiply_region(gf, src + off, dest + off, &val, bytes, 0);
+  gf->multiply_region.w32(gf, src + off, ref + off, val.w32, bytes, 0);
+  if (memcmp(dest + off, ref + off, bytes) != 0) problem("gf_parallel_multiply_region without a pool doesn't match");
+  test_batch(gf, w);
+
+  free(src);
+  free(dest);
+  free(ref);
+}
+
+/* Keeps a small queue full of multiply, dot product and encode jobs,
+   collecting completions with gf_async_poll() and gf_async_wait() whenever
+   it is full, and checks every job's output against the synchronous calls.
+   It does so with two workers, and with none, where the jobs run in the
+   pollers. */
+
+#define ASYNC_JOBS (48)
+
+void test_async(gf_t *gf, int w)
+{
+  gf_async_t *q;
+  gf_async_job_t job;
+  gf_async_completion_t c[ASYNC_JOBS];
+  uint8_t *src[4], *out[ASYNC_JOBS][2], *ref[2];
+  uint32_t vals[ASYNC_JOBS][8];
+  int bytes, i, j, n, got, seen[ASYNC_JOBS], ops[ASYNC_JOBS], nthreads;
+
+  if (verbose) { printf("Testing the asynchronous job queue.\n"); fflush(stdout); }
+
+  bytes = w * 512;
+  for (i = 0; i < 4; i++) {
+    src[i] = alloc_region(bytes);
+    MOA_Fill_Random_Region(src[i], bytes);
+  }
+  ref[0] = alloc_region(bytes);
+  ref[1] = alloc_region(bytes);
+  for (i = 0; i < ASYNC_JOBS; i++) {
+    out[i][0] = alloc_region(bytes);
+    out[i][1] = alloc_region(bytes);
+  }
+
+  for (nthreads = 2; nthreads >= 0; nthreads -= 2) {
+    q = gf_async_create(gf, 5, nthreads);
+    if (q == NULL) problem("gf_async_create failed");
+    for (i = 0; i < ASYNC_JOBS; i++) seen[i] = 0;
+
+    got = 0;
+    for (i = 0; i < ASYNC_JOBS; i++) {
+      ops[i] = i % 3;
+      for (j = 0; j < 8; j++) vals[i][j] = MOA_Random_W(w, 1);
+      job.op = ops[i];
+      job.src = (void **) src;
+      job.nsrc = (ops[i] == GF_ASYNC_MULTIPLY) ? 1 : 4;
+      job.dest = (void **) out[i];
+      job.ndest = (ops[i] == GF_ASYNC_ENCODE) ? 2 : 1;
+      job.vals = vals[i];
+      job.bytes = bytes;
+      job.xor = 0;
+      job.user_data = i;
+
+      /* The queue rounds 5 up to 8 entries. */
+
+      while (!gf_async_submit(q, &job)) {
+        if (i - got < 8) problem("gf_async_submit refused a job with room in the queue");
+        n = (i % 2) ? gf_async_wait(q, c + got, 1, ASYNC_JOBS - got) : gf_async_poll(q, c + got, ASYNC_JOBS - got);
+        got += n;
+      }
+    }
+    got += gf_async_wait(q, c + got, ASYNC_JOBS - got, ASYNC_JOBS - got);
+    if (got != ASYNC_JOBS) problem("gf_async_wait returned before every job completed");
+    if (gf_async_poll(q, c, 1) != 0) problem("gf_async_poll returned a completion twice");
+
+    for (i = 0; i < ASYNC_JOBS; i++) {
+      j = (int) c[i].user_data;
+      if (j < 0 || j >= ASYNC_JOBS || seen[j]) problem("gf_async returned a bad or repeated user_data");
+      if (c[i].status != 1) problem("An asynchronous job failed");
+      seen[j] = 1;
+    }
+    for (i = 0; i < ASYNC_JOBS; i++) {
+      if (ops[i] == GF_ASYNC_MULTIPLY) {
+        gf->multiply_region.w32(gf, src[0], ref[0], vals[i][0], bytes, 0);
+      } else {
+        gf_matrix_region_multiply(gf, vals[i], (ops[i] == GF_ASYNC_ENCODE) ? 2 : 1, 4,
+                                  (void **) src, (void **) ref, bytes, 0);
+      }
+      for (j = 0; j < ((ops[i] == GF_ASYNC_ENCODE) ? 2 : 1); j++) {
+        if (memcmp(ref[j], out[i][j], bytes) != 0) problem("An asynchronous job computed the wrong bytes");
+      }
+    }
+
+    /* A malformed job completes with a status of 0. */
+
+    job.op = 99;
+    job.user_data = 7;
+    if (!gf_async_submit(q, &job)) problem("gf_async_submit refused a job to an empty queue");
+    if (gf_async_wait(q, c, 1, 1) != 1 || c[0].user_data != 7 || c[0].status != 0) {
+      problem("A malformed asynchronous job didn't fail");
+    }
+    gf_async_free(q);
+  }
+
+  for (i = 0; i < 4; i++) free(src[i]);
+  for (i = 0; i < ASYNC_JOBS; i++) {
+    free(out[i][0]);
+    free(out[i][1]);
+  }
+  free(ref[0]);
+  free(ref[1]);
+}
+
+/* Makes more gf_t's with the same configuration as gf, some of them from
+   threads at the same time, and checks that they share its tables, if it has
+   any, and that it still works after they are freed.  The threads divide and
+   invert too, which builds the parts of the tables that are built on first
+   use, possibly in several threads at once.  Half of the threads supply the
+   scratch memory, which must hold the tables instead of sharing them, and
+   free it without gf_free(). */
+
+typedef struct {
+  gf_t *gf;
+  int w;
+  int scratch;
+  uint32_t *a, *b, *prod;
+  int failed;
+} shared_test_t;
+
+#define SHARED_VALS (64)
+
+void *shared_thread(void *arg)
+{
+  shared_test_t *t;
+  gf_internal_t *h, *h2;
+  gf_t gf2;
+  void *mem;
+  int i, region_type;
+
+  t = (shared_test_t *) arg;
+  h = (gf_internal_t *) t->gf->scratch;
+  region_type = h->region_type | ((h->region_only) ? GF_REGION_ONLY : 0);
+  mem = NULL;
+  if (t->scratch) {
+    mem = malloc(gf_scratch_size(t->w, h->mult_type, region_type, h->divide_type, h->arg1, h->arg2));
+    if (mem == NULL) {
+      t->failed = 1;
+      return NULL;
+    }
+  }
+  if (gf_init_hard(&gf2, t->w, h->mult_type, region_type,
+                   h->divide_type, h->prim_poly, h->arg1, h->arg2, h->base_gf, mem) == 0) {
+    t->failed = 1;
+    free(mem);
+    return NULL;
+  }
+  h2 = (gf_internal_t *) gf2.scratch;
+  if (t->scratch) {
+    if (h2->shared != NULL) t->failed = 1;
+  } else if (h->shared != h2->shared || (h->shared != NULL && h->private != h2->private)) {
+    t->failed = 1;
+  }
+  for (i = 0; i < SHARED_VALS; i++) {
+    if (gf2.multiply.w32(&gf2, t->a[i], t->b[i]) != t->prod[i]) t->failed = 1;
+    if (t->b[i] != 0 && gf2.divide.w32 != NULL &&
+        gf2.divide.w32(&gf2, t->prod[i], t->b[i]) != t->a[i]) t->failed = 1;
+    if (t->b[i] != 0 && gf2.inverse.w32 != NULL &&
+        gf2.multiply.w32(&gf2, t->b[i], gf2.inverse.w32(&gf2, t->b[i])) != 1) t->failed = 1;
+  }
+  if (t->scratch) {
+    free(mem);
+  } else {
+    gf_free(&gf2, 0);
+  }
+  return NULL;
+}
+
+void test_shared(gf_t *gf, int w)
+{
+  shared_test_t t[THREADS];
+  pthread_t tid[THREADS];
+  uint32_t a[SHARED_VALS], b[SHARED_VALS], prod[SHARED_VALS];
+  int i, started[THREADS];
+
+  if (verbose) { printf("Testing tables shared between gf_t's.\n"); fflush(stdout); }
+
+  for (i = 0; i < SHARED_VALS; i++) {
+    a[i] = MOA_Random_W(w, 1);
+    b[i] = MOA_Random_W(w, 1);
+    prod[i] = gf->multiply.w32(gf, a[i], b[i]);
+  }
+
+  for (i = 0; i < THREADS; i++) {
+    t[i].gf = gf;
+    t[i].w = w;
+    t[i].scratch = (i % 2);
+    t[i].a = a;
+    t[i].b = b;
+    t[i].prod = prod;
+    t[i].failed = 0;
+    started[i] = (pthread_create(tid + i, NULL, shared_thread, t + i) == 0);
+    if (!started[i]) shared_thread(t + i);
+  }
+  for (i = 0; i < THREADS; i++) {
+    if (started[i]) pthread_join(tid[i], NULL);
+    if (t[i].failed) problem("A gf_t with the same configuration didn't share the tables or multiply the same");
+  }
+
+  for (i = 0; i < SHARED_VALS; i++) {
+    if (gf->multiply.w32(gf, a[i], b[i]) != prod[i]) {
+      problem("Multiplies were wrong after freeing gf_t's that shared the tables");
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  int w, i;
+  time_t t0;
+  gf_t gf;
+
+  signal(SIGSEGV, SigHandler);
+
+  if (argc < 4) usage(NULL);
+  if (sscanf(argv[1], "%d", &w) == 0 || w < 1 || (w > 32 && w != 64 && w != 128)) usage("Bad w");
+  if (sscanf(argv[3], "%ld", &t0) == 0) usage("Bad seed");
+  if (t0 == -1) t0 = time(0);
+  MOA_Seed(t0);
+
+  for (i = 0; i < (int) strlen(argv[2]); i++) {
+    if (strchr("AMRLNFSDGPITHQCV", argv[2][i]) == NULL) usage("Bad test");
+    if (w > 32 && strchr("TV", argv[2][i]) == NULL) usage("Only the T test runs with w = 64 and 128");
+  }
+
+  if (argc > 4) {
+    if (create_gf_from_argv(&gf, w, argc, argv, 4) == 0) usage(BM);
+  } else {
+    if (gf_init_easy(&gf, w) == 0) usage(BM);
+  }
+
+  verbose = (strchr(argv[2], 'V') != NULL);
+  if (verbose) printf("Seed: %ld\n", t0);
+
+  if (strchr(argv[2], 'M') != NULL || strchr(argv[2], 'A') != NULL) test_matrix(&gf, w);
+  if (strchr(argv[2], 'R') != NULL || strchr(argv[2], 'A') != NULL) test_rs(&gf, w);
+  if (strchr(argv[2], 'L') != NULL || strchr(argv[2], 'A') != NULL) test_lrc(&gf, w);
+  if (strchr(argv[2], 'N') != NULL || strchr(argv[2], 'A') != NULL) test_rlnc(&gf, w);
+  if (strchr(argv[2], 'F') != NULL || strchr(argv[2], 'A') != NULL) test_fft(&gf, w);
+  if (strchr(argv[2], 'S') != NULL || strchr(argv[2], 'A') != NULL) test_shamir(&gf, w);
+  if (strchr(argv[2], 'D') != NULL || strchr(argv[2], 'A') != NULL) test_dense(&gf, w);
+  if (strchr(argv[2], 'G') != NULL || strchr(argv[2], 'A') != NULL) test_gemm(&gf, w);
+  if (strchr(argv[2], 'P') != NULL || strchr(argv[2], 'A') != NULL) test_poly(&gf, w);
+  if (strchr(argv[2], 'I') != NULL || strchr(argv[2], 'A') != NULL) test_stream(&gf, w);
+  if (strchr(argv[2], 'T') != NULL || strchr(argv[2], 'A') != NULL) test_threads(&gf, w);
+  if (strchr(argv[2], 'H') != NULL || strchr(argv[2], 'A') != NULL) test_parallel(&gf, w);
+  if (strchr(argv[2], 'Q') != NULL || strchr(argv[2], 'A') != NULL) test_async(&gf, w);
+  if (strchr(argv[2], 'C') != NULL || strchr(argv[2], 'A') != NULL) test_shared(&gf, w);
+
+  gf_free(&gf, 1);
+  return 0;
+}
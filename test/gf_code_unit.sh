@@ -0,0 +1,48 @@
+# Runs gf_code_unit on the default gf_t for each w that the coding routines
+# are commonly used with, plus a general w and one non-default method.  Then
+# it runs the threads and thread pool tests on the methods that build region
+# or single-multiply tables per call, including those for w = 64 and 128.
+./gf_code_unit 4 A -1
+./gf_code_unit 7 A -1
+./gf_code_unit 8 A -1
+./gf_code_unit 16 A -1
+./gf_code_unit 32 A -1
+./gf_code_unit 8 A -1 -m SPLIT 8 4 -
+./gf_code_unit 16 A -1 -m SPLIT 16 4 -r ALTMAP -
+./gf_code_unit 4 T -1 -m TABLE -r QUAD -r LAZY -
+./gf_code_unit 8 T -1 -m TABLE -r DOUBLE -r LAZY -
+./gf_code_unit 16 T -1 -m TABLE -
+./gf_code_unit 32 T -1 -m GROUP 4 8 -
+./gf_code_unit 32 T -1 -m GROUP 3 3 -
+./gf_code_unit 32 T -1 -m SPLIT 32 4 -r NOSIMD -
+./gf_code_unit 32 T -1 -m SPLIT 32 4 -r ALTMAP -
+./gf_code_unit 32 T -1 -m SPLIT 32 8 -
+./gf_code_unit 32 T -1 -m SPLIT 32 16 -
+./gf_code_unit 32 T -1 -m SPLIT 8 8 -
+./gf_code_unit 64 T -1 -m SPLIT 64 4 -r NOSIMD -
+./gf_code_unit 64 T -1 -m SPLIT 64 4 -r ALTMAP -
+./gf_code_unit 64 T -1 -m SPLIT 64 8 -
+./gf_code_unit 64 T -1 -m SPLIT 64 16 -
+./gf_code_unit 64 T -1 -m GROUP 4 4 -
+./gf_code_unit 64 T -1 -m GROUP 12 4 -
+./gf_code_unit 64 T -1 -m GROUP 12 4 -r CAUCHY -
+./gf_code_unit 128 T -1 -m SPLIT 128 4 -r CAUCHY -
+./gf_code_unit 128 T -1 -m SPLIT 128 4 -r NOSIMD -
+./gf_code_unit 128 T -1 -m SPLIT 128 4 -r ALTMAP -
+./gf_code_unit 128 T -1 -m SPLIT 128 8 -
+./gf_code_unit 128 T -1 -m GROUP 4 8 -
+./gf_code_unit 8 H -1 -m TABLE -r DOUBLE -r LAZY -
+./gf_code_unit 16 H -1 -m TABLE -
+./gf_code_unit 32 H -1 -m GROUP 4 8 -
+./gf_code_unit 32 H -1 -m SPLIT 32 4 -r NOSIMD -
+./gf_code_unit 8 C -1 -m TABLE -r DOUBLE -
+./gf_code_unit 16 C -1 -m LOG -
+./gf_code_unit 16 C -1 -m SPLIT 8 8 -
+./gf_code_unit 8 C -1 -m TABLE -p 0x12b -
+./gf_code_unit 8 C -1 -m TABLE -r DOUBLE -r LAZY -p 0x12b -
+./gf_code_unit 16 C -1 -m LOG -p 0x1002d -
+./gf_code_unit 8 C -1 -r ONLY -p 0x12b -
+./gf_code_unit 8 C -1 -m TABLE -r ONLY -p 0x12b -
+./gf_code_unit 8 C -1 -m TABLE -r DOUBLE -r ONLY -p 0x12b -
+./gf_code_unit 16 C -1 -m LOG -r ONLY -p 0x1002d -
+./gf_code_unit 16 C -1 -m TABLE -r ONLY -p 0x1002d -
@@ -0,0 +1,489 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_encode.c
+ *
+ * Reads k data files and writes m coding files with io_uring.
+ *
+ * The files are opened with O_DIRECT, and "depth" stripe buffers are
+ * registered with the ring, so the disks DMA straight into and out of the
+ * buffers that gf_matrix_region_multiply() works on.  Each stripe buffer goes
+ * around a loop:  its k chunk reads are submitted, then once they have all
+ * completed it is encoded, its m chunk writes are submitted, and once those
+ * have completed it takes the next stripe.  Encoding runs on this thread while
+ * the other stripes' I/O is in flight, so the time spent encoding versus the
+ * total shows whether the library or the disks are the bottleneck.
+ *
+ * The ring is driven with the io_uring system calls directly, so liburing
+ * isn't needed.  If the kernel headers don't have io_uring, or the kernel
+ * won't set up a ring, the stripes are read and written with pread() and
+ * pwrite() instead.  If a file system doesn't support O_DIRECT, the file is
+ * opened without it, and if the buffers can't be registered, the plain read
+ * and write operations are used.
+ */
+
+#include "config.h"
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "gf_complete.h"
+#include "gf_method.h"
+#include "gf_matrix.h"
+
+#define ALIGN (4096)
+
+void usage(char *s)
+{
+  fprintf(stderr, "usage: gf_encode w k m chunk depth prefix [method]\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "       Reads the data files prefix_k1 .. prefix_kk, and writes the coding\n");
+  fprintf(stderr, "       files prefix_m1 .. prefix_mm of a Cauchy code over GF(2^w), the same\n");
+  fprintf(stderr, "       code as gf_stream.  Stripe i is chunk i of every data file, with\n");
+  fprintf(stderr, "       short files padded with zeros, and depth stripes are in flight.\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "       Legal w are: 1 - 32, with k + m <= 2^w.  chunk is a multiple of %d.\n", ALIGN);
+  if (s != NULL) fprintf(stderr, "\n%s\n", s);
+  exit(1);
+}
+
+/* Opens with O_DIRECT if the file system allows it.  Sets *direct to 0 if it
+   doesn't. */
+
+int open_file(char *prefix, char c, int i, int flags, int *direct)
+{
+  char *name;
+  int fd;
+
+  name = (char *) malloc(strlen(prefix) + 20);
+  sprintf(name, "%s_%c%d", prefix, c, i);
+  fd = open(name, flags | O_DIRECT, 0644);
+  if (fd < 0 && errno == EINVAL) {
+    *direct = 0;
+    fd = open(name, flags, 0644);
+  }
+  if (fd < 0) {
+    perror(name);
+    exit(1);
+  }
+  free(name);
+  return fd;
+}
+
+typedef struct {
+  int stripe;       /* -1 when the slot is free */
+  int writing;
+  int pending;      /* I/Os in flight */
+  uint8_t *base;    /* k+m chunks */
+  int *done;        /* Bytes done, per chunk */
+} slot_t;
+
+int w, k, m, chunk, depth, nstripes;
+int *fds;           /* k data, then m coding */
+off_t *sizes;
+uint32_t *matrix;
+slot_t *slots;
+void **ptrs;
+gf_t gf;
+double encode_time;
+
+double now()
+{
+  struct timeval t;
+
+  gettimeofday(&t, NULL);
+  return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+void encode(slot_t *s)
+{
+  double t0;
+  int i;
+
+  t0 = now();
+  for (i = 0; i < k+m; i++) ptrs[i] = s->base + (size_t) i * chunk;
+  gf_matrix_region_multiply(&gf, matrix, m, k, ptrs, ptrs + k, chunk, 0);
+  encode_time += now() - t0;
+}
+
+void io_error(int err)
+{
+  fprintf(stderr, "gf_encode: I/O failed: %s\n", strerror(err));
+  exit(1);
+}
+
+/* Whether the rest of data chunk i of the slot's stripe lies past the end of
+   its file, so it is zeros and needn't be read. */
+
+int past_end(slot_t *s, int i)
+{
+  return (off_t) s->stripe * chunk + s->done[i] >= sizes[i];
+}
+
+/* The fallback:  one stripe at a time with pread() and pwrite(). */
+
+void run_sync()
+{
+  slot_t *s;
+  ssize_t n;
+  off_t off;
+  int i;
+
+  s = slots;
+  for (s->stripe = 0; s->stripe < nstripes; s->stripe++) {
+    off = (off_t) s->stripe * chunk;
+    for (i = 0; i < k+m; i++) {
+      s->done[i] = 0;
+      while (s->done[i] < chunk && (i >= k || !past_end(s, i))) {
+        if (i < k) {
+          n = pread(fds[i], s->base + (size_t) i*chunk + s->done[i], chunk - s->done[i], off + s->done[i]);
+        } else {
+          n = pwrite(fds[i], s->base + (size_t) i*chunk + s->done[i], chunk - s->done[i], off + s->done[i]);
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) io_error(errno);
+        if (n == 0 && i >= k) io_error(EIO);
+        if (n == 0) break;
+        s->done[i] += n;
+      }
+      if (i < k) memset(s->base + (size_t) i*chunk + s->done[i], 0, chunk - s->done[i]);
+      if (i == k-1) encode(s);
+    }
+  }
+}
+
+#ifdef HAVE_LINUX_IO_URING_H
+
+/* Just enough of a ring to submit reads and writes and reap their
+   completions.  This thread is the only user of it, so the kernel is the
+   only other party, and the shared head and tail need acquire/release
+   ordering against it. */
+
+typedef struct {
+  int fd;
+  unsigned *sq_head;
+  unsigned *sq_tail;
+  unsigned *sq_mask;
+  unsigned *sq_array;
+  struct io_uring_sqe *sqes;
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  unsigned *cq_mask;
+  struct io_uring_cqe *cqes;
+  unsigned entries;
+  unsigned tail;    /* Our copy of the SQ tail, ahead of the kernel's by to_submit */
+  unsigned to_submit;
+  int fixed;        /* The slots are registered buffers */
+} ring_t;
+
+ring_t ring;
+
+int ring_init(unsigned entries)
+{
+  struct io_uring_params p;
+  uint8_t *sq, *cq;
+  size_t sq_len, cq_len;
+
+  memset(&p, 0, sizeof(p));
+  ring.fd = syscall(__NR_io_uring_setup, entries, &p);
+  if (ring.fd < 0) return 0;
+
+  sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    if (cq_len > sq_len) sq_len = cq_len;
+    cq_len = sq_len;
+  }
+  sq = (uint8_t *) mmap(NULL, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring.fd, IORING_OFF_SQ_RING);
+  if (sq == MAP_FAILED) return 0;
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    cq = sq;
+  } else {
+    cq = (uint8_t *) mmap(NULL, cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring.fd, IORING_OFF_CQ_RING);
+    if (cq == MAP_FAILED) return 0;
+  }
+  ring.sqes = (struct io_uring_sqe *) mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+                                           PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                           ring.fd, IORING_OFF_SQES);
+  if (ring.sqes == MAP_FAILED) return 0;
+
+  ring.sq_head = (unsigned *) (sq + p.sq_off.head);
+  ring.sq_tail = (unsigned *) (sq + p.sq_off.tail);
+  ring.sq_mask = (unsigned *) (sq + p.sq_off.ring_mask);
+  ring.sq_array = (unsigned *) (sq + p.sq_off.array);
+  ring.cq_head = (unsigned *) (cq + p.cq_off.head);
+  ring.cq_tail = (unsigned *) (cq + p.cq_off.tail);
+  ring.cq_mask = (unsigned *) (cq + p.cq_off.ring_mask);
+  ring.cqes = (struct io_uring_cqe *) (cq + p.cq_off.cqes);
+  ring.entries = p.sq_entries;
+  ring.tail = *ring.sq_tail;
+  ring.to_submit = 0;
+  return 1;
+}
+
+/* Submits what has been queued, and waits for at least min completions. */
+
+void ring_enter(unsigned min)
+{
+  int n;
+
+  __atomic_store_n(ring.sq_tail, ring.tail, __ATOMIC_RELEASE);
+  while (ring.to_submit > 0 || min > 0) {
+    n = syscall(__NR_io_uring_enter, ring.fd, ring.to_submit, min,
+                (min > 0) ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) io_error(errno);
+    ring.to_submit -= n;
+    min = 0;
+  }
+}
+
+/* Queues a read or write of chunk i of slot s, from where it left off. */
+
+void ring_queue(int si, int i)
+{
+  struct io_uring_sqe *sqe;
+  slot_t *s;
+
+  if (ring.tail - __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE) >= ring.entries) ring_enter(0);
+  s = slots + si;
+  sqe = ring.sqes + (ring.tail & *ring.sq_mask);
+  memset(sqe, 0, sizeof(*sqe));
+  if (ring.fixed) {
+    sqe->opcode = (i < k) ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+    sqe->buf_index = si;
+  } else {
+    sqe->opcode = (i < k) ? IORING_OP_READ : IORING_OP_WRITE;
+  }
+  sqe->fd = fds[i];
+  sqe->addr = (uint64_t) (uintptr_t) (s->base + (size_t) i * chunk + s->done[i]);
+  sqe->len = chunk - s->done[i];
+  sqe->off = (uint64_t) s->stripe * chunk + s->done[i];
+  sqe->user_data = (uint64_t) si * (k+m) + i;
+  ring.sq_array[ring.tail & *ring.sq_mask] = ring.tail & *ring.sq_mask;
+  ring.tail++;
+  ring.to_submit++;
+  s->pending++;
+}
+
+/* Starts the reads of the next stripe into slot si, or frees the slot when
+   there are no stripes left. */
+
+int next_stripe;
+
+void start_stripe(int si)
+{
+  slot_t *s;
+  int i;
+
+  s = slots + si;
+  s->stripe = -1;
+  if (next_stripe == nstripes) return;
+  s->stripe = next_stripe++;
+  s->writing = 0;
+  for (i = 0; i < k; i++) {
+    s->done[i] = 0;
+    if (past_end(s, i)) {
+      memset(s->base + (size_t) i * chunk, 0, chunk);
+    } else {
+      ring_queue(si, i);
+    }
+  }
+}
+
+void start_writes(int si)
+{
+  slot_t *s;
+  int i;
+
+  s = slots + si;
+  encode(s);
+  s->writing = 1;
+  for (i = k; i < k+m; i++) {
+    s->done[i] = 0;
+    ring_queue(si, i);
+  }
+}
+
+void run_ring()
+{
+  struct io_uring_cqe *cqe;
+  unsigned head;
+  slot_t *s;
+  int si, i, active;
+
+  next_stripe = 0;
+  for (si = 0; si < depth; si++) {
+    start_stripe(si);
+    if (slots[si].stripe >= 0 && slots[si].pending == 0) start_writes(si);
+  }
+
+  do {
+    ring_enter(1);
+    head = *ring.cq_head;
+    while (head != __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+      cqe = ring.cqes + (head & *ring.cq_mask);
+      si = cqe->user_data / (k+m);
+      i = cqe->user_data % (k+m);
+      s = slots + si;
+      s->pending--;
+      if (cqe->res < 0) io_error(-cqe->res);
+      s->done[i] += cqe->res;
+
+      /* A short read at the end of a file leaves zeros.  Otherwise, a short
+         transfer carries on where it stopped. */
+
+      if (s->done[i] < chunk) {
+        if (i < k && (cqe->res == 0 || past_end(s, i))) {
+          memset(s->base + (size_t) i * chunk + s->done[i], 0, chunk - s->done[i]);
+        } else if (i >= k && cqe->res == 0) {
+          io_error(EIO);
+        } else {
+          ring_queue(si, i);
+        }
+      }
+      head++;
+      __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+
+      if (s->pending == 0) {
+        if (!s->writing) {
+          start_writes(si);
+        } else {
+          start_stripe(si);
+          if (s->stripe >= 0 && s->pending == 0) start_writes(si);
+        }
+      }
+    }
+
+    active = 0;
+    for (si = 0; si < depth; si++) if (slots[si].stripe >= 0) active = 1;
+  } while (active);
+}
+
+#endif
+
+int main(int argc, char **argv)
+{
+  int i, direct, uring;
+  uint8_t *mem, *base;
+  struct stat st;
+  off_t longest, input;
+  double t0, t;
+  size_t sbytes;
+  char *io;
+
+  if (argc < 7) usage(NULL);
+  if (sscanf(argv[1], "%d", &w) != 1 || w <= 0 || w > 32) usage("Bad w");
+  if (sscanf(argv[2], "%d", &k) != 1 || k <= 0) usage("Bad k");
+  if (sscanf(argv[3], "%d", &m) != 1 || m <= 0) usage("Bad m");
+  if (w < 31 && k + m > (1 << w)) usage("k + m is too big for w");
+  if (sscanf(argv[4], "%d", &chunk) != 1 || chunk <= 0 || chunk % ALIGN != 0) usage("Bad chunk");
+  if (sscanf(argv[5], "%d", &depth) != 1 || depth < 1 || depth * (k+m) > 4096) usage("Bad depth");
+
+  if (argc > 7) {
+    if (create_gf_from_argv(&gf, w, argc, argv, 7) == 0) usage("Bad method");
+  } else {
+    if (gf_init_easy(&gf, w) == 0) usage("Bad method");
+  }
+
+  /* The same Cauchy matrix as gf_stream. */
+
+  matrix = (uint32_t *) malloc(sizeof(uint32_t) * k * m);
+  for (i = 0; i < m*k; i++) matrix[i] = gf.inverse.w32(&gf, (i / k) ^ (m + i % k));
+
+  direct = 1;
+  fds = (int *) malloc(sizeof(int) * (k+m));
+  sizes = (off_t *) malloc(sizeof(off_t) * (k+m));
+  longest = 0;
+  input = 0;
+  for (i = 0; i < k; i++) {
+    fds[i] = open_file(argv[6], 'k', i+1, O_RDONLY, &direct);
+    if (fstat(fds[i], &st) != 0) io_error(errno);
+    sizes[i] = st.st_size;
+    if (sizes[i] > longest) longest = sizes[i];
+    input += sizes[i];
+  }
+  for (i = 0; i < m; i++) fds[k+i] = open_file(argv[6], 'm', i+1, O_WRONLY | O_CREAT | O_TRUNC, &direct);
+  nstripes = (longest + chunk - 1) / chunk;
+
+  sbytes = (size_t) chunk * (k+m);
+  mem = (uint8_t *) malloc(sbytes * depth + ALIGN);
+  slots = (slot_t *) malloc(sizeof(slot_t) * depth);
+  ptrs = (void **) malloc(sizeof(void *) * (k+m));
+  if (mem == NULL || slots == NULL || ptrs == NULL) usage("Out of memory");
+  base = (uint8_t *) (((uintptr_t) mem + ALIGN - 1) & ~((uintptr_t) ALIGN - 1));
+  for (i = 0; i < depth; i++) {
+    slots[i].stripe = -1;
+    slots[i].pending = 0;
+    slots[i].base = base + sbytes * i;
+    slots[i].done = (int *) malloc(sizeof(int) * (k+m));
+  }
+
+  uring = 0;
+  io = "pread/pwrite";
+#ifdef HAVE_LINUX_IO_URING_H
+  if (ring_init(depth * (k+m))) {
+    struct iovec *iov;
+
+    uring = 1;
+    iov = (struct iovec *) malloc(sizeof(struct iovec) * depth);
+    for (i = 0; i < depth; i++) {
+      iov[i].iov_base = slots[i].base;
+      iov[i].iov_len = sbytes;
+    }
+    ring.fixed = (syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_BUFFERS, iov, depth) == 0);
+    io = ring.fixed ? "io_uring, registered buffers" : "io_uring";
+    free(iov);
+  }
+#endif
+
+  t0 = now();
+#ifdef HAVE_LINUX_IO_URING_H
+  if (uring) run_ring();
+#endif
+  if (!uring) run_sync();
+  for (i = 0; i < k+m; i++) {
+    if (i >= k && fsync(fds[i]) != 0) io_error(errno);
+    close(fds[i]);
+  }
+  t = now() - t0;
+
+  printf("I/O: %s%s\n", io, direct ? ", O_DIRECT" : "");
+  printf("Stripes: %d\n", nstripes);
+  printf("Input bytes: %lld\n", (long long) input);
+  printf("Seconds: %.6f\n", t);
+  printf("Encode seconds: %.6f\n", encode_time);
+  if (t > 0) printf("GB/s: %.3f\n", (double) input / t / 1000000000.0);
+
+  for (i = 0; i < depth; i++) free(slots[i].done);
+  free(slots);
+  free(mem);
+  free(ptrs);
+  free(fds);
+  free(sizes);
+  free(matrix);
+  gf_free(&gf, 1);
+  return 0;
+}
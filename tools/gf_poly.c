@@ -21,10 +21,9 @@
  * in a base field GF(2^w).  The polynomial is of degree n.  You need to do the 
  * following for all i from 1 to n/2:
  * 
- * Construct x^(2^w)^i modulo f.  That will be a polynomial of maximum degree n-1
- * with coefficients in GF(2^w).  You construct that polynomial by starting with x
- * and doubling it w times, each time taking the result modulo f.  Then you 
- * multiply that by itself i times, again each time taking the result modulo f.
+ * Construct x^((2^w)^i) modulo f.  That will be a polynomial of maximum degree
+ * n-1 with coefficients in GF(2^w).  You construct that polynomial by starting
+ * with x and squaring it w*i times, each time taking the result modulo f.
  * 
  * When you're done, you need to "subtract" x -- since addition = subtraction = 
  * XOR, that means XOR x.  
@@ -42,13 +41,17 @@
  * The second is gcd_one, which takes a polynomial of degree n and a second one
  * of degree n-1, and uses Euclid's algorithm to decide if their GCD == 1.
  * 
- * These can be made faster (e.g. calculate x^(2^w) once and store it).
+ * For w <= 32, ben_or_32() does the same thing on top of gf_poly, keeping
+ * x^((2^w)^i) from one i to the next.  Squaring a polynomial in characteristic 2
+ * just squares its coefficients, and the divisions and gcds use gf_poly's
+ * faster algorithms.
  */
 
 #include "gf_complete.h"
 #include "gf_method.h"
 #include "gf_general.h"
 #include "gf_int.h"
+#include "gf_poly.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -130,7 +133,7 @@ void x_to_q_to_i_minus_x(gf_t *gf, int w, int n, gf_general_t *poly, int logq, i
   for (j = 0; j < n; j++) gf_general_set_zero(x_to_q+j, w);
   gf_general_set_one(x_to_q+1, w);
 
-  for (lq = 0; lq < logq; lq++) {
+  for (lq = 0; lq < logq * i; lq++) {
     for (j = 0; j < n*2; j++) gf_general_set_zero(product+j, w);
     for (j = 0; j < n; j++) {
       for (k = 0; k < n; k++) {
@@ -149,29 +152,7 @@ void x_to_q_to_i_minus_x(gf_t *gf, int w, int n, gf_general_t *poly, int logq, i
     }
     for (j = 0; j < n; j++) gf_general_add(gf, product+j, &zero, x_to_q+j);
   }
-  for (j = 0; j < n; j++) gf_general_set_zero(retval+j, w);
-  gf_general_set_one(retval, w);
-
-  while (i > 0) {
-    for (j = 0; j < n*2; j++) gf_general_set_zero(product+j, w);
-    for (j = 0; j < n; j++) {
-      for (k = 0; k < n; k++) {
-        gf_general_multiply(gf, x_to_q+j, retval+k, &p);
-        gf_general_add(gf, product+(j+k), &p, product+(j+k));
-      }
-    }
-    for (j = n*2-1; j >= n; j--) {
-      if (!gf_general_is_zero(product+j, w)) {
-        gf_general_add(gf, product+j, &zero, &factor);
-        for (k = 0; k <= n; k++) {
-          gf_general_multiply(gf, poly+k, &factor, &p);
-          gf_general_add(gf, product+(j-n+k), &p, product+(j-n+k));
-        }
-      }
-    }
-    for (j = 0; j < n; j++) gf_general_add(gf, product+j, &zero, retval+j);
-    i--;
-  }
+  for (j = 0; j < n; j++) gf_general_add(gf, x_to_q+j, &zero, retval+j);
 
   gf_general_set_one(&x, w);
   gf_general_add(gf, &x, retval+1, retval+1);
@@ -180,6 +161,51 @@ void x_to_q_to_i_minus_x(gf_t *gf, int w, int n, gf_general_t *poly, int logq, i
   free(x_to_q);
 }
 
+/* Returns whether the monic polynomial f of degree n is irreducible, for
+   w <= 32, or -1 if it runs out of memory. */
+
+static int ben_or_32(gf_t *gf, int w, int n, gf_general_t *poly)
+{
+  uint32_t *f, *xq, *sq, *g;
+  int i, j, s, dx, dt, rv;
+
+  f = (uint32_t *) malloc(sizeof(uint32_t) * (n+1) * 5);
+  if (f == NULL) return -1;
+  xq = f + (n+1);
+  sq = xq + (n+1);
+  g = sq + 2*(n+1);
+  for (j = 0; j <= n; j++) f[j] = poly[j].w32;
+
+  xq[0] = 0;
+  xq[1] = 1;
+  dx = 1;
+  rv = 1;
+  for (i = 1; i <= n/2 && rv == 1; i++) {
+    for (s = 0; s < w; s++) {
+      memset(sq, 0, sizeof(uint32_t) * (2*dx + 1));
+      for (j = 0; j <= dx; j++) sq[2*j] = gf->multiply.w32(gf, xq[j], xq[j]);
+      dx = gf_poly_divide(gf, sq, 2*dx, f, n, NULL, sq);
+      if (dx < 0) break;
+      memcpy(xq, sq, sizeof(uint32_t) * (dx + 1));
+    }
+
+    /* x^(q^i) = 0 mod f only if f = x^n, which is reducible, since n > 1. */
+
+    if (dx < 0) {
+      rv = (dx == -1) ? 0 : -1;
+      break;
+    }
+    memcpy(sq, xq, sizeof(uint32_t) * (dx + 1));
+    for (j = dx+1; j <= 1; j++) sq[j] = 0;
+    sq[1] ^= 1;
+    dt = gf_poly_degree(sq, (dx > 1) ? dx+1 : 2);
+    s = gf_poly_gcd(gf, f, n, sq, dt, g);
+    if (s != 0) rv = (s < -1) ? -1 : 0;
+  }
+  free(f);
+  return rv;
+}
+
 int main(int argc, char **argv)
 {
   int w, i, power, n, ap, success;
@@ -262,6 +288,16 @@ int main(int argc, char **argv)
     exit(0);
   }
 
+  if (w <= 32) {
+    i = ben_or_32(&gf, w, n, poly);
+    if (i < 0) {
+      fprintf(stderr, "Out of memory.\n");
+      exit(1);
+    }
+    printf("%s.\n", i ? "Irreducible" : "Reducible");
+    exit(0);
+  }
+
   for (i = 1; i <= n/2; i++) {
     x_to_q_to_i_minus_x(&gf, w, n, poly, w, i, prod); 
     if (!gcd_one(&gf, w, n, poly, prod)) {
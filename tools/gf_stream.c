@@ -0,0 +1,125 @@
+/*
+ * GF-Complete: A Comprehensive Open Source Library for Galois Field Arithmetic
+ * James S. Plank, Ethan L. Miller, Kevin M. Greenan,
+ * Benjamin A. Arnold, John A. Burnum, Adam W. Disney, Allen C. McBride.
+ *
+ * gf_stream.c
+ *
+ * Encodes a file into k data and m coding files with gf_stream
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "gf_complete.h"
+#include "gf_method.h"
+#include "gf_stream.h"
+
+void usage(char *s)
+{
+  fprintf(stderr, "usage: gf_stream w k m chunk depth input prefix [method]\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "       Encodes the input file (- for standard input) with a Cauchy code over\n");
+  fprintf(stderr, "       GF(2^w), into prefix_k1 .. prefix_kk and prefix_m1 .. prefix_mm.\n");
+  fprintf(stderr, "       Stripes are k chunks of input, padded with zeros at the end, and\n");
+  fprintf(stderr, "       depth stripes are in flight between reading, encoding and writing.\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "       Legal w are: 1 - 32, with k + m <= 2^w.  chunk is a multiple of 64.\n");
+  if (s != NULL) fprintf(stderr, "\n%s\n", s);
+  exit(1);
+}
+
+int open_output(char *prefix, char c, int i)
+{
+  char *name;
+  int fd;
+
+  name = (char *) malloc(strlen(prefix) + 20);
+  sprintf(name, "%s_%c%d", prefix, c, i);
+  fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    perror(name);
+    exit(1);
+  }
+  free(name);
+  return fd;
+}
+
+int main(int argc, char **argv)
+{
+  int w, k, m, chunk, depth, in_fd, i, j;
+  int *data_fds, *coding_fds;
+  uint32_t *matrix;
+  int64_t bytes;
+  struct timeval t0, t1;
+  double t;
+  gf_stream_t *s;
+  gf_t gf;
+
+  if (argc < 8) usage(NULL);
+  if (sscanf(argv[1], "%d", &w) != 1 || w <= 0 || w > 32) usage("Bad w");
+  if (sscanf(argv[2], "%d", &k) != 1 || k <= 0) usage("Bad k");
+  if (sscanf(argv[3], "%d", &m) != 1 || m <= 0) usage("Bad m");
+  if (w < 31 && k + m > (1 << w)) usage("k + m is too big for w");
+  if (sscanf(argv[4], "%d", &chunk) != 1 || chunk <= 0 || chunk % 64 != 0) usage("Bad chunk");
+  if (sscanf(argv[5], "%d", &depth) != 1 || depth < 2) usage("Bad depth");
+
+  if (argc > 8) {
+    if (create_gf_from_argv(&gf, w, argc, argv, 8) == 0) usage("Bad method");
+  } else {
+    if (gf_init_easy(&gf, w) == 0) usage("Bad method");
+  }
+
+  /* Element (i,j) of a Cauchy matrix is 1/(x_i + y_j), with x_i = i and
+     y_j = m+j all distinct, so every square submatrix is invertible. */
+
+  matrix = (uint32_t *) malloc(sizeof(uint32_t) * k * m);
+  for (i = 0; i < m; i++) {
+    for (j = 0; j < k; j++) matrix[i*k+j] = gf.inverse.w32(&gf, i ^ (m+j));
+  }
+
+  s = gf_stream_create(&gf, k, m, matrix, chunk, depth);
+  if (s == NULL) usage("gf_stream_create failed (does chunk suit the method?)");
+
+  if (strcmp(argv[6], "-") == 0) {
+    in_fd = 0;
+  } else {
+    in_fd = open(argv[6], O_RDONLY);
+    if (in_fd < 0) {
+      perror(argv[6]);
+      exit(1);
+    }
+  }
+  data_fds = (int *) malloc(sizeof(int) * k);
+  coding_fds = (int *) malloc(sizeof(int) * m);
+  for (i = 0; i < k; i++) data_fds[i] = open_output(argv[7], 'k', i+1);
+  for (i = 0; i < m; i++) coding_fds[i] = open_output(argv[7], 'm', i+1);
+
+  gettimeofday(&t0, NULL);
+  bytes = gf_stream_encode(s, in_fd, data_fds, coding_fds);
+  gettimeofday(&t1, NULL);
+  if (bytes < 0) {
+    perror("gf_stream_encode");
+    exit(1);
+  }
+
+  for (i = 0; i < k; i++) close(data_fds[i]);
+  for (i = 0; i < m; i++) close(coding_fds[i]);
+  t = (t1.tv_sec - t0.tv_sec) + (t1.tv_usec - t0.tv_usec) / 1000000.0;
+  printf("Input bytes: %lld\n", (long long) bytes);
+  printf("Seconds: %.6f\n", t);
+  if (t > 0) printf("MB/s: %.2f\n", bytes / t / 1024.0 / 1024.0);
+
+  gf_stream_free(s);
+  free(matrix);
+  free(data_fds);
+  free(coding_fds);
+  gf_free(&gf, 1);
+  return 0;
+}